@@ -22,6 +22,18 @@
 
 // ------------------------------ includes ------------------------------
 
+// For mmap, open and fstat
+#define _POSIX_C_SOURCE 200112L
+
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "MyString.h"
 
 // ------------------------------ consts --------------------------------
@@ -30,1545 +42,7800 @@
 #define NINE_ASCII 57
 #define PLUS_ASCII 43
 #define MINUS_ASCII 45
+#define PREFIX_LENGTH 8
+#define BITS_IN_BYTE 8
+#define SIGN_FLIP (CHAR_MIN < 0 ? 0x80 : 0)
+#define INSERTION_SORT_LIMIT 16
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+#define EMPTY_SLOT SIZE_MAX
+#define HLL_PRECISION 14
+#define HLL_REGISTERS (1 << HLL_PRECISION)
+#define HLL_ALPHA (0.7213 / (1.0 + 1.079 / HLL_REGISTERS))
+#define LN_2 0.69314718055994530942
+#define CHUNK_ALIGNMENT 16
+#define MIN_CHUNK_SIZE 32
+#define MIN_BUILDER_CAPACITY 64
+#define MAX_DOUBLE_LENGTH 32
+#define MAX_INT_LENGTH (sizeof(int) * CHAR_BIT / 3 + 2)
+#define ARRAY_MAGIC "MYSTRAR1"
+#define ARRAY_MAGIC_LENGTH 8
+#define ARRAY_HEADER_SIZE (ARRAY_MAGIC_LENGTH + sizeof(uint64_t))
+#define MIN_COMPRESS_LENGTH 64
+#define LZ_HASH_BITS 12
+#define LZ_HASH_SIZE (1 << LZ_HASH_BITS)
+#define LZ_HASH_MULTIPLIER 2654435761U
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+#define LZ_NIBBLE_MAX 15
+#define LZ_LENGTH_BYTE_MAX 255
+#define ASCII_LIMIT 0x80
+#define ASCII_HIGH_BITS 0x8080808080808080ULL
+#define BYTES_OF_ONES 0x0101010101010101ULL
+#define ASCII_CASE_BIT 0x20
+#define NUM_OF_CHARS 256
+#define SWAR_DIGITS 8
+#define SWAR_DIGITS_POWER 100000000ULL
+#define ASCII_ZEROS 0x3030303030303030ULL
+#define HIGH_NIBBLES 0xF0F0F0F0F0F0F0F0ULL
+#define DIGITS_TO_NIBBLE_END 0x0606060606060606ULL
+
+// Digits are parsed 8 at a time only where the first char is the lowest byte of a word
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SWAR_PARSING
+#endif
+#define UTF8_CONTINUATION_MASK 0xC0
+#define UTF8_CONTINUATION 0x80
+#define UTF8_PAYLOAD_MASK 0x3F
+#define UTF8_PAYLOAD_BITS 6
+#define UTF8_MIN_LEAD 0xC2
+#define UTF8_LEAD_3 0xE0
+#define UTF8_LEAD_4 0xF0
+#define UTF8_MAX_LEAD 0xF4
+#define UTF8_SURROGATE_LEAD 0xED
+#define UTF8_MIN_CONTINUATION 0x80
+#define UTF8_MAX_CONTINUATION 0xBF
+#define NUMBER_MARK ZERO_ASCII
+#define MAX_LENGTH_BYTE SCHAR_MAX
+#define UTF8_UNKNOWN 0
+#define UTF8_INVALID 1
+#define UTF8_VALID 2
 
 // ------------------------------ structs -------------------------------
 
 /**
- * Represents a MyString
+ * Represents a MyStringHashSet: open addressing table of MyString pointers, each set once by an
+ * atomic compare and swap and never changed afterwards.
  */
-struct _MyString
+struct _MyStringHashSet
 {
-	char* _string; // The string
-	size_t _length; // The length of the string
+	MyString** _slots; // The MyStrings in the set, NULL for an empty slot
+	size_t _mask; // The number of slots minus 1
+	size_t _size; // The number of MyStrings in the set, changed atomically
 };
 
-// ------------------------------ functions -----------------------------
+/**
+ * Represents a string in myStringKeySort: the key of the string with its first chars cached in
+ * the prefix.
+ */
+typedef struct
+{
+	uint64_t _prefix; // The first PREFIX_LENGTH chars of the key, ordered like the default order
+	const MyString* _key; // The key of the string
+	MyString* _str; // The string
+} SortKey;
 
 /**
- * @brief Check if the string of given MyString is not NULL and if so, free it.
- * @param str
+ * Represents a string in myStringNaturalSort: its natural key from the first char that isn't
+ * common to all the keys, with the first chars of it cached in the prefix.
  */
-static void freeString(MyString* str)
+typedef struct
 {
-	if (str != NULL && str->_string != NULL)
-	{
-		free(str->_string);
-	}
+	uint64_t _prefix; // The first PREFIX_LENGTH chars of the key, ordered like the default order
+	const char* _key; // The key, in a buffer shared by all the keys
+	size_t _length; // The number of chars of the key
+	MyString* _str; // The string
+} NaturalKey;
+
+/**
+ * Represents a slot in the hash tables used to find duplicates
+ */
+typedef struct
+{
+	uint64_t _hash; // The hash of the MyString
+	size_t _index; // The place of the MyString in the array, or EMPTY_SLOT
+} HashSlot;
+
+/**
+ * Represents a MyStringArray
+ */
+struct _MyStringArray
+{
+	void* _map; // The mapped file
+	size_t _mapSize; // The size of the mapped file
+	size_t _len; // The number of MyStrings
+	MyString* _views; // The MyStrings, borrowing their strings from the mapped file
+	MyString** _strings; // Pointers to _views, which the caller may reorder
+};
+
+/**
+ * Represents a MyStringBuilder
+ */
+struct _MyStringBuilder
+{
+	char* _string; // The buffer, allocated by allocBytes
+	size_t _length; // The number of chars appended
+	size_t _capacity; // The number of chars allocated to the buffer
+};
+
+// ------------------------------ statistics ----------------------------
+
+#ifdef MYSTRING_STATS
+
+/*
+ * Statistics: every thread counts its own allocations, copies and calls to the public functions
+ * in counters only it writes to, and the counters of all the threads are summed on demand.
+ */
+
+/*
+ * The public functions whose calls are counted
+ */
+#define MYSTRING_FUNCTIONS(X) \
+	X(myStringAlloc) X(myStringFree) X(myStringClone) X(myStringSetFromMyString) X(myStringFilter) \
+	X(myStringToLower) X(myStringToUpper) X(myStringTranslate) X(myStringTrim) X(myStringReplace) \
+	X(myStringReplaceAll) X(myStringSetFromCString) X(myStringSetFromBuffer) X(myStringSetFromInt) \
+	X(myStringToInt) X(myStringParseInts) X(myStringToCString) X(myStringCStr) X(myStringCat) \
+	X(myStringCatTo) X(myStringCatMany) X(myStringMove) X(myStringSwap) X(myStringBufferAlloc) \
+	X(myStringBufferFree) X(myStringAdoptBuffer) X(myStringReleaseBuffer) X(myStringCompare) \
+	X(myStringCustomCompare) X(myStringEqual) X(myStringCustomEqual) X(myStringMemUsage) \
+	X(myStringLen) X(myStringMemInfo) X(myStringCompress) X(myStringIsCompressed) X(myStringData) \
+	X(myStringWrite) X(myStringValidateUtf8) X(myStringCodepointLen) X(myStringNextCodepoint) \
+	X(myStringCustomSort) X(myStringSort) X(myStringCustomPartialSort) X(myStringPartialSort) \
+	X(myStringCustomNthElement) X(myStringNthElement) X(myStringKeySort) X(myStringNaturalSort) \
+	X(myStringFreeze) X(myStringIsFrozen) X(myStringRetain) X(myStringHashSetAlloc) \
+	X(myStringHashSetFree) X(myStringHashSetInsert) X(myStringHashSetFind) X(myStringHashSetSize) \
+	X(myStringUnique) X(myStringCountDistinct) X(myStringEstimateDistinct) X(myStringSetAllocator) \
+	X(myStringArraySerialize) X(myStringArrayLoad) X(myStringArrayFree) X(myStringArrayLen) \
+	X(myStringArrayStrings) X(myStringBuilderAlloc) X(myStringBuilderFree) X(myStringBuilderReset) \
+	X(myStringBuilderLen) X(myStringBuilderAppendChar) X(myStringBuilderAppendCString) \
+	X(myStringBuilderAppendMyString) X(myStringBuilderAppendInt) X(myStringBuilderAppendDouble) \
+	X(myStringBuilderAppendf) X(myStringBuilderBuild)
+
+#define STAT_CALLS_OF(function) STAT_CALLS_##function,
+#define NAME_OF(function) #function,
+
+/*
+ * The counters of every thread
+ */
+typedef enum
+{
+	STAT_ALLOCATIONS,
+	STAT_FREES,
+	STAT_BYTES_ALLOCATED,
+	STAT_BYTES_FREED,
+	STAT_COPIES,
+	STAT_BYTES_COPIED,
+	MYSTRING_FUNCTIONS(STAT_CALLS_OF)
+	NUM_OF_STATS
+} Stat;
+
+static const char* functionNames[] = {MYSTRING_FUNCTIONS(NAME_OF)};
+
+/**
+ * The counters of a thread. Kept in allStats after the thread exits, so its counts are not lost,
+ * and given with its counts to the next new thread, which keeps adding to them.
+ */
+typedef struct ThreadStats
+{
+	unsigned long long _counters[NUM_OF_STATS]; // Written by the owner thread only
+	struct ThreadStats* _next; // The next ThreadStats in allStats
+	struct ThreadStats* _nextFree; // The next ThreadStats in freeStats
+} ThreadStats;
+
+static __thread ThreadStats* currentStats = NULL;
+static ThreadStats* allStats = NULL;
+static ThreadStats* freeStats = NULL; // The counters of exited threads
+static pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t statsKey;
+static pthread_once_t statsKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Gives the counters of an exiting thread to the next new thread. Called when a thread that
+ * 		  counted something exits.
+ * @param arg the counters of the thread
+ */
+static void releaseStats(void* arg)
+{
+	ThreadStats* stats = (ThreadStats*)arg;
+
+	currentStats = NULL;
+	pthread_mutex_lock(&statsLock);
+	stats->_nextFree = freeStats;
+	freeStats = stats;
+	pthread_mutex_unlock(&statsLock);
 }
 
 /**
- * @brief Find the length of c string.
- * 		  cString should be set and not NULL.
- * @param cString
- * @return the length
+ * @brief Creates the key used to call releaseStats when a thread exits.
  */
-static size_t getLength(const char* cString)
+static void createStatsKey()
 {
-	size_t length = 0;
+	pthread_key_create(&statsKey, releaseStats);
+}
 
-	while (cString[length] != '\0')
+/**
+ * @brief Adds value to a counter of the current thread.
+ * @param stat the counter
+ * @param value
+ */
+static void addStat(Stat stat, unsigned long long value)
+{
+	if (currentStats == NULL)
 	{
-		length++;
+		pthread_once(&statsKeyOnce, createStatsKey);
+
+		pthread_mutex_lock(&statsLock);
+		ThreadStats* stats = freeStats;
+		if (stats != NULL)
+		{
+			freeStats = stats->_nextFree;
+		}
+		else
+		{
+			stats = (ThreadStats*)calloc(1, sizeof(ThreadStats));
+			if (stats != NULL)
+			{
+				stats->_next = allStats;
+				allStats = stats;
+			}
+		}
+		pthread_mutex_unlock(&statsLock);
+
+		if (stats == NULL)
+		{
+			return;
+		}
+		currentStats = stats;
+		pthread_setspecific(statsKey, stats);
 	}
 
-	return length;
+	// Only this thread writes the counter, so a load and a store are enough
+	unsigned long long* counter = &currentStats->_counters[stat];
+	__atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
 }
 
 /**
- * @brief Find the number of digits of given number.
- * 		  num should be set and not null.
- * @param num
- * @return The number of digits
+ * @brief Sums the counters of all the threads.
+ * @param totals set to the sums, should have NUM_OF_STATS places
  */
-static int getNumOfDigits(int num)
+static void sumStats(unsigned long long* totals)
 {
-	int numOfDigits = 0;
-	while (num != 0)
+	size_t i;
+	memset(totals, 0, NUM_OF_STATS * sizeof(unsigned long long));
+
+	pthread_mutex_lock(&statsLock);
+	ThreadStats* stats;
+	for (stats = allStats; stats != NULL; stats = stats->_next)
 	{
-		numOfDigits++;
-		num /= 10;
+		for (i = 0; i < NUM_OF_STATS; i++)
+		{
+			totals[i] += __atomic_load_n(&stats->_counters[i], __ATOMIC_RELAXED);
+		}
 	}
+	pthread_mutex_unlock(&statsLock);
+}
 
-	return numOfDigits;
+#define COUNT_STAT(stat, value) addStat(stat, value)
+#define COUNT_CALL(function) addStat(STAT_CALLS_##function, 1)
+
+#else
+
+#define COUNT_STAT(stat, value) ((void)(value))
+#define COUNT_CALL(function)
+
+#endif // MYSTRING_STATS
+
+// ------------------------------ allocation ----------------------------
+
+/**
+ * @brief The default malloc of the allocator.
+ * @param size
+ * @param ctx unused
+ * @return the result of malloc
+ */
+static void* defaultMalloc(size_t size, void* ctx)
+{
+	(void)ctx;
+	return malloc(size);
 }
 
 /**
- * @brief Compare between 2 chars by their ASCII value
- * @param ch1
- * @param ch2
- * @return 1 if ch1 is bigger then ch2, -1 if ch2 is bigger then ch1, 0 if they are equal.
+ * @brief The default realloc of the allocator.
+ * @param ptr
+ * @param size
+ * @param ctx unused
+ * @return the result of realloc
  */
-static int defaultComparator(const char ch1, const char ch2)
+static void* defaultRealloc(void* ptr, size_t size, void* ctx)
 {
-	if (ch1 > ch2)
-	{
-		return 1;
-	}
-	else if (ch1 < ch2)
-	{
-		return -1;
-	}
-	else
-	{
-		return 0;
-	}
+	(void)ctx;
+	return realloc(ptr, size);
 }
 
 /**
- * @brief Used to cast 2 void* pointers into 2 MyString** pointers and  call to myStringCompare
- * 		  with the new pointers.
- * 		  str1 and str2 should be allocated.
- * @param str1
- * @param str2
- * @return result of myStringCompare
+ * @brief The default free of the allocator.
+ * @param ptr
+ * @param ctx unused
  */
-static int myStringComparatorCasting(const void* str1, const void* str2)
+static void defaultFree(void* ptr, void* ctx)
 {
-	MyString* myStr1 = *(MyString**)str1;
-	MyString* myStr2 = *(MyString**)str2;
-	return myStringCompare(myStr1, myStr2);
+	(void)ctx;
+	free(ptr);
 }
 
 /**
- * @brief Allocates a new MyString and sets its value to "" (the empty string).
- * 			It is the caller's responsibility to free the returned MyString.
- *
- * 	COMPLEXITY: O(1) because there is a constant number of commands: creating pointer to MyString,
- * 				allocating it using malloc (assume malloc is O(1)), comparison, setting
- * 				values to the MyString allocated and return.
- *
- * RETURN VALUE:
- * @return a pointer to the new string, or NULL if the allocation failed.
+ * The allocator set by myStringSetAllocator
  */
-MyString * myStringAlloc()
+typedef struct
 {
-	MyString* myString = (MyString*)malloc(sizeof(MyString));
-	if (myString == NULL)
-	{
-		return NULL;
-	}
+	void* (*_malloc)(size_t, void*);
+	void* (*_realloc)(void*, size_t, void*);
+	void (*_free)(void*, void*);
+	void* _ctx;
+} Allocator;
+
+static Allocator allocator = {defaultMalloc, defaultRealloc, defaultFree, NULL};
+
+#ifdef MYSTRING_THREAD_CACHE
+
+/*
+ * Thread cache: every thread keeps free lists of blocks in a few size classes, so allocating and
+ * freeing MyStrings and their strings doesn't go through the system allocator.
+ * A block freed by another thread is pushed to a lock-free stack of its owner cache, and is moved
+ * to the free lists by the owner when it runs out of blocks. The cache of an exiting thread is
+ * kept for the next new thread, since blocks it owns may still be freed by other threads.
+ */
 
-	myString->_string = NULL;
-	myString->_length = 0;
+#define NUM_OF_SIZE_CLASSES 8
+#define MIN_CLASS_SIZE 32
+#define UNCACHED_CLASS NUM_OF_SIZE_CLASSES
+#define MAX_FREE_BLOCKS 256
 
-	return myString;
+struct ThreadCache;
+
+/**
+ * The header of every allocated block. While the block is free, it is followed by the pointer to
+ * the next free block.
+ */
+typedef struct CacheBlock
+{
+	struct ThreadCache* _owner; // The cache the block returns to, or NULL if it isn't cached
+	size_t _sizeClass; // The size class of the block, or UNCACHED_CLASS
+} CacheBlock;
+
+/**
+ * The blocks cached by a thread
+ */
+typedef struct ThreadCache
+{
+	CacheBlock* _free[NUM_OF_SIZE_CLASSES]; // Free lists, used by the owner thread only
+	size_t _numOfFree[NUM_OF_SIZE_CLASSES]; // The lengths of the free lists
+	CacheBlock* _remote; // Blocks freed by other threads, a lock-free stack
+	struct ThreadCache* _nextOrphan; // The next cache in orphanCaches
+} ThreadCache;
+
+static __thread ThreadCache* currentCache = NULL;
+static ThreadCache* orphanCaches = NULL;
+static pthread_mutex_t orphanLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t cacheKey;
+static pthread_once_t cacheKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * @param block a free block
+ * @return the place of the pointer to the next free block
+ */
+static CacheBlock** nextBlock(CacheBlock* block)
+{
+	return (CacheBlock**)(block + 1);
 }
 
 /**
- * @brief Frees the memory and resources allocated to str.
- * COMPLEXITY: O(1) because there is a constant number of commands: comparrison and freeing memory
- * 			   using free (assume free is O(1))
- * @param str the MyString to free.
- * If str is NULL, no operation is performed.
+ * @brief Adds a free block to a free list of cache, or frees it if the list is full.
+ * 		  Called by the owner thread of cache only.
+ * @param cache
+ * @param block
  */
-void myStringFree(MyString *str)
+static void pushFreeBlock(ThreadCache* cache, CacheBlock* block)
 {
-	if(str != NULL)
+	size_t sizeClass = block->_sizeClass;
+	if (cache->_numOfFree[sizeClass] >= MAX_FREE_BLOCKS)
 	{
-		free(str->_string);
-		free(str);
+		free(block);
+		return;
 	}
+
+	*nextBlock(block) = cache->_free[sizeClass];
+	cache->_free[sizeClass] = block;
+	cache->_numOfFree[sizeClass]++;
 }
 
 /**
- * @brief Allocates a new MyString with the same value as str. It is the caller's
- * 			responsibility to free the returned MyString.
- * @param str the MyString to clone.
- * COMPLEXITY: O(N) because myStringSetFromMyString is O(N).
- * RETURN VALUE:
- *   @return a pointer to the new string, or NULL if the allocation failed.
+ * @brief Moves the blocks freed by other threads to the free lists of cache.
+ * 		  Called by the owner thread of cache only.
+ * @param cache
  */
-MyString * myStringClone(const MyString *str)
+static void collectRemoteBlocks(ThreadCache* cache)
 {
-	if (str == NULL)
+	CacheBlock* block = __atomic_exchange_n(&cache->_remote, NULL, __ATOMIC_ACQUIRE);
+	while (block != NULL)
 	{
-		return NULL;
+		CacheBlock* next = *nextBlock(block);
+		pushFreeBlock(cache, block);
+		block = next;
 	}
+}
 
-	MyString* clone = myStringAlloc();
+/**
+ * @brief Called when a thread exits: frees the cached blocks and keeps the cache for the next
+ * 		  new thread.
+ * @param arg the cache of the thread
+ */
+static void releaseCache(void* arg)
+{
+	ThreadCache* cache = (ThreadCache*)arg;
+	size_t i;
 
-	if (clone == NULL)
+	collectRemoteBlocks(cache);
+	for (i = 0; i < NUM_OF_SIZE_CLASSES; i++)
 	{
-		return NULL;
+		while (cache->_free[i] != NULL)
+		{
+			CacheBlock* block = cache->_free[i];
+			cache->_free[i] = *nextBlock(block);
+			free(block);
+		}
+		cache->_numOfFree[i] = 0;
 	}
 
-	if (myStringSetFromMyString(clone, str) == MYSTRING_ERROR)
-	{
-		return NULL;
-	}
+	currentCache = NULL;
+	pthread_mutex_lock(&orphanLock);
+	cache->_nextOrphan = orphanCaches;
+	orphanCaches = cache;
+	pthread_mutex_unlock(&orphanLock);
+}
 
-	return clone;
+/**
+ * @brief Creates the key used to call releaseCache when a thread exits.
+ */
+static void createCacheKey()
+{
+	pthread_key_create(&cacheKey, releaseCache);
 }
 
 /**
- * @brief Sets the value of str to the value of other.
- * COMPLEXITY: O(N) where N is the length of str, or the number of bytes of str->string takes,
- * 			   because of memcpy complexity.
- * @param str the MyString to set
- * @param other the MyString to set from
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
-*/
-MyStringRetVal myStringSetFromMyString(MyString *str, const MyString *other)
+ * @return the cache of the current thread, or NULL if it couldn't be allocated.
+ */
+static ThreadCache* getCache()
 {
-	if (str == NULL || other == NULL)
+	if (currentCache != NULL)
 	{
-		return MYSTRING_ERROR;
+		return currentCache;
 	}
 
-	freeString(str);
-
-	str->_string = (char*)malloc(other->_length*sizeof(char));
+	pthread_once(&cacheKeyOnce, createCacheKey);
 
-	if (str->_string == NULL)
+	pthread_mutex_lock(&orphanLock);
+	ThreadCache* cache = orphanCaches;
+	if (cache != NULL)
 	{
-		return MYSTRING_ERROR;
+		orphanCaches = cache->_nextOrphan;
 	}
+	pthread_mutex_unlock(&orphanLock);
 
-	str->_length = other->_length;
-	memcpy(str->_string, other->_string, str->_length);
+	if (cache == NULL)
+	{
+		cache = (ThreadCache*)calloc(1, sizeof(ThreadCache));
+	}
+	if (cache != NULL)
+	{
+		currentCache = cache;
+		pthread_setspecific(cacheKey, cache);
+	}
 
-	return MYSTRING_SUCCESS;
+	return cache;
 }
 
 /**
- * @brief filter the value of str acording to a filter.
- * 	remove from str all the occurrence of chars that are filtered by filt
- *	(i.e. filr(char)==true)
- *	COMPLEXITY: O(N) where N is the length of str, because the loop runs on every char in str.
- *				If the given filt is bigger then O(N), then the complexity is that of filt.
- * @param str the MyString to filter
- * @param filt the filter
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure. */
-MyStringRetVal myStringFilter(MyString *str, bool (*filt)(const char *))
+ * @brief Finds the size class of the blocks of size bytes.
+ * @param size
+ * @param classSize set to the size of the blocks of the class
+ * @return the size class, or UNCACHED_CLASS if such blocks aren't cached: they are bigger than
+ * 		   all the classes, or a custom allocator is set and is used directly.
+ */
+static size_t cachedClass(size_t size, size_t* classSize)
 {
-	if (str == NULL || str->_string == NULL || filt == NULL)
+	size_t sizeClass = 0;
+	*classSize = MIN_CLASS_SIZE;
+	while (sizeClass < NUM_OF_SIZE_CLASSES && *classSize < size)
 	{
-		return MYSTRING_ERROR;
+		sizeClass++;
+		*classSize <<= 1;
 	}
+	return sizeClass < NUM_OF_SIZE_CLASSES && allocator._malloc == defaultMalloc ?
+		   sizeClass : UNCACHED_CLASS;
+}
 
-	char* filteredString = (char*)malloc(str->_length * sizeof(char));
-
-	unsigned int i, j = 0;
+/**
+ * @brief Allocates size bytes from the cache of the current thread.
+ * @param size
+ * @return pointer to the allocated bytes, or NULL if the allocation failed.
+ */
+static void* allocBlock(size_t size)
+{
+	size_t classSize;
+	size_t sizeClass = cachedClass(size, &classSize);
+	ThreadCache* cache = sizeClass != UNCACHED_CLASS ? getCache() : NULL;
+	CacheBlock* block = NULL;
 
-	for (i = 0; i < str->_length; i++)
+	if (cache != NULL)
 	{
-		if (filt(&str->_string[i]) == false)
+		if (cache->_free[sizeClass] == NULL)
 		{
-			filteredString[j] = str->_string[i];
-			j++;
+			collectRemoteBlocks(cache);
 		}
-	}
 
-	freeString(str);
-	str->_length = j;
-	str->_string = (char*)malloc(str->_length * sizeof(char));
+		block = cache->_free[sizeClass];
+		if (block != NULL)
+		{
+			cache->_free[sizeClass] = *nextBlock(block);
+			cache->_numOfFree[sizeClass]--;
+			return block + 1;
+		}
 
-	if (str->_string == NULL)
+		block = (CacheBlock*)malloc(sizeof(CacheBlock) + classSize);
+	}
+	else
 	{
-		return MYSTRING_ERROR;
+		// Without a cache the block still takes the size of its class, like allocatedSize says
+		size_t blockSize = sizeClass != UNCACHED_CLASS ? classSize : size;
+		block = (CacheBlock*)allocator._malloc(sizeof(CacheBlock) + blockSize, allocator._ctx);
 	}
 
-	memcpy(str->_string, filteredString, str->_length);
-
-	free(filteredString);
+	if (block == NULL)
+	{
+		return NULL;
+	}
 
-	return MYSTRING_SUCCESS;
+	block->_owner = cache;
+	block->_sizeClass = cache != NULL ? sizeClass : UNCACHED_CLASS;
+	return block + 1;
 }
 
 /**
- * @brief Sets the value of str to the value of the given C string.
- * 			The given C string must be terminated by the null character.
- * 			Checking will not use a string without the null character.
- * 	COMPLEXICTY: O(N) where N is the length of cString because getLength() is O(N) and also
- * 				 memcpy() is O(N).
- * @param str the MyString to set.
- * @param cString the C string to set from.
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ * @brief Frees bytes allocated by allocBlock, from any thread.
+ * @param ptr
  */
-MyStringRetVal myStringSetFromCString(MyString *str, const char * cString)
+static void freeBlock(void* ptr)
 {
-	if (str == NULL || cString == NULL)
+	if (ptr == NULL)
 	{
-		return MYSTRING_ERROR;
+		return;
 	}
 
-	freeString(str);
-
-	str->_length = getLength(cString);
-	str->_string = (char*)malloc(str->_length * sizeof(char));
+	CacheBlock* block = (CacheBlock*)ptr - 1;
+	ThreadCache* owner = block->_owner;
 
-	if (str->_string == NULL)
+	if (owner == NULL)
 	{
-		return MYSTRING_ERROR;
+		allocator._free(block, allocator._ctx);
+	}
+	else if (owner == currentCache)
+	{
+		pushFreeBlock(owner, block);
+	}
+	else
+	{
+		CacheBlock* head = __atomic_load_n(&owner->_remote, __ATOMIC_RELAXED);
+		do
+		{
+			*nextBlock(block) = head;
+		} while (!__atomic_compare_exchange_n(&owner->_remote, &head, block, true,
+											  __ATOMIC_RELEASE, __ATOMIC_RELAXED));
 	}
-
-	memcpy(str->_string, cString, str->_length);
-
-	return MYSTRING_SUCCESS;
 }
 
 /**
- * @brief Sets the value of str to the value of the integer n.
- *	(i.e. if n=7 than str should contain ‘7’)
- * 	You are not allowed to use itoa (or a similar functions) here but must code your own conversion
- * 	function.
- * COMPLEXICTY: O(N) where N is the number of digits on the given int n, because getNumberOfDigits
- * runs in O(N) and also the loop in this function runs for N times.
- * @param str the MyString to set.
- * @param n the int to set from.
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ * @brief Changes the size of a block allocated by allocBlock, from any thread.
+ * @param ptr
+ * @param oldSize the number of bytes allocated to ptr
+ * @param size
+ * @return pointer to the reallocated bytes, or NULL if the allocation failed (and ptr is kept).
  */
-MyStringRetVal myStringSetFromInt(MyString *str, int n)
+static void* reallocBlock(void* ptr, size_t oldSize, size_t size)
 {
-	if (str == NULL)
+	CacheBlock* block = (CacheBlock*)ptr - 1;
+	size_t classSize;
+	if (block->_owner == NULL && cachedClass(size, &classSize) == UNCACHED_CLASS)
 	{
-		return MYSTRING_ERROR;
+		block = (CacheBlock*)allocator._realloc(block, sizeof(CacheBlock) + size, allocator._ctx);
+		return block != NULL ? block + 1 : NULL;
 	}
 
-	freeString(str);
-	int num = getNumOfDigits(n);
-	str->_length = num;
-
-	if (n < 0)
-	{
-		str->_length++;
-		str->_string = (char*)malloc(str->_length * sizeof(char));
-		str->_string[0] = '-';
-		n *= -1;
-	}
-	else
+	void* newPtr = allocBlock(size);
+	if (newPtr != NULL)
 	{
-		str->_string = (char*)malloc(str->_length * sizeof(char));
+		memcpy(newPtr, ptr, oldSize < size ? oldSize : size);
+		freeBlock(ptr);
 	}
+	return newPtr;
+}
 
+#else
 
-	if (str->_string == NULL)
-	{
-		return MYSTRING_ERROR;
-	}
+/**
+ * @brief Allocates size bytes.
+ * @param size
+ * @return pointer to the allocated bytes, or NULL if the allocation failed.
+ */
+static void* allocBlock(size_t size)
+{
+	return allocator._malloc(size, allocator._ctx);
+}
 
-	int i;
+/**
+ * @brief Frees bytes allocated by allocBlock.
+ * @param ptr
+ */
+static void freeBlock(void* ptr)
+{
+	allocator._free(ptr, allocator._ctx);
+}
+
+/**
+ * @brief Changes the size of a block allocated by allocBlock.
+ * @param ptr
+ * @param oldSize unused
+ * @param size
+ * @return pointer to the reallocated bytes, or NULL if the allocation failed (and ptr is kept).
+ */
+static void* reallocBlock(void* ptr, size_t oldSize, size_t size)
+{
+	(void)oldSize;
+	return allocator._realloc(ptr, size, allocator._ctx);
+}
+
+#endif // MYSTRING_THREAD_CACHE
 
-	for (i = 0; i < num; i++)
+/**
+ * @brief Find the number of bytes the allocator takes for an allocation of size bytes, including
+ * 		  its headers and rounding. The overhead of the system allocator is estimated from the
+ * 		  chunks of glibc's malloc; the overhead of a custom allocator is unknown, so only the
+ * 		  bytes asked of it are counted.
+ * @param size
+ * @return the number of bytes
+ */
+static size_t allocatedSize(size_t size)
+{
+#ifdef MYSTRING_THREAD_CACHE
+	// The same test as allocBlock, so a block is counted with the size it really takes
+	size_t classSize;
+	return sizeof(CacheBlock) +
+		   (cachedClass(size, &classSize) != UNCACHED_CLASS ? classSize : size);
+#else
+	if (allocator._malloc != defaultMalloc)
 	{
-		str->_string[str->_length - i - 1] = (char)(n % 10) + TO_INT_ASCII;
-		n /= 10;
+		return size;
 	}
 
-	return MYSTRING_SUCCESS;
+	// The chunks of the system allocator (like glibc's malloc) have a size_t header and are
+	// aligned to and at least MIN_CHUNK_SIZE bytes
+	size_t chunk = (size + sizeof(size_t) + CHUNK_ALIGNMENT - 1) & ~(size_t)(CHUNK_ALIGNMENT - 1);
+	return chunk < MIN_CHUNK_SIZE ? MIN_CHUNK_SIZE : chunk;
+#endif
 }
 
 /**
- * @brief Returns the value of str as an integer.
- * 	If str cannot be parsed as an integer,
- * 	the return value should be MYSTR_ERROR_CODE
- * 	NOTE: positive and negative integers should be supported.
- * 	COMPLEXITY: O(N) where N is the length of str, because the loop runs for N times.
- * @param str the MyString
- * @return an integer
+ * The process wide gauges of a thread: the bytes and the MyStrings it allocated minus the ones it
+ * freed. Only the owner thread writes them, so updating them doesn't need atomic read-modify-write
+ * operations, and they are summed when the gauges are read. Kept in allGauges after the thread
+ * exits, since the memory it allocated may still be alive, and given with their values to the
+ * next new thread, which keeps adding to them.
  */
-int myStringToInt(const MyString *str)
+typedef struct ThreadGauges
 {
-	if (str == NULL)
-	{
-		return MYSTR_ERROR_CODE;
-	}
+	long long _liveBytes; // Written by the owner thread only
+	long long _liveObjects; // Written by the owner thread only
+	struct ThreadGauges* _next; // The next ThreadGauges in allGauges
+	struct ThreadGauges* _nextFree; // The next ThreadGauges in freeGauges
+} ThreadGauges;
+
+static __thread ThreadGauges* currentGauges = NULL;
+static ThreadGauges* allGauges = NULL;
+static ThreadGauges sharedGauges; // Used atomically by threads that couldn't allocate their own
+static ThreadGauges* freeGauges = NULL; // The gauges of exited threads
+static pthread_mutex_t freeGaugesLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t gaugesKey;
+static pthread_once_t gaugesKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Gives the gauges of an exiting thread to the next new thread. Called when a thread that
+ * 		  allocated or freed something exits.
+ * @param arg the gauges of the thread
+ */
+static void releaseGauges(void* arg)
+{
+	ThreadGauges* gauges = (ThreadGauges*)arg;
+
+	currentGauges = NULL;
+	pthread_mutex_lock(&freeGaugesLock);
+	gauges->_nextFree = freeGauges;
+	freeGauges = gauges;
+	pthread_mutex_unlock(&freeGaugesLock);
+}
 
-	int power = 1, num = 0, i;
+/**
+ * @brief Creates the key used to call releaseGauges when a thread exits.
+ */
+static void createGaugesKey()
+{
+	pthread_key_create(&gaugesKey, releaseGauges);
+}
 
-	for (i = str->_length - 1; i >= 0; i--)
+/**
+ * @brief Adds delta to a gauge of the current thread.
+ * @param gauge the offset of the gauge in ThreadGauges
+ * @param delta
+ */
+static void updateGauge(size_t gauge, long long delta)
+{
+	if (currentGauges == NULL)
 	{
-		if (str->_string[i] >= ZERO_ASCII && str->_string[i] <= NINE_ASCII)
+		pthread_once(&gaugesKeyOnce, createGaugesKey);
+
+		pthread_mutex_lock(&freeGaugesLock);
+		ThreadGauges* gauges = freeGauges;
+		if (gauges != NULL)
 		{
-			num += ((int)str->_string[i] - TO_INT_ASCII)*power;
-			power *= 10;
+			freeGauges = gauges->_nextFree;
 		}
-		else if (i == 0 && ( str->_string[i] == PLUS_ASCII || str->_string[i] == MINUS_ASCII ))
+		pthread_mutex_unlock(&freeGaugesLock);
+
+		if (gauges == NULL)
 		{
-			if (str->_string[i] == MINUS_ASCII)
+			gauges = (ThreadGauges*)calloc(1, sizeof(ThreadGauges));
+			if (gauges == NULL)
+			{
+				__atomic_add_fetch((long long*)((char*)&sharedGauges + gauge), delta,
+								   __ATOMIC_RELAXED);
+				return;
+			}
+
+			// Gauges are only pushed to the list and never removed, so a simple push is safe
+			gauges->_next = __atomic_load_n(&allGauges, __ATOMIC_RELAXED);
+			while (!__atomic_compare_exchange_n(&allGauges, &gauges->_next, gauges, true,
+												__ATOMIC_RELEASE, __ATOMIC_RELAXED))
 			{
-				num *= -1;
 			}
 		}
-		else
-		{
-			return MYSTR_ERROR_CODE;
-		}
+		currentGauges = gauges;
+		pthread_setspecific(gaugesKey, gauges);
 	}
 
-	return num;
+	long long* value = (long long*)((char*)currentGauges + gauge);
+	__atomic_store_n(value, __atomic_load_n(value, __ATOMIC_RELAXED) + delta, __ATOMIC_RELAXED);
 }
 
 /**
- * @brief Returns the value of str as a C string, terminated with the
- * 	null character. It is the caller's responsibility to free the returned
- * 	string by calling free().
- * 	COMPLEXCITY: O(N) where N is the length of str because of memcpy.
- * @param str the MyString
- * RETURN VALUE:
- *  @return the new string, or NULL if the allocation failed.
+ * @param gauge the offset of the gauge in ThreadGauges
+ * @return the value of the gauge, summed over all the threads.
  */
-char * myStringToCString(const MyString *str)
+static long long readGauge(size_t gauge)
 {
-	if (str == NULL)
+	long long value = __atomic_load_n((long long*)((char*)&sharedGauges + gauge), __ATOMIC_RELAXED);
+	ThreadGauges* gauges;
+
+	for (gauges = __atomic_load_n(&allGauges, __ATOMIC_ACQUIRE); gauges != NULL;
+		 gauges = gauges->_next)
 	{
-		return NULL;
+		value += __atomic_load_n((long long*)((char*)gauges + gauge), __ATOMIC_RELAXED);
 	}
-
-	char* cString = (char*)malloc((str->_length + 1) * sizeof(char));
-	memcpy(cString, str->_string, str->_length);
-	cString[str->_length] = '\0';
-	return cString;
+	return value;
 }
 
+#define LIVE_BYTES offsetof(ThreadGauges, _liveBytes)
+#define LIVE_OBJECTS offsetof(ThreadGauges, _liveObjects)
+
 /**
- * @brief Appends a copy of the source MyString src to the destination MyString dst.
- * COMPLEXCITY: O(N) where N is the length of src, because of memcpy.
- * @param dest the destination
- * @param src the MyString to append
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ * @brief Allocates size bytes for the library.
+ * @param size
+ * @return pointer to the allocated bytes, or NULL if the allocation failed.
  */
-MyStringRetVal myStringCat(MyString * dest, const MyString * src)
+static void* allocBytes(size_t size)
 {
-	if (dest == NULL || src == NULL)
+	void* ptr = allocBlock(size);
+	if (ptr != NULL)
 	{
-		return MYSTRING_ERROR;
+		COUNT_STAT(STAT_ALLOCATIONS, 1);
+		COUNT_STAT(STAT_BYTES_ALLOCATED, size);
+		updateGauge(LIVE_BYTES, (long long)allocatedSize(size));
 	}
+	return ptr;
+}
 
-	char* temp = myStringToCString(dest);
-
-	freeString(dest);
-	dest->_string = (char*)malloc((dest->_length + src->_length) * sizeof(char));
-
-	if (dest->_string == NULL)
+/**
+ * @brief Frees size bytes allocated by allocBytes.
+ * @param ptr
+ * @param size the number of bytes allocated to ptr
+ */
+static void freeBytes(void* ptr, size_t size)
+{
+	if (ptr != NULL)
 	{
-		return MYSTRING_ERROR;
+		COUNT_STAT(STAT_FREES, 1);
+		COUNT_STAT(STAT_BYTES_FREED, size);
+		updateGauge(LIVE_BYTES, -(long long)allocatedSize(size));
+		freeBlock(ptr);
 	}
-
-	memcpy(dest->_string, temp, dest->_length);
-	memcpy(dest->_string + dest->_length, src->_string, src->_length);
-
-	dest->_length += src->_length;
-
-	free(temp);
-
-	return MYSTRING_SUCCESS;
 }
 
 /**
- * @brief Sets result to be the concatenation of str1 and str2.
- * 	result should be initially allocated by the caller.
- * 	result shouldn't be the same struct as str1 or str2.
- * 	COMPLEXITY: O(N + M) where N is the length of str1 and M is the length of str2 because of
- * 				the 2 memcpy calls.
- * @param str1
- * @param str2
- * @param result
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ * @brief Changes the size of bytes allocated by allocBytes.
+ * @param ptr
+ * @param oldSize the number of bytes allocated to ptr
+ * @param size
+ * @return pointer to the reallocated bytes, or NULL if the allocation failed (and ptr is kept).
  */
-MyStringRetVal myStringCatTo(const MyString *str1, const MyString *str2, MyString *result)
+static void* reallocBytes(void* ptr, size_t oldSize, size_t size)
 {
-	if (str1 == NULL || str2 == NULL || result == NULL)
+	void* newPtr = reallocBlock(ptr, oldSize, size);
+	if (newPtr != NULL)
 	{
-		return MYSTRING_ERROR;
+		COUNT_STAT(STAT_FREES, 1);
+		COUNT_STAT(STAT_BYTES_FREED, oldSize);
+		COUNT_STAT(STAT_ALLOCATIONS, 1);
+		COUNT_STAT(STAT_BYTES_ALLOCATED, size);
+		updateGauge(LIVE_BYTES, (long long)allocatedSize(size) - (long long)allocatedSize(oldSize));
 	}
+	return newPtr;
+}
 
-	freeString(result);
-
-	result->_string = (char*)malloc((str1->_length + str2->_length) * sizeof(char));
-	if (result->_string == NULL)
+/**
+ * @brief Copies n bytes from src to dest, which should not overlap.
+ * @param dest
+ * @param src
+ * @param n
+ */
+static void copyBytes(void* dest, const void* src, size_t n)
+{
+	COUNT_STAT(STAT_COPIES, 1);
+	COUNT_STAT(STAT_BYTES_COPIED, n);
+	if (n > 0)
 	{
-		return MYSTRING_ERROR;
+		memcpy(dest, src, n);
 	}
-
-	memcpy(result->_string, str1->_string, str1->_length);
-	memcpy(result->_string + str1->_length, str2->_string, str2->_length);
-	result->_length = str1->_length + str2->_length;
-
-	return MYSTRING_SUCCESS;
 }
 
 /**
- * @brief Compare str1 and str2.
- * COMPLEXITY: O(N) where N is the length of the shorter of str1 and str2, because that the
- * complexity of myStringCustomCompare()
- * @param str1
- * @param str2
- *
- * RETURN VALUE:
- * @return an integral value indicating the relationship between the strings:
- * 	A zero value indicates that the strings are equal.
- * 	A value greater than zero indicates that the first character that does not match has a greater
- * 	ASCII value in str1 than in str2;
- * 	And a value less than zero indicates the opposite.
- * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+ * @brief Copies n bytes from src to dest, which may overlap.
+ * @param dest
+ * @param src
+ * @param n
  */
-int myStringCompare(const MyString *str1, const MyString *str2)
+static void moveBytes(void* dest, const void* src, size_t n)
 {
-	if (str1 == NULL || str2 == NULL)
+	COUNT_STAT(STAT_COPIES, 1);
+	COUNT_STAT(STAT_BYTES_COPIED, n);
+	if (n > 0 && dest != src)
 	{
-		return MYSTR_ERROR_CODE;
+		memmove(dest, src, n);
 	}
-	return myStringCustomCompare(str1, str2, defaultComparator);
 }
 
+// ------------------------------ functions -----------------------------
+
 /**
- * @brief Compares str1 and str2.
- * COMPLEXITY: O(N) where N is the length of the shorter one of str1 and str2, because the loop
- * runs N times
- * @param str1
- * @param str2
- * @param comparator
- * RETURN VALUE:
- * @return an integral value indicating the relationship between the strings:
- * 	A zero value indicates that the strings are equal according to the custom comparator
- * 	(3rd parameter).
- * 	A value greater than zero indicates that the first MyString is bigger according to the
- * 	comparator.
- * 	And a value less than zero indicates the opposite.
- * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+ * @brief Check if the string of given MyString is not NULL and if so, free it.
+ * @param str
  */
-int myStringCustomCompare(const MyString* str1, const MyString* str2,
-						  int (*comparator)(const char, const char))
+static void freeString(MyString* str)
 {
-	if (str1->_string == NULL || str2->_string == NULL || str1 == NULL || str2 == NULL)
+	if (str != NULL && str->_string != NULL)
 	{
-		return MYSTR_ERROR_CODE;
+		freeBytes(str->_string, str->_capacity);
+		str->_string = NULL;
+		str->_capacity = 0;
 	}
+}
 
-	unsigned int i = 0;
+/**
+ * @brief The capacity of a new string: one char more than its length, so myStringCStr can
+ * 		  terminate it with the null character without reallocating it.
+ * @param length
+ * @return the number of chars to allocate
+ */
+static size_t stringCapacity(size_t length)
+{
+	return length + 1;
+}
 
-	while (i < str1->_length && i < str2->_length)
-	{
-		if (comparator(str1->_string[i], str2->_string[i]) > 0)
-		{
-			return 1;
-		}
-		else if (comparator(str1->_string[i], str2->_string[i]) < 0)
-		{
-			return -1;
-		}
-		i++;
-	}
+/**
+ * @brief Replaces the string of str with a new string allocated by allocBytes.
+ * @param str
+ * @param string the new string, of capacity bytes
+ * @param capacity
+ * @param length the number of chars of string
+ */
+static void replaceString(MyString* str, char* string, size_t capacity, size_t length)
+{
+	freeString(str);
+	str->_string = string;
+	str->_capacity = capacity;
+	str->_length = length;
+	str->_compressed = false;
+	str->_utf8 = UTF8_UNKNOWN;
+}
 
-	if (str1->_length == str2->_length)
-	{
-		return 0;
-	}
-	else if (str1->_length == i)
+/**
+ * @brief Sets the string of str to a copy of length chars. The string of str is reused if the
+ * 		  chars fill at least half of it (leaving room for the null character of myStringCStr),
+ * 		  otherwise a new string is allocated.
+ * @param str a mutable MyString
+ * @param chars may be in the string of str
+ * @param length
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and str is not changed).
+ */
+static MyStringRetVal setChars(MyString* str, const char* chars, size_t length)
+{
+	if (str->_string != NULL && !str->_compressed && length < str->_capacity &&
+		str->_capacity / 2 <= length)
 	{
-		return -1;
+		moveBytes(str->_string, chars, length);
+		str->_length = length;
+		str->_utf8 = UTF8_UNKNOWN;
+		return MYSTRING_SUCCESS;
 	}
-	else
+
+	size_t capacity = stringCapacity(length);
+	char* string = (char*)allocBytes(capacity * sizeof(char));
+	if (string == NULL)
 	{
-		return 1;
+		return MYSTRING_ERROR;
 	}
+
+	// chars may be in the string of str, so it is freed only after they are copied
+	copyBytes(string, chars, length);
+	replaceString(str, string, capacity, length);
+	return MYSTRING_SUCCESS;
 }
 
 /**
- * @brief Check if str1 is equal to str2.
- * COMPLEXITY: O(N) where N is the length of the shorter of str1 and str2 because of the complexity
- * of myStringCustomEqual()
- * @param str1
- * @param str2
- *
- * RETURN VALUE:
- * @return an integral value indicating the equality of the strings (logical equality -
- * that they are composed of the very same characters):
- * 	A zero value indicates that the strings are not equal.
- * 	A greater than zero value indicates that the strings are equal.
- * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
-  */
-int myStringEqual(const MyString *str1, const MyString *str2)
+ * @brief Writes a length of the compressed format: the bytes following a nibble of 15, each
+ * 		  adding up to 255 to it.
+ * @param dst
+ * @param capacity the size of dst
+ * @param pos the place to write at, advanced past the bytes written
+ * @param length the length minus 15
+ * @return true on success, false if dst is full.
+ */
+static bool lzWriteLength(unsigned char* dst, size_t capacity, size_t* pos, size_t length)
 {
-	if (str1 == NULL || str2 == NULL)
+	while (length >= LZ_LENGTH_BYTE_MAX)
 	{
-		return MYSTR_ERROR_CODE;
+		if (*pos == capacity)
+		{
+			return false;
+		}
+		dst[(*pos)++] = LZ_LENGTH_BYTE_MAX;
+		length -= LZ_LENGTH_BYTE_MAX;
+	}
+	if (*pos == capacity)
+	{
+		return false;
 	}
-	return myStringCustomEqual(str1, str2, defaultComparator);
+	dst[(*pos)++] = (unsigned char)length;
+	return true;
 }
 
 /**
- * @brief Check if str1 is equal to str2.
- * COMPLEXITY: O(N) where N is the length of the shorter of str1 and str2, because of the
- * complexity of myStringCustomCompare().
- * @param str1
- * @param str2
- * @param comparator
- *
- * RETURN VALUE:
- * @return an integral value indicating the equality of the strings using a custom comparator
- * (3rd parameter):
- * 	A zero value indicates that the strings are not equal.
- * 	A greater than zero value indicates that the strings are equal.
- * 	If string cannot be compared, the return value should be MYSTR_ERROR_CODE
+ * @brief Writes a sequence of the compressed format: a token with the number of literals in its
+ * 		  high nibble and the length of the match minus 4 in its low nibble, the rest of the
+ * 		  number of literals, the literals, the offset of the match back from the end of the
+ * 		  literals in 2 bytes and the rest of the length of the match. The last sequence has only
+ * 		  literals.
+ * @param dst
+ * @param capacity the size of dst
+ * @param pos the place to write at, advanced past the sequence
+ * @param literals
+ * @param numOfLiterals
+ * @param offset
+ * @param matchLength the length of the match, or 0 for the last sequence
+ * @return true on success, false if dst is full.
  */
-int myStringCustomEqual(const MyString* str1, const MyString* str2,
-						int (*comparator)(const char, const char))
+static bool lzWriteSequence(unsigned char* dst, size_t capacity, size_t* pos,
+							const unsigned char* literals, size_t numOfLiterals, size_t offset,
+							size_t matchLength)
 {
-	if (str1 == NULL || str2 == NULL || comparator == NULL)
+	size_t matchRest = matchLength == 0 ? 0 : matchLength - LZ_MIN_MATCH;
+	unsigned char token = (unsigned char)(
+		(numOfLiterals < LZ_NIBBLE_MAX ? numOfLiterals : LZ_NIBBLE_MAX) << 4 |
+		(matchRest < LZ_NIBBLE_MAX ? matchRest : LZ_NIBBLE_MAX));
+
+	if (*pos == capacity)
 	{
-		return MYSTR_ERROR_CODE;
+		return false;
 	}
-	int compare = myStringCustomCompare(str1, str2, comparator);
-
-	if (compare == MYSTR_ERROR_CODE)
+	dst[(*pos)++] = token;
+	if (numOfLiterals >= LZ_NIBBLE_MAX &&
+		!lzWriteLength(dst, capacity, pos, numOfLiterals - LZ_NIBBLE_MAX))
 	{
-		return MYSTR_ERROR_CODE;
+		return false;
 	}
-	else if (compare != 0)
+	if (numOfLiterals > capacity - *pos)
 	{
-		return 0;
+		return false;
 	}
-	else
+	memcpy(dst + *pos, literals, numOfLiterals);
+	*pos += numOfLiterals;
+
+	if (matchLength == 0)
 	{
-		return 1;
+		return true;
+	}
+	if (capacity - *pos < 2)
+	{
+		return false;
 	}
+	dst[(*pos)++] = (unsigned char)(offset & 0xFF);
+	dst[(*pos)++] = (unsigned char)(offset >> BITS_IN_BYTE);
+	return matchRest < LZ_NIBBLE_MAX ||
+		   lzWriteLength(dst, capacity, pos, matchRest - LZ_NIBBLE_MAX);
 }
 
 /**
- * COMPLEXITY: O(1) because there is a constant number of operations in O(1)
- * @return the amount of memory (all the memory that used by the MyString object itself and
- * its allocations), in bytes, allocated to str1.
+ * @brief Compresses n bytes with a fast LZ77 codec in the style of LZ4: repeated runs of at
+ * 		  least 4 bytes, found by a hash table of the last place of every 4 bytes, are replaced
+ * 		  by their offset and length.
+ * @param src
+ * @param n
+ * @param dst
+ * @param capacity the size of dst
+ * @return the number of bytes written to dst, or 0 if they don't fit in it.
  */
-unsigned long myStringMemUsage(const MyString *str1)
+static size_t lzCompress(const unsigned char* src, size_t n, unsigned char* dst, size_t capacity)
 {
-	if (str1 == NULL)
+	size_t table[LZ_HASH_SIZE];
+	size_t anchor = 0, i = 0, pos = 0;
+
+	for (i = 0; i < LZ_HASH_SIZE; i++)
 	{
-		return 0;
+		table[i] = SIZE_MAX;
 	}
-	unsigned long memory = sizeof(str1);
-	memory += str1->_length * sizeof(char);
-
-	return memory;
-}
+
+	i = 0;
+	while (n - i >= LZ_MIN_MATCH)
+	{
+		uint32_t next;
+		memcpy(&next, src + i, sizeof(next));
+		size_t hash = (uint32_t)(next * LZ_HASH_MULTIPLIER) >> (32 - LZ_HASH_BITS);
+		size_t candidate = table[hash];
+		table[hash] = i;
+
+		if (candidate == SIZE_MAX || i - candidate > LZ_MAX_OFFSET ||
+			memcmp(src + candidate, src + i, LZ_MIN_MATCH) != 0)
+		{
+			i++;
+			continue;
+		}
+
+		size_t matchLength = LZ_MIN_MATCH;
+		while (i + matchLength < n && src[candidate + matchLength] == src[i + matchLength])
+		{
+			matchLength++;
+		}
+		if (!lzWriteSequence(dst, capacity, &pos, src + anchor, i - anchor, i - candidate,
+							 matchLength))
+		{
+			return 0;
+		}
+		i += matchLength;
+		anchor = i;
+	}
+
+	return lzWriteSequence(dst, capacity, &pos, src + anchor, n - anchor, 0, 0) ? pos : 0;
+}
 
 /**
- * COMPLEXITY: O(1) because there is a constant number of operations in O(1)
- * @return the length of the string in str1.
+ * @brief Reads a length of the compressed format, written by lzWriteLength.
+ * @param src
+ * @param size the size of src
+ * @param pos the place to read at, advanced past the bytes read
+ * @param length the length to add to
+ * @return true on success, false if src ended or the length overflows.
  */
-unsigned long myStringLen(const MyString *str1)
+static bool lzReadLength(const unsigned char* src, size_t size, size_t* pos, size_t* length)
 {
-	if (str1 == NULL)
+	unsigned char byte;
+	do
 	{
-		return 0;
-	}
-	return str1->_length;
+		if (*pos == size || *length > SIZE_MAX - LZ_LENGTH_BYTE_MAX)
+		{
+			return false;
+		}
+		byte = src[(*pos)++];
+		*length += byte;
+	} while (byte == LZ_LENGTH_BYTE_MAX);
+	return true;
 }
 
 /**
- * Writes the content of str to stream. (like fputs())
- * COMPLEXITY: O(1) because there is a constant number of operations in O(1)
- *
- * RETURNS:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ * @brief Decompresses bytes compressed by lzCompress.
+ * @param src
+ * @param size the size of src
+ * @param dst
+ * @param n the number of bytes that were compressed
+ * @return true on success, false if src isn't n bytes compressed by lzCompress.
  */
-MyStringRetVal myStringWrite(const MyString *str, FILE *stream)
+static bool lzDecompress(const unsigned char* src, size_t size, unsigned char* dst, size_t n)
 {
-	if (str == NULL || stream == NULL)
+	size_t pos = 0, out = 0;
+
+	while (pos < size)
 	{
-		return MYSTRING_ERROR;
+		unsigned char token = src[pos++];
+		size_t numOfLiterals = token >> 4;
+		if (numOfLiterals == LZ_NIBBLE_MAX && !lzReadLength(src, size, &pos, &numOfLiterals))
+		{
+			return false;
+		}
+		if (numOfLiterals > size - pos || numOfLiterals > n - out)
+		{
+			return false;
+		}
+		memcpy(dst + out, src + pos, numOfLiterals);
+		pos += numOfLiterals;
+		out += numOfLiterals;
+
+		if (pos == size)
+		{
+			break;
+		}
+		if (size - pos < 2)
+		{
+			return false;
+		}
+		size_t offset = (size_t)src[pos] | (size_t)src[pos + 1] << BITS_IN_BYTE;
+		size_t matchLength = token & LZ_NIBBLE_MAX;
+		pos += 2;
+		if (matchLength == LZ_NIBBLE_MAX && !lzReadLength(src, size, &pos, &matchLength))
+		{
+			return false;
+		}
+		matchLength += LZ_MIN_MATCH;
+		if (offset == 0 || offset > out || matchLength > n - out)
+		{
+			return false;
+		}
+
+		// A match may overlap the bytes it writes, repeating a short run
+		if (offset >= matchLength)
+		{
+			memcpy(dst + out, dst + out - offset, matchLength);
+			out += matchLength;
+		}
+		else
+		{
+			size_t end = out + matchLength;
+			for (; out < end; out++)
+			{
+				dst[out] = dst[out - offset];
+			}
+		}
 	}
 
-	char* output = myStringToCString(str);
-	int writeCheck = fputs(output, stream);
-	free(output);
+	return out == n;
+}
 
-	if (writeCheck >= 0)
+/**
+ * @brief Decompresses the string of str if myStringCompress compressed it, so it can be read.
+ * 		  Every function reading the string of a MyString calls it first: str is changed even
+ * 		  if it is const, but its value isn't.
+ * @param str may be NULL
+ * @return true on success, false if the allocation failed (and str is still compressed).
+ */
+static bool expandString(const MyString* str)
+{
+	if (str == NULL || !str->_compressed)
 	{
-		return MYSTRING_SUCCESS;
+		return true;
 	}
 
-	return MYSTRING_ERROR;
+	MyString* mutableStr = (MyString*)str;
+	size_t capacity = stringCapacity(str->_length);
+	char* string = (char*)allocBytes(capacity * sizeof(char));
+	if (string == NULL)
+	{
+		return false;
+	}
+	if (!lzDecompress((const unsigned char*)str->_string, str->_capacity, (unsigned char*)string,
+					  str->_length))
+	{
+		// The string was compressed by lzCompress, so this can't happen
+		freeBytes(string, capacity * sizeof(char));
+		return false;
+	}
+	uint64_t utf8 = str->_utf8;
+	replaceString(mutableStr, string, capacity, str->_length);
+	mutableStr->_utf8 = utf8;
+	return true;
 }
 
 /**
- * @brief sort an array of MyString pointers
- * COMPLEXITY: O(N^2) because of the complexity of qsort on worst case.
+ * @brief Check that arr and all its MyStrings are not NULL.
  * @param arr
  * @param len
- * @param comparator custom comparator
- *
- * RETURN VALUE:none
-  */
-void myStringCustomSort(MyString** arr, size_t len, int (*comparator)(const void*, const void*))
+ * @return true if they are valid, false otherwise.
+ */
+static bool validArray(MyString** arr, size_t len)
 {
-	if (arr == NULL || !(len > 0) || comparator == NULL)
+	if (arr == NULL)
 	{
-		return ;
+		return false;
 	}
-	qsort(arr, len, sizeof(MyString*), comparator);
+
+	size_t i;
+	for (i = 0; i < len; i++)
+	{
+		if (arr[i] == NULL)
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 /**
- * @brief sorts an array of MyString pointers according to the default comparison (like in myStringCompare)
- * COMPLEXITY: O(N^2) because of the complexity of qsort on worst case inside myStringCustomSort.
+ * @brief Decompresses the strings of an array of MyString pointers, like expandString.
  * @param arr
  * @param len
- *
- * RETURN VALUE: none
-  */
-void myStringSort(MyString** arr, size_t len)
+ * @return true on success, false if an allocation failed.
+ */
+static bool expandArray(MyString** arr, size_t len)
 {
-	if (arr == NULL || !(len > 0))
+	size_t i;
+	for (i = 0; i < len; i++)
 	{
-		return ;
+		if (!expandString(arr[i]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Finds the number of ASCII chars at the start of chars, checking 8 of them at a time
+ * 		  (without reading past the end).
+ * @param chars
+ * @param length
+ * @return the number of chars before the first char that isn't ASCII, or length if there is none.
+ */
+static size_t asciiPrefix(const unsigned char* chars, size_t length)
+{
+	uint64_t word;
+	size_t i = 0;
+
+	while (length - i >= sizeof(word))
+	{
+		memcpy(&word, chars + i, sizeof(word));
+		if ((word & ASCII_HIGH_BITS) != 0)
+		{
+			break;
+		}
+		i += sizeof(word);
+	}
+	while (i < length && chars[i] < ASCII_LIMIT)
+	{
+		i++;
+	}
+	return i;
+}
+
+/**
+ * @brief Decodes the UTF-8 sequence starting at chars[i]. The range allowed for the second char
+ * 		  depends on the first, which rules out overlong encodings, surrogates and code points
+ * 		  above U+10FFFF without decoding them first.
+ * @param chars
+ * @param length
+ * @param i should be less than length
+ * @param codepoint set to the decoded code point
+ * @return the number of chars of the sequence, or 0 if it isn't valid UTF-8.
+ */
+static size_t decodeUtf8(const unsigned char* chars, size_t length, size_t i, int* codepoint)
+{
+	unsigned char lead = chars[i];
+	if (lead < ASCII_LIMIT)
+	{
+		*codepoint = lead;
+		return 1;
+	}
+
+	size_t n = lead > UTF8_MAX_LEAD ? 0 : lead >= UTF8_LEAD_4 ? 4 : lead >= UTF8_LEAD_3 ? 3 :
+			   lead >= UTF8_MIN_LEAD ? 2 : 0;
+	if (n == 0 || length - i < n)
+	{
+		return 0;
+	}
+
+	unsigned char min = lead == UTF8_LEAD_3 ? 0xA0 : lead == UTF8_LEAD_4 ? 0x90 :
+						UTF8_MIN_CONTINUATION;
+	unsigned char max = lead == UTF8_SURROGATE_LEAD ? 0x9F : lead == UTF8_MAX_LEAD ? 0x8F :
+						UTF8_MAX_CONTINUATION;
+	if (chars[i + 1] < min || chars[i + 1] > max)
+	{
+		return 0;
 	}
 
-	myStringCustomSort(arr, len, myStringComparatorCasting);
+	int value = lead & (0x7F >> n);
+	size_t k;
+	for (k = 1; k < n; k++)
+	{
+		if ((chars[i + k] & UTF8_CONTINUATION_MASK) != UTF8_CONTINUATION)
+		{
+			return 0;
+		}
+		value = value << UTF8_PAYLOAD_BITS | (chars[i + k] & UTF8_PAYLOAD_MASK);
+	}
+	*codepoint = value;
+	return n;
 }
 
-// ------------------------------ test ---------------------------------
+/**
+ * @brief Flips the case of the ASCII letters from first to last in word, for all of its 8 chars
+ * 		  at once: every char is checked to be ASCII and in range by adding to its low 7 bits, so
+ * 		  no carry reaches the next char.
+ * @param word
+ * @param first 'A' or 'a'
+ * @param last 'Z' or 'z'
+ * @return the word with the case of the letters flipped
+ */
+static uint64_t flipCaseWord(uint64_t word, unsigned char first, unsigned char last)
+{
+	uint64_t low = word & ~ASCII_HIGH_BITS;
+	uint64_t aboveFirst = low + BYTES_OF_ONES * (ASCII_LIMIT - first);
+	uint64_t aboveLast = low + BYTES_OF_ONES * (ASCII_LIMIT - 1 - last);
+	uint64_t inRange = (aboveFirst ^ aboveLast) & ~word & ASCII_HIGH_BITS;
+	return word ^ inRange >> 2;
+}
 
-#ifndef NDEBUG
+/**
+ * @brief Flips the case of the ASCII letters from first to last in str, 8 chars at a time.
+ * @param str a mutable MyString whose string is not compressed
+ * @param first 'A' or 'a'
+ * @param last 'Z' or 'z'
+ */
+static void flipCase(MyString* str, unsigned char first, unsigned char last)
+{
+	uint64_t word;
+	size_t i = 0;
+
+	for (; str->_length - i >= sizeof(word); i += sizeof(word))
+	{
+		memcpy(&word, str->_string + i, sizeof(word));
+		word = flipCaseWord(word, first, last);
+		memcpy(str->_string + i, &word, sizeof(word));
+	}
+	for (; i < str->_length; i++)
+	{
+		unsigned char ch = (unsigned char)str->_string[i];
+		if (ch >= first && ch <= last)
+		{
+			str->_string[i] = (char)(ch ^ ASCII_CASE_BIT);
+		}
+	}
+}
+
+/**
+ * @brief Check if ch is removed by myStringTrim.
+ * @param ch
+ * @return true if ch is whitespace, false otherwise.
+ */
+static bool isWhitespace(char ch)
+{
+	return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r';
+}
+
+/**
+ * @brief Finds the first occurrence of pattern in chars, from start on. The first char of
+ * 		  pattern is looked for by memchr, and only its occurrences are compared.
+ * @param chars
+ * @param length
+ * @param start
+ * @param pattern
+ * @param patternLength more than 0
+ * @return the place of the occurrence, or length if there is none.
+ */
+static size_t findChars(const char* chars, size_t length, size_t start, const char* pattern,
+						size_t patternLength)
+{
+	while (length - start >= patternLength)
+	{
+		const char* first = (const char*)memchr(chars + start, pattern[0],
+												length - start - patternLength + 1);
+		if (first == NULL)
+		{
+			break;
+		}
+		start = (size_t)(first - chars);
+		if (memcmp(first + 1, pattern + 1, patternLength - 1) == 0)
+		{
+			return start;
+		}
+		start++;
+	}
+	return length;
+}
+
+/**
+ * @brief Replaces up to maxCount occurrences of from in str by to. The occurrences are counted
+ * 		  first, then the result is made in place if to is not longer than from (and none of them
+ * 		  is str), or in a new string of its final size.
+ * @param str a mutable MyString
+ * @param from
+ * @param to
+ * @param maxCount
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and str is not changed).
+ */
+static MyStringRetVal replaceChars(MyString* str, const MyString* from, const MyString* to,
+								   size_t maxCount)
+{
+	if (from->_length == 0 || !expandString(str) || !expandString(from) || !expandString(to))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t count = 0, i = 0;
+	while (count < maxCount &&
+		   (i = findChars(str->_string, str->_length, i, from->_string, from->_length)) <
+		   str->_length)
+	{
+		count++;
+		i += from->_length;
+	}
+	if (count == 0)
+	{
+		return MYSTRING_SUCCESS;
+	}
+
+	size_t length = str->_length - count * from->_length;
+	if (to->_length > 0 && count > (SIZE_MAX - 1 - length) / to->_length)
+	{
+		return MYSTRING_ERROR;
+	}
+	length += count * to->_length;
+
+	// Written in place only if the writing never passes the reading, and doesn't change from or to
+	bool inPlace = to->_length <= from->_length && from != str && to != str;
+	char* string = str->_string;
+	size_t capacity = str->_capacity;
+	if (!inPlace)
+	{
+		capacity = stringCapacity(length);
+		string = (char*)allocBytes(capacity * sizeof(char));
+		if (string == NULL)
+		{
+			return MYSTRING_ERROR;
+		}
+	}
+
+	size_t read = 0, written = 0, k;
+	for (k = 0; k < count; k++)
+	{
+		size_t found = findChars(str->_string, str->_length, read, from->_string, from->_length);
+		moveBytes(string + written, str->_string + read, found - read);
+		written += found - read;
+		copyBytes(string + written, to->_string, to->_length);
+		written += to->_length;
+		read = found + from->_length;
+	}
+	moveBytes(string + written, str->_string + read, str->_length - read);
+
+	if (inPlace)
+	{
+		str->_length = length;
+		str->_utf8 = UTF8_UNKNOWN;
+	}
+	else
+	{
+		replaceString(str, string, capacity, length);
+	}
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Check if ch is a decimal digit.
+ * @param ch
+ * @return true if ch is a digit, false otherwise.
+ */
+static bool isDigit(char ch)
+{
+	return ch >= ZERO_ASCII && ch <= NINE_ASCII;
+}
+
+/**
+ * @brief Skips the whitespace in chars from start on.
+ * @param chars
+ * @param length
+ * @param start
+ * @return the place of the first char that isn't whitespace, or length if there is none.
+ */
+static size_t skipWhitespace(const char* chars, size_t length, size_t start)
+{
+	while (start < length && isWhitespace(chars[start]))
+	{
+		start++;
+	}
+	return start;
+}
+
+#ifdef SWAR_PARSING
+/**
+ * @brief Check if the 8 chars of word are all digits: the high nibble of a digit is 3, and
+ * 		  adding 6 to it doesn't carry into the high nibble.
+ * @param word
+ * @return true if they are all digits, false otherwise.
+ */
+static bool isEightDigits(uint64_t word)
+{
+	return (word & HIGH_NIBBLES) == ASCII_ZEROS &&
+		   ((word + DIGITS_TO_NIBBLE_END) & HIGH_NIBBLES) == ASCII_ZEROS;
+}
+
+/**
+ * @brief Converts 8 digits to their number, with 3 multiplications instead of 8: pairs of
+ * 		  digits are combined first, then pairs of pairs and then the 2 halves.
+ * @param word 8 digits, the first in the lowest byte
+ * @return the number
+ */
+static uint64_t parseEightDigits(uint64_t word)
+{
+	word -= ASCII_ZEROS;
+	word = word * 10 + (word >> 8);
+	return (((word & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+			(((word >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+}
+#endif
+
+/**
+ * @brief Parses an integer in chars, at *i: a sign and then at least one digit.
+ * @param chars
+ * @param length
+ * @param i the place to parse at, advanced past the integer on success, or set to the place of
+ * 		  the error on failure
+ * @param value set to the integer
+ * @return true on success, false if there is no integer at *i or it's out of the range of int64_t.
+ */
+static bool parseInt64(const char* chars, size_t length, size_t* i, int64_t* value)
+{
+	size_t start = *i, pos = *i;
+	bool negative = false;
+
+	if (pos < length && (chars[pos] == PLUS_ASCII || chars[pos] == MINUS_ASCII))
+	{
+		negative = chars[pos] == MINUS_ASCII;
+		pos++;
+	}
+
+	// The magnitude is accumulated unsigned, so a number out of range is detected
+	uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+	uint64_t num = 0;
+	size_t digitsStart = pos;
+
+#ifdef SWAR_PARSING
+	uint64_t word;
+	while (length - pos >= sizeof(word))
+	{
+		memcpy(&word, chars + pos, sizeof(word));
+		if (!isEightDigits(word))
+		{
+			break;
+		}
+		uint64_t digits = parseEightDigits(word);
+		if (num > (limit - digits) / SWAR_DIGITS_POWER)
+		{
+			*i = start;
+			return false;
+		}
+		num = num * SWAR_DIGITS_POWER + digits;
+		pos += SWAR_DIGITS;
+	}
+#endif
+	while (pos < length && isDigit(chars[pos]))
+	{
+		uint64_t digit = (uint64_t)(chars[pos] - TO_INT_ASCII);
+		if (num > (limit - digit) / 10)
+		{
+			*i = start;
+			return false;
+		}
+		num = num * 10 + digit;
+		pos++;
+	}
+
+	if (pos == digitsStart)
+	{
+		*i = pos;
+		return false;
+	}
+	*value = !negative ? (int64_t)num : num > (uint64_t)INT64_MAX ? INT64_MIN : -(int64_t)num;
+	*i = pos;
+	return true;
+}
+
+/**
+ * @brief Finds the UTF-8 state of str, validating it and counting its code points only if it
+ * 		  wasn't changed since the last time. The string of str should not be compressed.
+ * @param str
+ * @return UTF8_INVALID, or UTF8_VALID plus the number of code points.
+ */
+static uint64_t getUtf8(const MyString* str)
+{
+	// Threads sharing a frozen str may validate it together, but they all store the same value
+	uint64_t utf8 = __atomic_load_n(&str->_utf8, __ATOMIC_RELAXED);
+	if (utf8 != UTF8_UNKNOWN)
+	{
+		return utf8;
+	}
+
+	const unsigned char* chars = (const unsigned char*)str->_string;
+	size_t i = 0, codepoints = 0;
+	int codepoint;
+
+	utf8 = UTF8_VALID;
+	while (i < str->_length)
+	{
+		size_t ascii = asciiPrefix(chars + i, str->_length - i);
+		i += ascii;
+		codepoints += ascii;
+		if (i == str->_length)
+		{
+			break;
+		}
+
+		size_t n = decodeUtf8(chars, str->_length, i, &codepoint);
+		if (n == 0)
+		{
+			utf8 = UTF8_INVALID;
+			break;
+		}
+		i += n;
+		codepoints++;
+	}
+	if (utf8 == UTF8_VALID)
+	{
+		utf8 += codepoints;
+	}
+
+	__atomic_store_n(&((MyString*)str)->_utf8, utf8, __ATOMIC_RELAXED);
+	return utf8;
+}
+
+/**
+ * @brief Writes the null character after the chars of str, first making room for it if its
+ * 		  string is full. The string of str should not be NULL.
+ * @param str
+ * @return true on success, false if the allocation failed (and str is not changed).
+ */
+static bool terminateString(MyString* str)
+{
+	if (str->_capacity <= str->_length)
+	{
+		size_t capacity = stringCapacity(str->_length);
+		char* string = (char*)reallocBytes(str->_string, str->_capacity, capacity * sizeof(char));
+		if (string == NULL)
+		{
+			return false;
+		}
+		str->_string = string;
+		str->_capacity = capacity;
+	}
+	str->_string[str->_length] = '\0';
+	return true;
+}
+
+/**
+ * @brief Check that str can be changed: it is not NULL and it is not frozen.
+ * @param str
+ * @return true if str can be changed, false otherwise.
+ */
+static bool isMutable(const MyString* str)
+{
+	return str != NULL && !str->_frozen;
+}
+
+/**
+ * @brief Find the number of digits of given number.
+ * @param num
+ * @return The number of digits, 1 for 0
+ */
+static int getNumOfDigits(unsigned int num)
+{
+	int numOfDigits = 1;
+	while (num >= 10)
+	{
+		numOfDigits++;
+		num /= 10;
+	}
+
+	return numOfDigits;
+}
+
+/**
+ * @brief Writes the decimal digits of n, with a minus sign if it is negative.
+ * @param dest where to write, with room for length chars
+ * @param n
+ * @param length the number of chars of n, as returned by getIntLength
+ */
+static void writeInt(char* dest, int n, size_t length)
+{
+	// The magnitude is computed unsigned, since -INT_MIN doesn't fit in an int
+	unsigned int magnitude = n < 0 ? 0U - (unsigned int)n : (unsigned int)n;
+	size_t i;
+
+	if (n < 0)
+	{
+		dest[0] = '-';
+	}
+	for (i = length; i > (size_t)(n < 0); i--)
+	{
+		dest[i - 1] = (char)(magnitude % 10) + TO_INT_ASCII;
+		magnitude /= 10;
+	}
+}
+
+/**
+ * @brief Find the number of chars of given number written in decimal.
+ * @param n
+ * @return the number of digits, plus 1 for the minus sign of a negative number
+ */
+static size_t getIntLength(int n)
+{
+	unsigned int magnitude = n < 0 ? 0U - (unsigned int)n : (unsigned int)n;
+	return (size_t)getNumOfDigits(magnitude) + (n < 0);
+}
+
+/**
+ * @brief Compare between 2 chars by their ASCII value
+ * @param ch1
+ * @param ch2
+ * @return 1 if ch1 is bigger then ch2, -1 if ch2 is bigger then ch1, 0 if they are equal.
+ */
+static int defaultComparator(const char ch1, const char ch2)
+{
+	if (ch1 > ch2)
+	{
+		return 1;
+	}
+	else if (ch1 < ch2)
+	{
+		return -1;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+/**
+ * @brief Compares str1 and str2 like myStringCustomCompare, without counting a call to it.
+ * @param str1
+ * @param str2
+ * @param comparator
+ * @return -1, 0 or 1, or MYSTR_ERROR_CODE if they can't be compared.
+ */
+static int compareStrings(const MyString* str1, const MyString* str2,
+						  int (*comparator)(const char, const char))
+{
+	if (str1 == NULL || str2 == NULL || str1->_string == NULL || str2->_string == NULL ||
+		comparator == NULL || !expandString(str1) || !expandString(str2))
+	{
+		return MYSTR_ERROR_CODE;
+	}
+
+	size_t i = 0;
+
+	while (i < str1->_length && i < str2->_length)
+	{
+		int compare = comparator(str1->_string[i], str2->_string[i]);
+		if (compare > 0)
+		{
+			return 1;
+		}
+		else if (compare < 0)
+		{
+			return -1;
+		}
+		i++;
+	}
+
+	if (str1->_length == str2->_length)
+	{
+		return 0;
+	}
+	else if (str1->_length == i)
+	{
+		return -1;
+	}
+	else
+	{
+		return 1;
+	}
+}
+
+/**
+ * @brief Check if str1 is equal to str2 like myStringCustomEqual, without counting a call to it.
+ * @param str1
+ * @param str2
+ * @param comparator
+ * @return 1 if they are equal, 0 if not, or MYSTR_ERROR_CODE if they can't be compared.
+ */
+static int equalStrings(const MyString* str1, const MyString* str2,
+						int (*comparator)(const char, const char))
+{
+	if (str1 == NULL || str2 == NULL || comparator == NULL)
+	{
+		return MYSTR_ERROR_CODE;
+	}
+	int compare = compareStrings(str1, str2, comparator);
+
+	if (compare == MYSTR_ERROR_CODE)
+	{
+		return MYSTR_ERROR_CODE;
+	}
+	else if (compare != 0)
+	{
+		return 0;
+	}
+	else
+	{
+		return 1;
+	}
+}
+
+/**
+ * @brief Used to cast 2 void* pointers into 2 MyString** pointers and  call to myStringCompare
+ * 		  with the new pointers.
+ * 		  str1 and str2 should be allocated.
+ * @param str1
+ * @param str2
+ * @return result of myStringCompare
+ */
+static int myStringComparatorCasting(const void* str1, const void* str2)
+{
+	MyString* myStr1 = *(MyString**)str1;
+	MyString* myStr2 = *(MyString**)str2;
+	return compareStrings(myStr1, myStr2, defaultComparator);
+}
+
+/**
+ * @brief Packs the first PREFIX_LENGTH chars of chars into an integer, so comparing the integers
+ * 		  of 2 strings gives the same order as comparing their first chars with defaultComparator.
+ * 		  Missing chars of short strings are packed as the smallest char.
+ * @param chars
+ * @param length
+ * @return the prefix
+ */
+static uint64_t getCharsPrefix(const char* chars, size_t length)
+{
+	uint64_t prefix = 0;
+	size_t i;
+
+	for (i = 0; i < PREFIX_LENGTH; i++)
+	{
+		prefix <<= BITS_IN_BYTE;
+		if (i < length)
+		{
+			prefix |= (uint64_t)((unsigned char)chars[i] ^ SIGN_FLIP);
+		}
+	}
+
+	return prefix;
+}
+
+/**
+ * @brief Packs the first PREFIX_LENGTH chars of str into an integer, like getCharsPrefix.
+ * @param str
+ * @return the prefix
+ */
+static uint64_t getPrefix(const MyString* str)
+{
+	return str->_string != NULL ? getCharsPrefix(str->_string, str->_length) : 0;
+}
+
+/**
+ * @brief Compares 2 SortKey by their prefixes, and by their keys if the prefixes are equal.
+ * @param key1
+ * @param key2
+ * @return result of the comparison like in myStringCompare
+ */
+static int sortKeyComparator(const void* key1, const void* key2)
+{
+	const SortKey* sortKey1 = (const SortKey*)key1;
+	const SortKey* sortKey2 = (const SortKey*)key2;
+
+	if (sortKey1->_prefix != sortKey2->_prefix)
+	{
+		return sortKey1->_prefix < sortKey2->_prefix ? -1 : 1;
+	}
+	return compareStrings(sortKey1->_key, sortKey2->_key, defaultComparator);
+}
+
+/**
+ * @brief Finds the end of the run of digits at *i, and skips its leading zeros (all but the last
+ * 		  digit if they are all zeros).
+ * @param chars
+ * @param length
+ * @param i the place of the first digit of the run, advanced past its leading zeros
+ * @return the place of the first char after the run
+ */
+static size_t skipDigitRun(const char* chars, size_t length, size_t* i)
+{
+	size_t end = *i;
+	while (end < length && isDigit(chars[end]))
+	{
+		end++;
+	}
+	while (*i < end - 1 && chars[*i] == ZERO_ASCII)
+	{
+		(*i)++;
+	}
+	return end;
+}
+
+/**
+ * @brief Makes the natural key of chars for myStringNaturalSort: every run of digits is replaced
+ * 		  by NUMBER_MARK, the number of its digits without the leading zeros and these digits, so
+ * 		  the keys are ordered like defaultComparator orders them: a run is ordered among the
+ * 		  other chars like a digit, and a longer number is bigger. A number of MAX_LENGTH_BYTE
+ * 		  digits or more has its length in several bytes, all but the last MAX_LENGTH_BYTE, so
+ * 		  the length stays positive as a signed char.
+ * @param chars
+ * @param length
+ * @param key set to the key if it isn't NULL
+ * @return the length of the key
+ */
+static size_t makeNaturalKey(const char* chars, size_t length, char* key)
+{
+	size_t keyLength = 0, i = 0;
+
+	while (i < length)
+	{
+		if (!isDigit(chars[i]))
+		{
+			if (key != NULL)
+			{
+				key[keyLength] = chars[i];
+			}
+			keyLength++;
+			i++;
+			continue;
+		}
+
+		size_t end = skipDigitRun(chars, length, &i), digits = end - i;
+		if (key != NULL)
+		{
+			char* out = key + keyLength;
+			*out++ = NUMBER_MARK;
+			for (; digits >= MAX_LENGTH_BYTE; digits -= MAX_LENGTH_BYTE)
+			{
+				*out++ = MAX_LENGTH_BYTE;
+			}
+			*out++ = (char)digits;
+			copyBytes(out, chars + i, end - i);
+		}
+		keyLength += 2 + (end - i) / MAX_LENGTH_BYTE + (end - i);
+		i = end;
+	}
+
+	return keyLength;
+}
+
+/**
+ * @brief Compares 2 NaturalKey by their prefixes, and by their keys like defaultComparator if the
+ * 		  prefixes are equal.
+ * @param key1
+ * @param key2
+ * @return result of the comparison like in myStringCompare
+ */
+static int naturalKeyComparator(const void* key1, const void* key2)
+{
+	const NaturalKey* naturalKey1 = (const NaturalKey*)key1;
+	const NaturalKey* naturalKey2 = (const NaturalKey*)key2;
+
+	if (naturalKey1->_prefix != naturalKey2->_prefix)
+	{
+		return naturalKey1->_prefix < naturalKey2->_prefix ? -1 : 1;
+	}
+
+	size_t length = naturalKey1->_length < naturalKey2->_length ? naturalKey1->_length :
+					naturalKey2->_length;
+	size_t i;
+	for (i = 0; i < length; i++)
+	{
+		int compare = defaultComparator(naturalKey1->_key[i], naturalKey2->_key[i]);
+		if (compare != 0)
+		{
+			return compare < 0 ? -1 : 1;
+		}
+	}
+	return naturalKey1->_length == naturalKey2->_length ? 0 :
+		   naturalKey1->_length < naturalKey2->_length ? -1 : 1;
+}
+
+/**
+ * @brief Allocates a new MyString like myStringAlloc, without counting a call to it.
+ * @return a pointer to the new string, or NULL if the allocation failed.
+ */
+static MyString* newMyString()
+{
+	MyString* myString = (MyString*)allocBytes(sizeof(MyString));
+	if (myString == NULL)
+	{
+		return NULL;
+	}
+
+	myString->_string = NULL;
+	myString->_length = 0;
+	myString->_capacity = 0;
+	myString->_frozen = false;
+	myString->_refCount = 1;
+	myString->_hash = 0;
+	myString->_borrowed = false;
+	myString->_compressed = false;
+	myString->_utf8 = UTF8_UNKNOWN;
+	updateGauge(LIVE_OBJECTS, 1);
+
+	return myString;
+}
+
+/**
+ * @brief Allocates a new MyString and sets its value to "" (the empty string).
+ * 			It is the caller's responsibility to free the returned MyString.
+ *
+ * 	COMPLEXITY: O(1) because there is a constant number of commands: creating pointer to MyString,
+ * 				allocating it using malloc (assume malloc is O(1)), comparison, setting
+ * 				values to the MyString allocated and return.
+ *
+ * RETURN VALUE:
+ * @return a pointer to the new string, or NULL if the allocation failed.
+ */
+MyString * myStringAlloc()
+{
+	COUNT_CALL(myStringAlloc);
+	return newMyString();
+}
+
+/**
+ * @brief Releases a reference to str like myStringFree, without counting a call to it.
+ * @param str
+ */
+static void releaseMyString(MyString* str)
+{
+	if (str != NULL && str->_borrowed)
+	{
+		return;
+	}
+	if (str != NULL && str->_frozen &&
+		__atomic_sub_fetch(&str->_refCount, 1, __ATOMIC_ACQ_REL) != 0)
+	{
+		return;
+	}
+
+	if(str != NULL)
+	{
+		freeString(str);
+		freeBytes(str, sizeof(MyString));
+		updateGauge(LIVE_OBJECTS, -1);
+	}
+}
+
+/**
+ * @brief Frees the memory and resources allocated to str.
+ * 	If str is frozen, releases one reference to it, and frees it only when no references are left.
+ * COMPLEXITY: O(1) because there is a constant number of commands: comparrison and freeing memory
+ * 			   using free (assume free is O(1))
+ * @param str the MyString to free.
+ * If str is NULL, no operation is performed.
+ */
+void myStringFree(MyString *str)
+{
+	COUNT_CALL(myStringFree);
+	releaseMyString(str);
+}
+
+/**
+ * @brief Allocates a new MyString with the same value as str. It is the caller's
+ * 			responsibility to free the returned MyString.
+ * @param str the MyString to clone.
+ * COMPLEXITY: O(N) because myStringSetFromMyString is O(N).
+ * RETURN VALUE:
+ *   @return a pointer to the new string, or NULL if the allocation failed.
+ */
+MyString * myStringClone(const MyString *str)
+{
+	COUNT_CALL(myStringClone);
+	if (str == NULL)
+	{
+		return NULL;
+	}
+
+	MyString* clone = newMyString();
+
+	if (clone == NULL)
+	{
+		return NULL;
+	}
+
+	if (!expandString(str) || setChars(clone, str->_string, str->_length) == MYSTRING_ERROR)
+	{
+		releaseMyString(clone);
+		return NULL;
+	}
+
+	return clone;
+}
+
+/**
+ * @brief Sets the value of str to the value of other.
+ * COMPLEXITY: O(N) where N is the length of str, or the number of bytes of str->string takes,
+ * 			   because of memcpy complexity.
+ * @param str the MyString to set
+ * @param other the MyString to set from
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+*/
+MyStringRetVal myStringSetFromMyString(MyString *str, const MyString *other)
+{
+	COUNT_CALL(myStringSetFromMyString);
+	if (!isMutable(str) || other == NULL || !expandString(other))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	return setChars(str, other->_string, other->_length);
+}
+
+/**
+ * @brief filter the value of str acording to a filter.
+ * 	remove from str all the occurrence of chars that are filtered by filt
+ *	(i.e. filr(char)==true)
+ *	COMPLEXITY: O(N) where N is the length of str, because the loop runs on every char in str.
+ *				If the given filt is bigger then O(N), then the complexity is that of filt.
+ * @param str the MyString to filter
+ * @param filt the filter
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure. */
+MyStringRetVal myStringFilter(MyString *str, bool (*filt)(const char *))
+{
+	COUNT_CALL(myStringFilter);
+	if (!isMutable(str) || str->_string == NULL || filt == NULL || !expandString(str))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	// The kept chars are moved in place, since they never pass the chars still to be filtered
+	size_t i, j = 0;
+
+	for (i = 0; i < str->_length; i++)
+	{
+		if (filt(&str->_string[i]) == false)
+		{
+			str->_string[j] = str->_string[i];
+			j++;
+		}
+	}
+	str->_length = j;
+	str->_utf8 = UTF8_UNKNOWN;
+
+	// Most of the string was filtered out, so its memory is returned (if the allocator can)
+	if (j > 0 && j <= str->_capacity / 2)
+	{
+		size_t capacity = stringCapacity(j);
+		char* string = (char*)reallocBytes(str->_string, str->_capacity, capacity * sizeof(char));
+		if (string != NULL)
+		{
+			str->_string = string;
+			str->_capacity = capacity;
+		}
+	}
+
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Converts the ASCII letters of str to lower case, in place. The chars are converted 8 at
+ * 	a time in a 64 bit word, and the string is never reallocated. ASCII letters stay ASCII, so
+ * 	the result of myStringValidateUtf8 is kept.
+ * COMPLEXITY: O(N) where N is the length of str.
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringToLower(MyString *str)
+{
+	COUNT_CALL(myStringToLower);
+	if (!isMutable(str) || !expandString(str))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	flipCase(str, 'A', 'Z');
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Converts the ASCII letters of str to upper case, in place, like myStringToLower.
+ * COMPLEXITY: O(N) where N is the length of str.
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringToUpper(MyString *str)
+{
+	COUNT_CALL(myStringToUpper);
+	if (!isMutable(str) || !expandString(str))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	flipCase(str, 'a', 'z');
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Replaces every char ch of str by table[(uint8_t)ch], in place, without reallocating.
+ * COMPLEXITY: O(N) where N is the length of str.
+ * @param str
+ * @param table
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringTranslate(MyString *str, const uint8_t table[NUM_OF_CHARS])
+{
+	COUNT_CALL(myStringTranslate);
+	if (!isMutable(str) || table == NULL || !expandString(str))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	unsigned char* chars = (unsigned char*)str->_string;
+	size_t i;
+
+	for (i = 0; i < str->_length; i++)
+	{
+		chars[i] = table[chars[i]];
+	}
+	str->_utf8 = UTF8_UNKNOWN;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Removes the whitespace from the start and the end of str, in place.
+ * COMPLEXITY: O(N) where N is the length of str, because the kept chars are moved to the start.
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringTrim(MyString *str)
+{
+	COUNT_CALL(myStringTrim);
+	if (!isMutable(str) || !expandString(str))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t start = 0, end = str->_length;
+	while (start < end && isWhitespace(str->_string[start]))
+	{
+		start++;
+	}
+	while (end > start && isWhitespace(str->_string[end - 1]))
+	{
+		end--;
+	}
+	if (start > 0)
+	{
+		moveBytes(str->_string, str->_string + start, end - start);
+	}
+	if (end - start < str->_length)
+	{
+		str->_length = end - start;
+		str->_utf8 = UTF8_UNKNOWN;
+	}
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Replaces the first occurrence of from in str by to.
+ * COMPLEXITY: O(N + M) where N is the length of str and M is the length of to.
+ * @param str
+ * @param from
+ * @param to
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and str is not changed).
+ */
+MyStringRetVal myStringReplace(MyString *str, const MyString *from, const MyString *to)
+{
+	COUNT_CALL(myStringReplace);
+	if (!isMutable(str) || from == NULL || to == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+	return replaceChars(str, from, to, 1);
+}
+
+/**
+ * @brief Replaces every occurrence of from in str by to, with at most one allocation.
+ * COMPLEXITY: O(N + K * M) where N is the length of str, K is the number of occurrences and M is
+ * 			   the length of to. Searching is O(N * L) in the worst case, where L is the length
+ * 			   of from, but memchr skips to the places starting like from.
+ * @param str
+ * @param from
+ * @param to
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and str is not changed).
+ */
+MyStringRetVal myStringReplaceAll(MyString *str, const MyString *from, const MyString *to)
+{
+	COUNT_CALL(myStringReplaceAll);
+	if (!isMutable(str) || from == NULL || to == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+	return replaceChars(str, from, to, SIZE_MAX);
+}
+
+/**
+ * @brief Sets the value of str to the value of the given C string.
+ * 			The given C string must be terminated by the null character.
+ * 			Checking will not use a string without the null character.
+ * 	COMPLEXICTY: O(N) where N is the length of cString because strlen() is O(N) and also
+ * 				 memcpy() is O(N).
+ * @param str the MyString to set.
+ * @param cString the C string to set from.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringSetFromCString(MyString *str, const char * cString)
+{
+	COUNT_CALL(myStringSetFromCString);
+	if (!isMutable(str) || cString == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	return setChars(str, cString, strlen(cString));
+}
+
+/**
+ * @brief Sets the value of str to the first len chars of buf, which may include null characters.
+ * 	The string of str is reused if the chars fill at least half of it.
+ * COMPLEXITY: O(N) where N is len, because of memmove.
+ * @param str the MyString to set.
+ * @param buf the chars to set from, may be NULL if len is 0.
+ * @param len
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and str is not changed).
+ */
+MyStringRetVal myStringSetFromBuffer(MyString *str, const char *buf, size_t len)
+{
+	COUNT_CALL(myStringSetFromBuffer);
+	if (!isMutable(str) || (buf == NULL && len > 0))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	return setChars(str, buf, len);
+}
+
+/**
+ * @brief Sets the value of str to the value of the integer n.
+ *	(i.e. if n=7 than str should contain ‘7’)
+ * 	You are not allowed to use itoa (or a similar functions) here but must code your own conversion
+ * 	function.
+ * COMPLEXICTY: O(N) where N is the number of digits on the given int n, because getNumberOfDigits
+ * runs in O(N) and also the loop in this function runs for N times.
+ * @param str the MyString to set.
+ * @param n the int to set from.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringSetFromInt(MyString *str, int n)
+{
+	COUNT_CALL(myStringSetFromInt);
+	if (!isMutable(str))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	char digits[MAX_INT_LENGTH];
+	size_t length = getIntLength(n);
+
+	writeInt(digits, n, length);
+	return setChars(str, digits, length);
+}
+
+/**
+ * @brief Returns the value of str as an integer.
+ * 	If str cannot be parsed as an integer,
+ * 	the return value should be MYSTR_ERROR_CODE
+ * 	NOTE: positive and negative integers should be supported.
+ * 	An empty string, a sign without digits and a number out of the range of int can't be
+ * 	parsed.
+ * 	COMPLEXITY: O(N) where N is the length of str, because the loop runs for N times.
+ * @param str the MyString
+ * @return an integer
+ */
+int myStringToInt(const MyString *str)
+{
+	COUNT_CALL(myStringToInt);
+	if (str == NULL || !expandString(str))
+	{
+		return MYSTR_ERROR_CODE;
+	}
+
+	size_t i = 0;
+	bool negative = false;
+
+	if (str->_length > 0 && (str->_string[0] == PLUS_ASCII || str->_string[0] == MINUS_ASCII))
+	{
+		negative = str->_string[0] == MINUS_ASCII;
+		i++;
+	}
+	if (i == str->_length)
+	{
+		return MYSTR_ERROR_CODE;
+	}
+
+	// The magnitude is accumulated unsigned, so a number out of the range of int is detected
+	// instead of overflowing
+	unsigned int limit = negative ? 0U - (unsigned int)INT_MIN : (unsigned int)INT_MAX;
+	unsigned int num = 0;
+
+	for (; i < str->_length; i++)
+	{
+		if (str->_string[i] < ZERO_ASCII || str->_string[i] > NINE_ASCII)
+		{
+			return MYSTR_ERROR_CODE;
+		}
+
+		unsigned int digit = (unsigned int)(str->_string[i] - TO_INT_ASCII);
+		if (num > (limit - digit) / 10)
+		{
+			return MYSTR_ERROR_CODE;
+		}
+		num = num * 10 + digit;
+	}
+
+	return negative ? (int)(0U - num) : (int)num;
+}
+
+/**
+ * @brief Parses a list of integers separated by sep. The digits are converted 8 at a time in a
+ * 	64 bit word where the chars are little endian, and only the chars after every integer are
+ * 	checked for a separator.
+ * COMPLEXITY: O(N) where N is the length of str.
+ * @param str the MyString
+ * @param sep the separator
+ * @param out set to the integers
+ * @param cap the maximal number of integers in out
+ * @param count set to the number of integers set in out
+ * @param errorOffset may be NULL, set to the offset of the error on failure
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringParseInts(const MyString *str, char sep, int64_t *out, size_t cap,
+								 size_t *count, size_t *errorOffset)
+{
+	COUNT_CALL(myStringParseInts);
+	if (str == NULL || count == NULL || (out == NULL && cap > 0) || !expandString(str))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	const char* chars = str->_string;
+	size_t length = str->_length, n = 0;
+	size_t i = skipWhitespace(chars, length, 0), error = length;
+	bool whitespaceSep = isWhitespace(sep);
+	bool success = true;
+
+	while (i < length)
+	{
+		size_t start = i;
+		int64_t value;
+		bool parsed = parseInt64(chars, length, &i, &value);
+		if (!parsed || n == cap)
+		{
+			error = parsed ? start : i;
+			success = false;
+			break;
+		}
+		out[n++] = value;
+
+		size_t next = skipWhitespace(chars, length, i);
+		if (next == length)
+		{
+			break;
+		}
+		if (whitespaceSep ? next == i : chars[next] != sep)
+		{
+			error = next;
+			success = false;
+			break;
+		}
+
+		// After a separator there must be another integer
+		i = whitespaceSep ? next : skipWhitespace(chars, length, next + 1);
+		if (i == length)
+		{
+			error = length;
+			success = false;
+		}
+	}
+
+	*count = n;
+	if (!success && errorOffset != NULL)
+	{
+		*errorOffset = error;
+	}
+	return success ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+}
+
+/**
+ * @brief Returns the value of str as a C string, terminated with the
+ * 	null character. It is the caller's responsibility to free the returned
+ * 	string by calling free().
+ * 	COMPLEXCITY: O(N) where N is the length of str because of memcpy.
+ * @param str the MyString
+ * RETURN VALUE:
+ *  @return the new string, or NULL if the allocation failed.
+ */
+char * myStringToCString(const MyString *str)
+{
+	COUNT_CALL(myStringToCString);
+	if (str == NULL || !expandString(str))
+	{
+		return NULL;
+	}
+
+	// Allocated by malloc and not by the allocator, since the caller frees it by calling free().
+	// Not counted as an allocation either, since its free can't be counted
+	char* cString = (char*)malloc((str->_length + 1) * sizeof(char));
+	if (cString == NULL)
+	{
+		return NULL;
+	}
+	copyBytes(cString, str->_string, str->_length);
+	cString[str->_length] = '\0';
+	return cString;
+}
+
+/**
+ * @brief Returns the value of str as a C string borrowed from str: its own string, terminated
+ * 	with the null character in the char kept after it. Nothing is allocated or copied, unless
+ * 	the string of str has no room left for the null character.
+ * 	The pointer is valid until the next change to str. A frozen MyString is terminated when it is
+ * 	frozen, so it may be read by many threads at once.
+ * COMPLEXITY: O(1)
+ * @param str the MyString
+ * RETURN VALUE:
+ *  @return the C string, "" if str was never set, or NULL if str is NULL or the allocation
+ *  failed.
+ */
+const char * myStringCStr(MyString *str)
+{
+	COUNT_CALL(myStringCStr);
+	if (str == NULL || !expandString(str))
+	{
+		return NULL;
+	}
+	if (str->_string == NULL)
+	{
+		return "";
+	}
+	if (str->_frozen)
+	{
+		return str->_capacity > str->_length ? str->_string : NULL;
+	}
+	return terminateString(str) ? str->_string : NULL;
+}
+
+/**
+ * @brief Appends a copy of the source MyString src to the destination MyString dst.
+ * COMPLEXCITY: O(N) where N is the length of src, because of memcpy.
+ * @param dest the destination
+ * @param src the MyString to append
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringCat(MyString * dest, const MyString * src)
+{
+	COUNT_CALL(myStringCat);
+	if (!isMutable(dest) || src == NULL || !expandString(dest) || !expandString(src))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t length = dest->_length + src->_length;
+	size_t capacity = stringCapacity(length);
+	char* catString = (char*)allocBytes(capacity * sizeof(char));
+
+	if (catString == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	// src may be dest, so its string is freed only after it is copied
+	copyBytes(catString, dest->_string, dest->_length);
+	copyBytes(catString + dest->_length, src->_string, src->_length);
+	replaceString(dest, catString, capacity, length);
+
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Sets result to be the concatenation of str1 and str2.
+ * 	result should be initially allocated by the caller.
+ * 	result shouldn't be the same struct as str1 or str2.
+ * 	COMPLEXITY: O(N + M) where N is the length of str1 and M is the length of str2 because of
+ * 				the 2 memcpy calls.
+ * @param str1
+ * @param str2
+ * @param result
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringCatTo(const MyString *str1, const MyString *str2, MyString *result)
+{
+	COUNT_CALL(myStringCatTo);
+	if (str1 == NULL || str2 == NULL || !isMutable(result) || !expandString(str1) ||
+		!expandString(str2))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t length = str1->_length + str2->_length;
+	size_t capacity = stringCapacity(length);
+	char* string = (char*)allocBytes(capacity * sizeof(char));
+	if (string == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	copyBytes(string, str1->_string, str1->_length);
+	copyBytes(string + str1->_length, str2->_string, str2->_length);
+	replaceString(result, string, capacity, length);
+
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Sets result to be the concatenation of the n MyStrings of parts, in order.
+ * 	The string is allocated once, and every part is copied once. result may also be one (or
+ * 	more) of the parts, which are then concatenated with the old value of result.
+ * COMPLEXITY: O(N + n) where N is the length of the result, because every part is copied once.
+ * @param result
+ * @param parts
+ * @param n the number of parts
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and result is not changed).
+ */
+MyStringRetVal myStringCatMany(MyString *result, const MyString **parts, size_t n)
+{
+	COUNT_CALL(myStringCatMany);
+	if (!isMutable(result) || (parts == NULL && n > 0))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t length = 0, i;
+	for (i = 0; i < n; i++)
+	{
+		if (parts[i] == NULL || parts[i]->_length >= SIZE_MAX - length ||
+			!expandString(parts[i]))
+		{
+			return MYSTRING_ERROR;
+		}
+		length += parts[i]->_length;
+	}
+
+	size_t capacity = stringCapacity(length);
+	char* string = (char*)allocBytes(capacity * sizeof(char));
+	if (string == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	// result may be one of the parts, so its string is freed only after all of them are copied
+	char* end = string;
+	for (i = 0; i < n; i++)
+	{
+		copyBytes(end, parts[i]->_string, parts[i]->_length);
+		end += parts[i]->_length;
+	}
+	replaceString(result, string, capacity, length);
+
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Moves the value of src to dst without copying it: dst takes the string of src, and src
+ * 	is left like a new MyString. Moving a MyString to itself does nothing.
+ * COMPLEXITY: O(1)
+ * @param dst
+ * @param src
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (if one of them is NULL or
+ *  frozen).
+ */
+MyStringRetVal myStringMove(MyString *dst, MyString *src)
+{
+	COUNT_CALL(myStringMove);
+	if (!isMutable(dst) || !isMutable(src))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	if (dst != src)
+	{
+		replaceString(dst, src->_string, src->_capacity, src->_length);
+		dst->_compressed = src->_compressed;
+		dst->_utf8 = src->_utf8;
+		src->_string = NULL;
+		src->_capacity = 0;
+		src->_length = 0;
+		src->_compressed = false;
+		src->_utf8 = UTF8_UNKNOWN;
+	}
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Swaps the values of str1 and str2 without copying them.
+ * COMPLEXITY: O(1)
+ * @param str1
+ * @param str2
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (if one of them is NULL or
+ *  frozen).
+ */
+MyStringRetVal myStringSwap(MyString *str1, MyString *str2)
+{
+	COUNT_CALL(myStringSwap);
+	if (!isMutable(str1) || !isMutable(str2))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	char* string = str1->_string;
+	size_t capacity = str1->_capacity;
+	size_t length = str1->_length;
+	bool compressed = str1->_compressed;
+	uint64_t utf8 = str1->_utf8;
+
+	str1->_string = str2->_string;
+	str1->_capacity = str2->_capacity;
+	str1->_length = str2->_length;
+	str1->_compressed = str2->_compressed;
+	str1->_utf8 = str2->_utf8;
+	str2->_string = string;
+	str2->_capacity = capacity;
+	str2->_length = length;
+	str2->_compressed = compressed;
+	str2->_utf8 = utf8;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Allocates a buffer of capacity chars for myStringAdoptBuffer, with the allocator of the
+ * 	library. It is the caller's responsibility to give it to a MyString, or to free it with
+ * 	myStringBufferFree.
+ * COMPLEXITY: O(1)
+ * @param capacity
+ * RETURN VALUE:
+ *  @return a pointer to the buffer, or NULL if the allocation failed.
+ */
+char * myStringBufferAlloc(size_t capacity)
+{
+	COUNT_CALL(myStringBufferAlloc);
+	return (char*)allocBytes(capacity * sizeof(char));
+}
+
+/**
+ * @brief Frees a buffer of myStringBufferAlloc or myStringReleaseBuffer.
+ * COMPLEXITY: O(1)
+ * @param buf If NULL, no operation is performed.
+ * @param capacity the number of chars allocated to buf
+ */
+void myStringBufferFree(char *buf, size_t capacity)
+{
+	COUNT_CALL(myStringBufferFree);
+	freeBytes(buf, capacity * sizeof(char));
+}
+
+/**
+ * @brief Sets the value of str to the first len chars of buf, without copying them: str takes
+ * 	buf as its string, and frees it like its other strings.
+ * 	buf must be allocated by myStringBufferAlloc or released by myStringReleaseBuffer.
+ * COMPLEXITY: O(1)
+ * @param str
+ * @param buf
+ * @param len the number of chars of the value
+ * @param capacity the number of chars allocated to buf
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and buf is still owned by the
+ *  caller).
+ */
+MyStringRetVal myStringAdoptBuffer(MyString *str, char *buf, size_t len, size_t capacity)
+{
+	COUNT_CALL(myStringAdoptBuffer);
+	if (!isMutable(str) || buf == NULL || len > capacity || buf == str->_string)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	replaceString(str, buf, capacity, len);
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Takes the string of str without copying it, and leaves str like a new MyString.
+ * 	It is the caller's responsibility to give the string to a MyString by myStringAdoptBuffer,
+ * 	or to free it with myStringBufferFree. The chars are not terminated by the null character.
+ * COMPLEXITY: O(1)
+ * @param str
+ * @param len set to the number of chars of the string
+ * @param capacity set to the number of chars allocated to the string
+ * RETURN VALUE:
+ *  @return the string, or NULL if str is NULL, frozen or was never set.
+ */
+char * myStringReleaseBuffer(MyString *str, size_t *len, size_t *capacity)
+{
+	COUNT_CALL(myStringReleaseBuffer);
+	if (!isMutable(str) || str->_string == NULL || len == NULL || capacity == NULL ||
+		!expandString(str))
+	{
+		return NULL;
+	}
+
+	char* string = str->_string;
+	*len = str->_length;
+	*capacity = str->_capacity;
+	str->_string = NULL;
+	str->_capacity = 0;
+	str->_length = 0;
+	str->_utf8 = UTF8_UNKNOWN;
+	return string;
+}
+
+/**
+ * @brief Compare str1 and str2.
+ * COMPLEXITY: O(N) where N is the length of the shorter of str1 and str2, because that the
+ * complexity of myStringCustomCompare()
+ * @param str1
+ * @param str2
+ *
+ * RETURN VALUE:
+ * @return an integral value indicating the relationship between the strings:
+ * 	A zero value indicates that the strings are equal.
+ * 	A value greater than zero indicates that the first character that does not match has a greater
+ * 	ASCII value in str1 than in str2;
+ * 	And a value less than zero indicates the opposite.
+ * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+ */
+int myStringCompare(const MyString *str1, const MyString *str2)
+{
+	COUNT_CALL(myStringCompare);
+	if (str1 == NULL || str2 == NULL)
+	{
+		return MYSTR_ERROR_CODE;
+	}
+	return compareStrings(str1, str2, defaultComparator);
+}
+
+/**
+ * @brief Compares str1 and str2.
+ * COMPLEXITY: O(N) where N is the length of the shorter one of str1 and str2, because the loop
+ * runs N times
+ * @param str1
+ * @param str2
+ * @param comparator
+ * RETURN VALUE:
+ * @return an integral value indicating the relationship between the strings:
+ * 	A zero value indicates that the strings are equal according to the custom comparator
+ * 	(3rd parameter).
+ * 	A value greater than zero indicates that the first MyString is bigger according to the
+ * 	comparator.
+ * 	And a value less than zero indicates the opposite.
+ * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+ */
+int myStringCustomCompare(const MyString* str1, const MyString* str2,
+						  int (*comparator)(const char, const char))
+{
+	COUNT_CALL(myStringCustomCompare);
+	return compareStrings(str1, str2, comparator);
+}
+
+/**
+ * @brief Check if str1 is equal to str2.
+ * COMPLEXITY: O(N) where N is the length of the shorter of str1 and str2 because of the complexity
+ * of myStringCustomEqual()
+ * @param str1
+ * @param str2
+ *
+ * RETURN VALUE:
+ * @return an integral value indicating the equality of the strings (logical equality -
+ * that they are composed of the very same characters):
+ * 	A zero value indicates that the strings are not equal.
+ * 	A greater than zero value indicates that the strings are equal.
+ * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+  */
+int myStringEqual(const MyString *str1, const MyString *str2)
+{
+	COUNT_CALL(myStringEqual);
+	if (str1 == NULL || str2 == NULL)
+	{
+		return MYSTR_ERROR_CODE;
+	}
+	return equalStrings(str1, str2, defaultComparator);
+}
+
+/**
+ * @brief Check if str1 is equal to str2.
+ * COMPLEXITY: O(N) where N is the length of the shorter of str1 and str2, because of the
+ * complexity of myStringCustomCompare().
+ * @param str1
+ * @param str2
+ * @param comparator
+ *
+ * RETURN VALUE:
+ * @return an integral value indicating the equality of the strings using a custom comparator
+ * (3rd parameter):
+ * 	A zero value indicates that the strings are not equal.
+ * 	A greater than zero value indicates that the strings are equal.
+ * 	If string cannot be compared, the return value should be MYSTR_ERROR_CODE
+ */
+int myStringCustomEqual(const MyString* str1, const MyString* str2,
+						int (*comparator)(const char, const char))
+{
+	COUNT_CALL(myStringCustomEqual);
+	return equalStrings(str1, str2, comparator);
+}
+
+/**
+ * @brief Sets info to the details of the memory used by str, like myStringMemInfo, without
+ * 		  counting a call to it.
+ * @param str
+ * @param info
+ * @return true on success, false if str or info is NULL.
+ */
+static bool getMemInfo(const MyString* str, MyStringMemInfo* info)
+{
+	if (str == NULL || info == NULL)
+	{
+		return false;
+	}
+
+	info->objectBytes = allocatedSize(sizeof(MyString));
+	info->stringBytes = str->_string != NULL && !str->_borrowed ? allocatedSize(str->_capacity) : 0;
+	info->capacity = str->_capacity;
+	info->length = str->_length;
+	info->references = str->_frozen ? __atomic_load_n(&str->_refCount, __ATOMIC_RELAXED) : 1;
+	info->compressed = str->_compressed;
+	return true;
+}
+
+/**
+ * COMPLEXITY: O(1) because there is a constant number of operations in O(1)
+ * @return the amount of memory (all the memory that used by the MyString object itself and
+ * its allocations, including the overhead of the allocator and unused capacity), in bytes,
+ * allocated to str1.
+ */
+unsigned long myStringMemUsage(const MyString *str1)
+{
+	COUNT_CALL(myStringMemUsage);
+	MyStringMemInfo info;
+	if (!getMemInfo(str1, &info))
+	{
+		return 0;
+	}
+
+	return info.objectBytes + info.stringBytes;
+}
+
+/**
+ * @brief Sets info to the details of the memory used by str.
+ * COMPLEXITY: O(1) because there is a constant number of operations in O(1)
+ * @param str
+ * @param info
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringMemInfo(const MyString *str, MyStringMemInfo *info)
+{
+	COUNT_CALL(myStringMemInfo);
+	return getMemInfo(str, info) ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+}
+
+/**
+ * @brief Compresses the string of str with lzCompress. Reading str decompresses it back by
+ * 	expandString, so the compressed string is never seen outside of the library.
+ * COMPLEXITY: O(N) where N is the length of str, because every char is hashed once and the
+ * 			   hash table has a constant size.
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and str is not changed).
+ */
+MyStringRetVal myStringCompress(MyString *str)
+{
+	COUNT_CALL(myStringCompress);
+	if (!isMutable(str))
+	{
+		return MYSTRING_ERROR;
+	}
+	if (str->_compressed || str->_string == NULL || str->_length < MIN_COMPRESS_LENGTH)
+	{
+		return MYSTRING_SUCCESS;
+	}
+
+	// Saving less than an eighth isn't worth decompressing later
+	size_t limit = str->_length - str->_length / 8;
+	unsigned char* compressed = (unsigned char*)allocBytes(limit);
+	if (compressed == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t size = lzCompress((const unsigned char*)str->_string, str->_length, compressed, limit);
+	if (size == 0)
+	{
+		freeBytes(compressed, limit);
+		return MYSTRING_SUCCESS;
+	}
+
+	// The capacity of a compressed string is the size of its compressed chars
+	unsigned char* shrunk = (unsigned char*)reallocBytes(compressed, limit, size);
+	if (shrunk == NULL)
+	{
+		freeBytes(compressed, limit);
+		return MYSTRING_ERROR;
+	}
+	uint64_t utf8 = str->_utf8;
+	replaceString(str, (char*)shrunk, size, str->_length);
+	str->_compressed = true;
+	str->_utf8 = utf8;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Check if the string of str is compressed by myStringCompress.
+ * COMPLEXITY: O(1)
+ * @param str
+ * RETURN VALUE:
+ *  @return true if str is compressed, false otherwise (or if str is NULL).
+ */
+bool myStringIsCompressed(const MyString *str)
+{
+	COUNT_CALL(myStringIsCompressed);
+	return str != NULL && str->_compressed;
+}
+
+/**
+ * COMPLEXITY: O(T) where T is the number of threads that used the library, because the gauges of
+ * 			   every thread are summed.
+ * @return the number of bytes allocated by the library for MyStrings and their strings that are
+ * not freed yet, including the overhead of the allocator.
+ */
+long long myStringLiveBytes()
+{
+	return readGauge(LIVE_BYTES);
+}
+
+/**
+ * COMPLEXITY: O(T) where T is the number of threads that used the library, because the gauges of
+ * 			   every thread are summed.
+ * @return the number of MyStrings that are allocated and not freed yet.
+ */
+long long myStringLiveObjects()
+{
+	return readGauge(LIVE_OBJECTS);
+}
+
+/**
+ * @brief Sets the allocator of the library.
+ * COMPLEXITY: O(T) where T is the number of threads that used the library, because the live bytes
+ * 			   are checked.
+ * @param mallocFn
+ * @param reallocFn
+ * @param freeFn
+ * @param ctx
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringSetAllocator(void* (*mallocFn)(size_t size, void* ctx),
+									void* (*reallocFn)(void* ptr, size_t size, void* ctx),
+									void (*freeFn)(void* ptr, void* ctx), void* ctx)
+{
+	COUNT_CALL(myStringSetAllocator);
+	bool isDefault = mallocFn == NULL && reallocFn == NULL && freeFn == NULL;
+	if ((!isDefault && (mallocFn == NULL || reallocFn == NULL || freeFn == NULL)) ||
+		readGauge(LIVE_BYTES) != 0)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	allocator._malloc = isDefault ? defaultMalloc : mallocFn;
+	allocator._realloc = isDefault ? defaultRealloc : reallocFn;
+	allocator._free = isDefault ? defaultFree : freeFn;
+	allocator._ctx = isDefault ? NULL : ctx;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * COMPLEXITY: O(1) because there is a constant number of operations in O(1)
+ * @return the length of the string in str1.
+ */
+unsigned long myStringLen(const MyString *str1)
+{
+	COUNT_CALL(myStringLen);
+	if (str1 == NULL)
+	{
+		return 0;
+	}
+	return str1->_length;
+}
+
+/**
+ * @brief Returns a read-only pointer to the chars of str. The chars are not terminated by the
+ * 	null character, use myStringLen() to get their number.
+ * 	The pointer is valid until the next change to str.
+ * COMPLEXITY: O(1) because there is a constant number of operations in O(1), or O(N) where N is
+ * 			   the length of str the first time a compressed str is read.
+ * @param str the MyString
+ * RETURN VALUE:
+ *  @return pointer to the chars of str, or NULL if str is NULL, was never set or the allocation
+ *  failed.
+ */
+const char * myStringData(const MyString *str)
+{
+	COUNT_CALL(myStringData);
+	if (str == NULL || !expandString(str))
+	{
+		return NULL;
+	}
+	return str->_string;
+}
+
+/**
+ * Writes the content of str to stream. (like fputs())
+ * COMPLEXITY: O(N) where N is the length of str, because every char is written.
+ *
+ * RETURNS:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringWrite(const MyString *str, FILE *stream)
+{
+	COUNT_CALL(myStringWrite);
+	if (str == NULL || stream == NULL || !expandString(str))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	// Written directly from the string, without copying it to a C string first
+	if (str->_length > 0 && fwrite(str->_string, sizeof(char), str->_length, stream) != str->_length)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Check if the chars of str are valid UTF-8. The ASCII chars are skipped 8 at a time, and
+ * 	the result is kept in str until it is changed.
+ * COMPLEXITY: O(N) where N is the length of str the first time, O(1) until str is changed.
+ * @param str
+ * RETURN VALUE:
+ *  @return true if str is valid UTF-8, false otherwise (or if str is NULL).
+ */
+bool myStringValidateUtf8(const MyString *str)
+{
+	COUNT_CALL(myStringValidateUtf8);
+	if (str == NULL || !expandString(str))
+	{
+		return false;
+	}
+	return getUtf8(str) != UTF8_INVALID;
+}
+
+/**
+ * @brief Counts the code points of str, which must be valid UTF-8.
+ * COMPLEXITY: O(N) where N is the length of str the first time, O(1) until str is changed.
+ * @param str
+ * RETURN VALUE:
+ *  @return the number of code points, or MYSTR_ERROR_CODE if str is NULL or not valid UTF-8.
+ */
+long myStringCodepointLen(const MyString *str)
+{
+	COUNT_CALL(myStringCodepointLen);
+	if (str == NULL || !expandString(str))
+	{
+		return MYSTR_ERROR_CODE;
+	}
+
+	uint64_t utf8 = getUtf8(str);
+	return utf8 == UTF8_INVALID ? MYSTR_ERROR_CODE : (long)(utf8 - UTF8_VALID);
+}
+
+/**
+ * @brief Decodes the UTF-8 code point starting at the char *offset of str, and advances *offset
+ * 	to the char after it.
+ * COMPLEXITY: O(1)
+ * @param str
+ * @param offset the offset in chars
+ * RETURN VALUE:
+ *  @return the code point, MYSTR_END_CODE at the end of str, or MYSTR_ERROR_CODE on failure (and
+ *  *offset is not changed).
+ */
+int myStringNextCodepoint(const MyString *str, size_t *offset)
+{
+	COUNT_CALL(myStringNextCodepoint);
+	if (str == NULL || offset == NULL || *offset > str->_length || !expandString(str))
+	{
+		return MYSTR_ERROR_CODE;
+	}
+	if (*offset == str->_length)
+	{
+		return MYSTR_END_CODE;
+	}
+
+	int codepoint;
+	size_t n = decodeUtf8((const unsigned char*)str->_string, str->_length, *offset, &codepoint);
+	if (n == 0)
+	{
+		return MYSTR_ERROR_CODE;
+	}
+	*offset += n;
+	return codepoint;
+}
+
+/**
+ * @brief sort an array of MyString pointers
+ * COMPLEXITY: O(N^2) because of the complexity of qsort on worst case.
+ * @param arr
+ * @param len
+ * @param comparator custom comparator
+ *
+ * RETURN VALUE:none
+  */
+void myStringCustomSort(MyString** arr, size_t len, int (*comparator)(const void*, const void*))
+{
+	COUNT_CALL(myStringCustomSort);
+	if (arr == NULL || !(len > 0) || comparator == NULL)
+	{
+		return ;
+	}
+	qsort(arr, len, sizeof(MyString*), comparator);
+}
+
+/**
+ * @brief sorts an array of MyString pointers according to the default comparison (like in myStringCompare)
+ * COMPLEXITY: O(N^2) because of the complexity of qsort on worst case inside myStringCustomSort.
+ * @param arr
+ * @param len
+ *
+ * RETURN VALUE: none
+  */
+void myStringSort(MyString** arr, size_t len)
+{
+	COUNT_CALL(myStringSort);
+	if (arr == NULL || !(len > 0))
+	{
+		return ;
+	}
+
+	qsort(arr, len, sizeof(MyString*), myStringComparatorCasting);
+}
+
+/**
+ * @brief Swaps the MyString pointers str1 and str2 point to.
+ * @param str1
+ * @param str2
+ */
+static void swapStrings(MyString** str1, MyString** str2)
+{
+	MyString* temp = *str1;
+	*str1 = *str2;
+	*str2 = temp;
+}
+
+/**
+ * @brief Moves heap[i] down the max heap heap until it is not smaller than its children.
+ * @param heap
+ * @param len the number of MyStrings in heap
+ * @param i
+ * @param comparator
+ */
+static void siftDown(MyString** heap, size_t len, size_t i,
+					 int (*comparator)(const void*, const void*))
+{
+	while (2 * i + 1 < len)
+	{
+		size_t child = 2 * i + 1;
+		if (child + 1 < len && comparator(&heap[child + 1], &heap[child]) > 0)
+		{
+			child++;
+		}
+		if (comparator(&heap[child], &heap[i]) <= 0)
+		{
+			return;
+		}
+		swapStrings(&heap[i], &heap[child]);
+		i = child;
+	}
+}
+
+/**
+ * @brief Sorts arr using insertion sort, which is the fastest for a few MyStrings.
+ * @param arr
+ * @param len
+ * @param comparator
+ */
+static void insertionSort(MyString** arr, size_t len, int (*comparator)(const void*, const void*))
+{
+	size_t i, j;
+	for (i = 1; i < len; i++)
+	{
+		for (j = i; j > 0 && comparator(&arr[j], &arr[j - 1]) < 0; j--)
+		{
+			swapStrings(&arr[j], &arr[j - 1]);
+		}
+	}
+}
+
+/**
+ * @brief Sorts the k smallest MyStrings of arr into its first k places like
+ * 		  myStringCustomPartialSort, without counting a call to it.
+ * @param arr
+ * @param len
+ * @param k
+ * @param comparator
+ */
+static void partialSort(MyString** arr, size_t len, size_t k,
+						int (*comparator)(const void*, const void*))
+{
+	if (k > len)
+	{
+		k = len;
+	}
+	if (arr == NULL || comparator == NULL || k == 0)
+	{
+		return ;
+	}
+
+	size_t i;
+
+	for (i = k / 2; i > 0; i--)
+	{
+		siftDown(arr, k, i - 1, comparator);
+	}
+
+	for (i = k; i < len; i++)
+	{
+		if (comparator(&arr[i], &arr[0]) < 0)
+		{
+			swapStrings(&arr[i], &arr[0]);
+			siftDown(arr, k, 0, comparator);
+		}
+	}
+
+	for (i = k - 1; i > 0; i--)
+	{
+		swapStrings(&arr[0], &arr[i]);
+		siftDown(arr, i, 0, comparator);
+	}
+}
+
+/**
+ * @brief sorts the k smallest MyStrings of an array of MyString pointers into its first k
+ * 	places, using a custom comparator (like in myStringCustomSort). The order of the other
+ * 	places is unspecified.
+ * 	If k is bigger than len, the whole array is sorted.
+ * COMPLEXITY: O(N*log(K)) because the first K MyStrings are kept in a max heap and every other
+ * 			   MyString is compared to its top, and replaces it in O(log(K)) if it is smaller.
+ * @param arr
+ * @param len
+ * @param k
+ * @param comparator custom comparator
+ *
+ * RETURN VALUE: none
+  */
+void myStringCustomPartialSort(MyString** arr, size_t len, size_t k,
+							   int (*comparator)(const void*, const void*))
+{
+	COUNT_CALL(myStringCustomPartialSort);
+	partialSort(arr, len, k, comparator);
+}
+
+/**
+ * @brief sorts the k smallest MyStrings of an array of MyString pointers into its first k
+ * 	places, according to the default comparison (like in myStringCompare). The order of the
+ * 	other places is unspecified.
+ * 	If k is bigger than len, the whole array is sorted.
+ * COMPLEXITY: O(N*log(K)) because of the complexity of myStringCustomPartialSort.
+ * @param arr
+ * @param len
+ * @param k
+ *
+ * RETURN VALUE: none
+  */
+void myStringPartialSort(MyString** arr, size_t len, size_t k)
+{
+	COUNT_CALL(myStringPartialSort);
+	partialSort(arr, len, k, myStringComparatorCasting);
+}
+
+/**
+ * @brief Puts the MyString of the n-th place of arr in it like myStringCustomNthElement, without
+ * 		  counting a call to it.
+ * @param arr
+ * @param len
+ * @param n
+ * @param comparator
+ */
+static void nthElement(MyString** arr, size_t len, size_t n,
+					   int (*comparator)(const void*, const void*))
+{
+	if (arr == NULL || comparator == NULL || n >= len)
+	{
+		return ;
+	}
+
+	size_t low = 0, high = len, depthLimit = 0;
+
+	for (; len > 1; len >>= 1)
+	{
+		depthLimit += 2;
+	}
+
+	while (high - low > INSERTION_SORT_LIMIT)
+	{
+		if (depthLimit == 0)
+		{
+			partialSort(arr + low, high - low, n - low + 1, comparator);
+			return ;
+		}
+		depthLimit--;
+
+		// Median of 3 puts a MyString not bigger than the pivot in low and one not smaller than
+		// the pivot in high - 1, which stop the scans below
+		size_t middle = low + (high - 1 - low) / 2;
+		if (comparator(&arr[middle], &arr[low]) < 0)
+		{
+			swapStrings(&arr[middle], &arr[low]);
+		}
+		if (comparator(&arr[high - 1], &arr[low]) < 0)
+		{
+			swapStrings(&arr[high - 1], &arr[low]);
+		}
+		if (comparator(&arr[high - 1], &arr[middle]) < 0)
+		{
+			swapStrings(&arr[high - 1], &arr[middle]);
+		}
+
+		MyString* pivot = arr[middle];
+		size_t i = low, j = high - 1;
+
+		while (true)
+		{
+			while (comparator(&arr[i], &pivot) < 0)
+			{
+				i++;
+			}
+			while (comparator(&arr[j], &pivot) > 0)
+			{
+				j--;
+			}
+			if (i >= j)
+			{
+				break;
+			}
+			swapStrings(&arr[i], &arr[j]);
+			i++;
+			j--;
+		}
+
+		if (n <= j)
+		{
+			high = j + 1;
+		}
+		else
+		{
+			low = j + 1;
+		}
+	}
+
+	insertionSort(arr + low, high - low, comparator);
+}
+
+/**
+ * @brief reorders an array of MyString pointers so that arr[n] is the MyString that would be in
+ * 	that place if the array was sorted with the custom comparator (like in myStringCustomSort),
+ * 	no MyString before it is bigger than it and no MyString after it is smaller than it.
+ * 	If n is not smaller than len, no operation is performed.
+ * COMPLEXITY: O(N) on average because every partition of quickselect runs on the part containing
+ * 			   the n-th place only. O(N*log(N)) on worst case, because after 2*log(N) bad
+ * 			   partitions the rest is done by myStringCustomPartialSort.
+ * @param arr
+ * @param len
+ * @param n
+ * @param comparator custom comparator
+ *
+ * RETURN VALUE: none
+  */
+void myStringCustomNthElement(MyString** arr, size_t len, size_t n,
+							  int (*comparator)(const void*, const void*))
+{
+	COUNT_CALL(myStringCustomNthElement);
+	nthElement(arr, len, n, comparator);
+}
+
+/**
+ * @brief reorders an array of MyString pointers so that arr[n] is the MyString that would be in
+ * 	that place if the array was sorted according to the default comparison (like in
+ * 	myStringCompare), no MyString before it is bigger than it and no MyString after it is smaller
+ * 	than it.
+ * 	If n is not smaller than len, no operation is performed.
+ * COMPLEXITY: O(N) on average because of the complexity of myStringCustomNthElement.
+ * @param arr
+ * @param len
+ * @param n
+ *
+ * RETURN VALUE: none
+  */
+void myStringNthElement(MyString** arr, size_t len, size_t n)
+{
+	COUNT_CALL(myStringNthElement);
+	nthElement(arr, len, n, myStringComparatorCasting);
+}
+
+/**
+ * @brief Frees the keys made by transform in myStringKeySort, and the array of keys.
+ * @param keys
+ * @param numOfKeys the number of keys to free
+ * @param len the length of the array
+ */
+static void freeSortKeys(SortKey* keys, size_t numOfKeys, size_t len)
+{
+	size_t i;
+	for (i = 0; i < numOfKeys; i++)
+	{
+		releaseMyString((MyString*)keys[i]._key);
+	}
+	freeBytes(keys, len * sizeof(SortKey));
+}
+
+/**
+ * @brief sorts an array of MyString pointers according to keys made from the strings.
+ * 	transform is called once for every string and sets key to the normalized form of str
+ * 	(e.g. the string in lower case), and the strings are ordered like myStringCompare orders their
+ * 	keys. The first 8 chars of every key are cached next to it, so most comparisons don't access
+ * 	the keys themselves.
+ * 	If transform is NULL, the strings are their own keys.
+ * COMPLEXITY: O(N*K + N^2) where K is the complexity of transform, because transform is called
+ * 			   once for every string and qsort is O(N^2) on worst case.
+ * @param arr
+ * @param len
+ * @param transform sets key to the key of str.
+ *
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is left unchanged).
+  */
+MyStringRetVal myStringKeySort(MyString** arr, size_t len,
+							   MyStringRetVal (*transform)(const MyString *str, MyString *key))
+{
+	COUNT_CALL(myStringKeySort);
+	if (!validArray(arr, len))
+	{
+		return MYSTRING_ERROR;
+	}
+	if (len < 2)
+	{
+		return MYSTRING_SUCCESS;
+	}
+	if (!expandArray(arr, len))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	SortKey* keys = (SortKey*)allocBytes(len * sizeof(SortKey));
+	if (keys == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t i;
+
+	for (i = 0; i < len; i++)
+	{
+		keys[i]._str = arr[i];
+		keys[i]._key = arr[i];
+
+		if (transform != NULL)
+		{
+			MyString* key = newMyString();
+			if (key == NULL || transform(arr[i], key) == MYSTRING_ERROR)
+			{
+				releaseMyString(key);
+				freeSortKeys(keys, i, len);
+				return MYSTRING_ERROR;
+			}
+			keys[i]._key = key;
+		}
+
+		keys[i]._prefix = getPrefix(keys[i]._key);
+	}
+
+	qsort(keys, len, sizeof(SortKey), sortKeyComparator);
+
+	for (i = 0; i < len; i++)
+	{
+		arr[i] = keys[i]._str;
+	}
+
+	freeSortKeys(keys, transform != NULL ? len : 0, len);
+
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief sorts an array of MyString pointers in natural order: runs of digits are compared by
+ * 	their numeric value, so "file9" comes before "file10" and "v1.9" before "v1.10", and the
+ * 	other chars are compared like in myStringCompare. A run of digits is ordered among the other
+ * 	chars like a digit. Signs aren't part of the numbers, and leading zeros are ignored, so
+ * 	MyStrings that differ only in them are in an unspecified order.
+ * COMPLEXITY: O(N*L + N^2*L) where L is the length of the strings, because the key of every
+ * 			   string is made once, and qsort is O(N^2) comparisons of keys on worst case.
+ * @param arr
+ * @param len
+ *
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is left unchanged).
+  */
+MyStringRetVal myStringNaturalSort(MyString** arr, size_t len)
+{
+	COUNT_CALL(myStringNaturalSort);
+	if (!validArray(arr, len))
+	{
+		return MYSTRING_ERROR;
+	}
+	if (len < 2)
+	{
+		return MYSTRING_SUCCESS;
+	}
+	if (!expandArray(arr, len))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	// The keys are made into one buffer, so there are 2 allocations however many strings there are
+	size_t i, totalLength = 0;
+	for (i = 0; i < len; i++)
+	{
+		totalLength += makeNaturalKey(arr[i]->_string, arr[i]->_length, NULL);
+	}
+
+	NaturalKey* keys = (NaturalKey*)allocBytes(len * sizeof(NaturalKey));
+	char* buffer = (char*)allocBytes(totalLength + 1);
+	if (keys == NULL || buffer == NULL)
+	{
+		freeBytes(keys, len * sizeof(NaturalKey));
+		freeBytes(buffer, totalLength + 1);
+		return MYSTRING_ERROR;
+	}
+
+	char* key = buffer;
+	size_t common = SIZE_MAX;
+	for (i = 0; i < len; i++)
+	{
+		keys[i]._str = arr[i];
+		keys[i]._key = key;
+		keys[i]._length = makeNaturalKey(arr[i]->_string, arr[i]->_length, key);
+		key += keys[i]._length;
+
+		// Names like "photos/IMG_17.jpg" share long prefixes, which would make the cached prefixes
+		// equal, so the prefixes are taken after the chars common to all the keys
+		size_t j = 0;
+		while (j < common && j < keys[i]._length && keys[i]._key[j] == keys[0]._key[j])
+		{
+			j++;
+		}
+		common = j;
+	}
+
+	for (i = 0; i < len; i++)
+	{
+		keys[i]._key += common;
+		keys[i]._length -= common;
+		keys[i]._prefix = getCharsPrefix(keys[i]._key, keys[i]._length);
+	}
+
+	qsort(keys, len, sizeof(NaturalKey), naturalKeyComparator);
+
+	for (i = 0; i < len; i++)
+	{
+		arr[i] = keys[i]._str;
+	}
+
+	freeBytes(buffer, totalLength + 1);
+	freeBytes(keys, len * sizeof(NaturalKey));
+
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Makes str immutable: every function changing str will fail from now on. A frozen
+ * 	MyString can be shared between threads without copying or locking: every thread reading it
+ * 	takes a reference with myStringRetain and releases it with myStringFree.
+ * 	Freezing a frozen MyString does nothing.
+ * COMPLEXITY: O(1) because there is a constant number of operations in O(1)
+ * @param str the MyString to freeze
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringFreeze(MyString *str)
+{
+	COUNT_CALL(myStringFreeze);
+	if (str == NULL || !expandString(str))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	// Frozen MyStrings may be read concurrently, so myStringCStr can't terminate them later
+	if (!str->_frozen && str->_string != NULL && !terminateString(str))
+	{
+		return MYSTRING_ERROR;
+	}
+	str->_frozen = true;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Check if str is frozen.
+ * COMPLEXITY: O(1) because there is a constant number of operations in O(1)
+ * @param str
+ * RETURN VALUE:
+ *  @return true if str is frozen, false otherwise (or if str is NULL).
+ */
+bool myStringIsFrozen(const MyString *str)
+{
+	COUNT_CALL(myStringIsFrozen);
+	return str != NULL && str->_frozen;
+}
+
+/**
+ * @brief Takes another reference to the frozen MyString str. Every reference is released by a
+ * 	call to myStringFree, and str is freed when its last reference is released.
+ * 	Can be called from any thread holding a reference to str.
+ * COMPLEXITY: O(1) because there is a constant number of operations in O(1)
+ * @param str the frozen MyString
+ * RETURN VALUE:
+ *  @return str, or NULL if str is NULL or not frozen.
+ */
+MyString * myStringRetain(MyString *str)
+{
+	COUNT_CALL(myStringRetain);
+	if (str == NULL || !str->_frozen)
+	{
+		return NULL;
+	}
+
+	__atomic_add_fetch(&str->_refCount, 1, __ATOMIC_RELAXED);
+	return str;
+}
+
+/**
+ * @brief Hashes the chars of str with FNV-1a followed by a final mix, so all the bits of the
+ * 		  result depend on all the chars.
+ * @param str
+ * @return the hash of str
+ */
+static uint64_t hashString(const MyString* str)
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+	size_t i;
+
+	for (i = 0; i < str->_length; i++)
+	{
+		hash ^= (unsigned char)str->_string[i];
+		hash *= FNV_PRIME;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+/**
+ * @brief Finds the hash of str, using the hash cached in it if str is frozen.
+ * @param str
+ * @return the hash of str
+ */
+static uint64_t getHash(const MyString* str)
+{
+	if (!str->_frozen)
+	{
+		return hashString(str);
+	}
+
+	// Threads sharing str may compute the hash together, but they all store the same value
+	uint64_t hash = __atomic_load_n(&str->_hash, __ATOMIC_RELAXED);
+	if (hash == 0)
+	{
+		hash = hashString(str);
+		__atomic_store_n(&((MyString*)str)->_hash, hash, __ATOMIC_RELAXED);
+	}
+	return hash;
+}
+
+/**
+ * @brief Check if str1 and str2 are composed of the very same characters. A MyString that was
+ * 		  never set is equal to the empty string.
+ * @param str1
+ * @param str2
+ * @return true if they are equal, false otherwise.
+ */
+static bool sameChars(const MyString* str1, const MyString* str2)
+{
+	return str1->_length == str2->_length &&
+		   (str1->_length == 0 || memcmp(str1->_string, str2->_string, str1->_length) == 0);
+}
+
+/**
+ * @brief Allocates an empty hash table with enough slots for len MyStrings.
+ * @param len
+ * @param mask set to the number of slots minus 1
+ * @return the table, or NULL if the allocation failed.
+ */
+static HashSlot* allocHashTable(size_t len, size_t* mask)
+{
+	size_t slots = 2;
+	while (slots < 2 * len)
+	{
+		slots <<= 1;
+	}
+
+	HashSlot* table = (HashSlot*)allocBytes(slots * sizeof(HashSlot));
+	if (table == NULL)
+	{
+		return NULL;
+	}
+
+	size_t i;
+	for (i = 0; i < slots; i++)
+	{
+		table[i]._index = EMPTY_SLOT;
+	}
+
+	*mask = slots - 1;
+	return table;
+}
+
+/**
+ * @brief Looks for a MyString equal to str in the hash table, and adds str to it if there is no
+ * 		  such MyString.
+ * @param table
+ * @param mask
+ * @param arr the array the indexes in table refer to
+ * @param str
+ * @param index the index to add for str
+ * @param found set to the index of the equal MyString if one was found
+ * @return true if an equal MyString was found, false if str was added.
+ */
+static bool findOrAdd(HashSlot* table, size_t mask, MyString** arr, const MyString* str,
+					  size_t index, size_t* found)
+{
+	uint64_t hash = getHash(str);
+	size_t slot = (size_t)hash & mask;
+
+	while (table[slot]._index != EMPTY_SLOT)
+	{
+		if (table[slot]._hash == hash && sameChars(arr[table[slot]._index], str))
+		{
+			*found = table[slot]._index;
+			return true;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	table[slot]._hash = hash;
+	table[slot]._index = index;
+	return false;
+}
+
+/**
+ * @brief Allocates a new empty MyStringHashSet with room for capacity MyStrings.
+ * 	The capacity is fixed: MyStrings are never removed from the set and it never grows, so
+ * 	lookups don't have to lock or to protect the memory they read.
+ * 	It is the caller's responsibility to free the returned MyStringHashSet.
+ * COMPLEXITY: O(N) where N is the capacity, because all the slots are set to NULL.
+ * @param capacity the maximal number of MyStrings in the set
+ * RETURN VALUE:
+ *  @return a pointer to the new set, or NULL if the allocation failed.
+ */
+MyStringHashSet * myStringHashSetAlloc(size_t capacity)
+{
+	COUNT_CALL(myStringHashSetAlloc);
+	MyStringHashSet* set = (MyStringHashSet*)allocBytes(sizeof(MyStringHashSet));
+	if (set == NULL)
+	{
+		return NULL;
+	}
+
+	size_t slots = 2;
+	while (slots < 2 * capacity)
+	{
+		slots <<= 1;
+	}
+
+	set->_slots = (MyString**)allocBytes(slots * sizeof(MyString*));
+	if (set->_slots == NULL)
+	{
+		freeBytes(set, sizeof(MyStringHashSet));
+		return NULL;
+	}
+	memset(set->_slots, 0, slots * sizeof(MyString*));
+
+	set->_mask = slots - 1;
+	set->_size = 0;
+	return set;
+}
+
+/**
+ * @brief Frees set and releases its references to the MyStrings in it.
+ * 	Must not be called concurrently with other functions on set.
+ * 	If set is NULL, no operation is performed.
+ * COMPLEXITY: O(N) where N is the capacity, because every slot is checked.
+ * @param set
+ */
+void myStringHashSetFree(MyStringHashSet *set)
+{
+	COUNT_CALL(myStringHashSetFree);
+	if (set == NULL)
+	{
+		return;
+	}
+
+	size_t i;
+	for (i = 0; i <= set->_mask; i++)
+	{
+		releaseMyString(set->_slots[i]);
+	}
+
+	freeBytes(set->_slots, (set->_mask + 1) * sizeof(MyString*));
+	freeBytes(set, sizeof(MyStringHashSet));
+}
+
+/**
+ * @brief Adds the frozen MyString str to set, unless set already has a MyString equal to it
+ * 	(like in myStringEqual). The set takes its own reference to str (like in myStringRetain).
+ * 	Can be called concurrently with myStringHashSetInsert and myStringHashSetFind.
+ * COMPLEXITY: O(M) on average where M is the length of str, because str is hashed and compared
+ * 			   to a constant number of MyStrings on average.
+ * @param set
+ * @param str the frozen MyString to add
+ * RETURN VALUE:
+ *  @return the MyString in set equal to str (str itself if it was added), valid as long as set
+ *  is not freed, or NULL on failure (str is not frozen or set is full).
+ */
+MyString * myStringHashSetInsert(MyStringHashSet *set, MyString *str)
+{
+	COUNT_CALL(myStringHashSetInsert);
+	if (set == NULL || str == NULL || !str->_frozen)
+	{
+		return NULL;
+	}
+
+	uint64_t hash = getHash(str);
+	size_t slot = (size_t)hash & set->_mask, probes;
+
+	for (probes = 0; probes <= set->_mask; probes++)
+	{
+		MyString* current = __atomic_load_n(&set->_slots[slot], __ATOMIC_ACQUIRE);
+
+		if (current == NULL)
+		{
+			// On failure current is set to the MyString another thread put in the slot
+			if (__atomic_compare_exchange_n(&set->_slots[slot], &current, str, false,
+											__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+			{
+				__atomic_add_fetch(&str->_refCount, 1, __ATOMIC_RELAXED);
+				__atomic_add_fetch(&set->_size, 1, __ATOMIC_RELAXED);
+				return str;
+			}
+		}
+
+		if (getHash(current) == hash && sameChars(current, str))
+		{
+			return current;
+		}
+
+		slot = (slot + 1) & set->_mask;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Looks for a MyString equal to str (like in myStringEqual) in set.
+ * 	Can be called concurrently with myStringHashSetInsert and myStringHashSetFind.
+ * COMPLEXITY: O(M) on average where M is the length of str, because str is hashed and compared
+ * 			   to a constant number of MyStrings on average.
+ * @param set
+ * @param str
+ * RETURN VALUE:
+ *  @return the MyString in set equal to str, valid as long as set is not freed, or NULL if there
+ *  is no such MyString.
+ */
+MyString * myStringHashSetFind(const MyStringHashSet *set, const MyString *str)
+{
+	COUNT_CALL(myStringHashSetFind);
+	if (set == NULL || str == NULL || !expandString(str))
+	{
+		return NULL;
+	}
+
+	uint64_t hash = getHash(str);
+	size_t slot = (size_t)hash & set->_mask, probes;
+
+	for (probes = 0; probes <= set->_mask; probes++)
+	{
+		MyString* current = __atomic_load_n(&set->_slots[slot], __ATOMIC_ACQUIRE);
+
+		if (current == NULL)
+		{
+			return NULL;
+		}
+		if (getHash(current) == hash && sameChars(current, str))
+		{
+			return current;
+		}
+
+		slot = (slot + 1) & set->_mask;
+	}
+
+	return NULL;
+}
+
+/**
+ * COMPLEXITY: O(1) because there is a constant number of operations in O(1)
+ * @return the number of MyStrings in set.
+ */
+size_t myStringHashSetSize(const MyStringHashSet *set)
+{
+	COUNT_CALL(myStringHashSetSize);
+	if (set == NULL)
+	{
+		return 0;
+	}
+	return __atomic_load_n(&set->_size, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief removes the duplicates from an array of MyString pointers (MyStrings composed of the
+ * 	very same characters, like in myStringEqual). The first occurrence of every value is kept and
+ * 	the kept MyStrings are moved to the start of arr in the order they were first seen.
+ * 	If freeDuplicates is true the duplicates are freed, otherwise they are moved after the kept
+ * 	MyStrings in their original order.
+ * COMPLEXITY: O(N*M) on average where M is the average length of the MyStrings, because every
+ * 			   MyString is hashed once and looked up in a hash table.
+ * @param arr
+ * @param len
+ * @param freeDuplicates
+ * @param uniqueLen set to the number of kept MyStrings.
+ *
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is left unchanged).
+ */
+MyStringRetVal myStringUnique(MyString** arr, size_t len, bool freeDuplicates, size_t *uniqueLen)
+{
+	COUNT_CALL(myStringUnique);
+	if (!validArray(arr, len) || uniqueLen == NULL || !expandArray(arr, len))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t mask;
+	HashSlot* table = allocHashTable(len, &mask);
+	MyString** duplicates = NULL;
+
+	if (table == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+	if (!freeDuplicates && len > 0)
+	{
+		duplicates = (MyString**)allocBytes(len * sizeof(MyString*));
+		if (duplicates == NULL)
+		{
+			freeBytes(table, (mask + 1) * sizeof(HashSlot));
+			return MYSTRING_ERROR;
+		}
+	}
+
+	size_t i, found, kept = 0, numOfDuplicates = 0;
+
+	for (i = 0; i < len; i++)
+	{
+		MyString* str = arr[i];
+
+		if (!findOrAdd(table, mask, arr, str, kept, &found))
+		{
+			arr[kept] = str;
+			kept++;
+		}
+		else if (freeDuplicates)
+		{
+			// The same MyString may be in arr twice, and then it is kept and not freed
+			if (arr[found] != str)
+			{
+				releaseMyString(str);
+			}
+		}
+		else
+		{
+			duplicates[numOfDuplicates] = str;
+			numOfDuplicates++;
+		}
+	}
+
+	if (numOfDuplicates > 0)
+	{
+		memcpy(arr + kept, duplicates, numOfDuplicates * sizeof(MyString*));
+	}
+
+	freeBytes(duplicates, len * sizeof(MyString*));
+	freeBytes(table, (mask + 1) * sizeof(HashSlot));
+	*uniqueLen = kept;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief counts the distinct values in an array of MyString pointers (like in myStringEqual).
+ * COMPLEXITY: O(N*M) on average where M is the average length of the MyStrings, because every
+ * 			   MyString is hashed once and looked up in a hash table.
+ * @param arr
+ * @param len
+ * @param count set to the number of distinct values.
+ *
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringCountDistinct(MyString** arr, size_t len, size_t *count)
+{
+	COUNT_CALL(myStringCountDistinct);
+	if (!validArray(arr, len) || count == NULL || !expandArray(arr, len))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t mask;
+	HashSlot* table = allocHashTable(len, &mask);
+
+	if (table == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t i, found, distinct = 0;
+
+	for (i = 0; i < len; i++)
+	{
+		if (!findOrAdd(table, mask, arr, arr[i], i, &found))
+		{
+			distinct++;
+		}
+	}
+
+	freeBytes(table, (mask + 1) * sizeof(HashSlot));
+	*count = distinct;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Find the natural logarithm of x, without the math library.
+ * 		  x should be positive.
+ * @param x
+ * @return ln(x)
+ */
+static double naturalLog(double x)
+{
+	int exponent = 0;
+	while (x >= 2.0)
+	{
+		x /= 2.0;
+		exponent++;
+	}
+	while (x < 1.0)
+	{
+		x *= 2.0;
+		exponent--;
+	}
+
+	// ln(x) = 2 * atanh((x - 1) / (x + 1)), and the series converges fast for x in [1, 2)
+	double y = (x - 1.0) / (x + 1.0), ySquare = y * y, term = y, sum = 0.0;
+	int i;
+	for (i = 1; i < 40; i += 2)
+	{
+		sum += term / i;
+		term *= ySquare;
+	}
+
+	return 2.0 * sum + exponent * LN_2;
+}
+
+/**
+ * @brief estimates the number of distinct values in an array of MyString pointers using the
+ * 	HyperLogLog algorithm, with a relative error of about 1% and a fixed amount of memory (16KB),
+ * 	for arrays too big for myStringCountDistinct.
+ * COMPLEXITY: O(N*M) where M is the average length of the MyStrings, because every MyString is
+ * 			   hashed once, and O(1) memory.
+ * @param arr
+ * @param len
+ * @param estimate set to the estimated number of distinct values.
+ *
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringEstimateDistinct(MyString** arr, size_t len, size_t *estimate)
+{
+	COUNT_CALL(myStringEstimateDistinct);
+	if (!validArray(arr, len) || estimate == NULL || !expandArray(arr, len))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	unsigned char* registers = (unsigned char*)allocBytes(HLL_REGISTERS * sizeof(unsigned char));
+	if (registers == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+	memset(registers, 0, HLL_REGISTERS * sizeof(unsigned char));
+
+	size_t i;
+
+	for (i = 0; i < len; i++)
+	{
+		uint64_t hash = getHash(arr[i]);
+		size_t index = (size_t)(hash >> (64 - HLL_PRECISION));
+		uint64_t rest = hash << HLL_PRECISION;
+		unsigned char rank = 1;
+
+		while (rank <= 64 - HLL_PRECISION && (rest & (1ULL << 63)) == 0)
+		{
+			rank++;
+			rest <<= 1;
+		}
+
+		if (rank > registers[index])
+		{
+			registers[index] = rank;
+		}
+	}
+
+	double sum = 0.0;
+	size_t zeros = 0;
+
+	for (i = 0; i < HLL_REGISTERS; i++)
+	{
+		sum += 1.0 / (double)(1ULL << registers[i]);
+		if (registers[i] == 0)
+		{
+			zeros++;
+		}
+	}
+	freeBytes(registers, HLL_REGISTERS * sizeof(unsigned char));
+
+	double result = HLL_ALPHA * HLL_REGISTERS * HLL_REGISTERS / sum;
+
+	// Small cardinalities are estimated better by counting the empty registers
+	if (result <= 2.5 * HLL_REGISTERS && zeros > 0)
+	{
+		result = HLL_REGISTERS * naturalLog((double)HLL_REGISTERS / (double)zeros);
+	}
+
+	*estimate = (size_t)(result + 0.5);
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Writes the n MyStrings of arr to stream, in the format read by myStringArrayLoad:
+ * 	the 8 chars "MYSTRAR1", the number of MyStrings, a table of n + 1 offsets to the start of
+ * 	every string (and to the end of the last one) from the start of the chars, and then the
+ * 	chars of all the strings. The numbers are unsigned 64 bit integers in the byte order of the
+ * 	machine writing them. The table lets every string be found without reading the ones before it.
+ * COMPLEXITY: O(N + n) where N is the total length of the strings.
+ * @param arr
+ * @param n
+ * @param stream a binary stream
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringArraySerialize(MyString** arr, size_t n, FILE *stream)
+{
+	COUNT_CALL(myStringArraySerialize);
+	if (stream == NULL || !validArray(arr, n) || !expandArray(arr, n))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	uint64_t count = n, offset = 0;
+	bool success = fwrite(ARRAY_MAGIC, 1, ARRAY_MAGIC_LENGTH, stream) == ARRAY_MAGIC_LENGTH &&
+				   fwrite(&count, sizeof(count), 1, stream) == 1 &&
+				   fwrite(&offset, sizeof(offset), 1, stream) == 1;
+	size_t i;
+
+	for (i = 0; i < n && success; i++)
+	{
+		offset += arr[i]->_length;
+		success = fwrite(&offset, sizeof(offset), 1, stream) == 1;
+	}
+	for (i = 0; i < n && success; i++)
+	{
+		success = arr[i]->_length == 0 ||
+				  fwrite(arr[i]->_string, 1, arr[i]->_length, stream) == arr[i]->_length;
+	}
+
+	return success ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+}
+
+/**
+ * @brief Checks the header and the offsets of a file mapped by myStringArrayLoad.
+ * @param map the mapped file
+ * @param size the size of the file
+ * @param len set to the number of strings in the file
+ * @return true if the file is in the format of myStringArraySerialize, false otherwise.
+ */
+static bool validArrayFile(const char* map, size_t size, size_t* len)
+{
+	uint64_t count;
+	if (size < ARRAY_HEADER_SIZE || memcmp(map, ARRAY_MAGIC, ARRAY_MAGIC_LENGTH) != 0)
+	{
+		return false;
+	}
+	memcpy(&count, map + ARRAY_MAGIC_LENGTH, sizeof(count));
+	if (count >= (size - ARRAY_HEADER_SIZE) / sizeof(uint64_t))
+	{
+		return false;
+	}
+
+	// The offsets are aligned, since the header is and the map starts at a page
+	const uint64_t* offsets = (const uint64_t*)(map + ARRAY_HEADER_SIZE);
+	size_t charsSize = size - ARRAY_HEADER_SIZE - (count + 1) * sizeof(uint64_t);
+	size_t i;
+
+	if (offsets[0] != 0 || offsets[count] != charsSize)
+	{
+		return false;
+	}
+	for (i = 0; i < count; i++)
+	{
+		if (offsets[i] > offsets[i + 1])
+		{
+			return false;
+		}
+	}
+
+	*len = (size_t)count;
+	return true;
+}
+
+/**
+ * @brief Maps the file fileName, written by myStringArraySerialize, to memory, and makes a frozen
+ * 	MyString for every string in it. The chars of the strings are not read or copied: the
+ * 	MyStrings point to the mapped file, which the system reads when they are used.
+ * 	The MyStrings can be used like other frozen MyStrings (e.g. compared, sorted, cloned or
+ * 	inserted to a MyStringHashSet) until the array is freed. They belong to the array, so
+ * 	myStringFree does nothing to them, and myStringCStr returns NULL for them.
+ * 	It is the caller's responsibility to free the returned MyStringArray.
+ * COMPLEXITY: O(n) where n is the number of strings, because the offsets are checked and a
+ * 			   MyString is set for each of them. The length of the strings doesn't matter.
+ * @param fileName
+ * RETURN VALUE:
+ *  @return a pointer to the array, or NULL if the file can't be mapped or isn't in the format of
+ *  myStringArraySerialize.
+ */
+MyStringArray * myStringArrayLoad(const char *fileName)
+{
+	COUNT_CALL(myStringArrayLoad);
+	if (fileName == NULL)
+	{
+		return NULL;
+	}
+
+	int fd = open(fileName, O_RDONLY);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+
+	struct stat fileStat;
+	void* map = MAP_FAILED;
+	size_t size = 0;
+	if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0 &&
+		(uintmax_t)fileStat.st_size <= SIZE_MAX)
+	{
+		size = (size_t)fileStat.st_size;
+		map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	// The mapping stays valid after the file is closed
+	close(fd);
+
+	size_t len, i;
+	if (map == MAP_FAILED || !validArrayFile((const char*)map, size, &len))
+	{
+		if (map != MAP_FAILED)
+		{
+			munmap(map, size);
+		}
+		return NULL;
+	}
+
+	MyStringArray* array = (MyStringArray*)allocBytes(sizeof(MyStringArray));
+	MyString* views = (MyString*)allocBytes(len * sizeof(MyString));
+	MyString** strings = (MyString**)allocBytes(len * sizeof(MyString*));
+	if (array == NULL || views == NULL || strings == NULL)
+	{
+		freeBytes(array, sizeof(MyStringArray));
+		freeBytes(views, len * sizeof(MyString));
+		freeBytes(strings, len * sizeof(MyString*));
+		munmap(map, size);
+		return NULL;
+	}
+
+	const uint64_t* offsets = (const uint64_t*)((char*)map + ARRAY_HEADER_SIZE);
+	char* chars = (char*)(offsets + len + 1);
+	for (i = 0; i < len; i++)
+	{
+		// The strings are read-only, but they are frozen so nothing writes to them
+		views[i]._string = chars + offsets[i];
+		views[i]._length = (size_t)(offsets[i + 1] - offsets[i]);
+		views[i]._capacity = views[i]._length;
+		views[i]._frozen = true;
+		views[i]._refCount = 1;
+		views[i]._hash = 0;
+		views[i]._borrowed = true;
+		views[i]._compressed = false;
+		views[i]._utf8 = UTF8_UNKNOWN;
+		strings[i] = &views[i];
+	}
+
+	array->_map = map;
+	array->_mapSize = size;
+	array->_len = len;
+	array->_views = views;
+	array->_strings = strings;
+	return array;
+}
+
+/**
+ * @brief Unmaps the file of array, and frees its MyStrings.
+ * COMPLEXITY: O(1)
+ * @param array If NULL, no operation is performed.
+ */
+void myStringArrayFree(MyStringArray *array)
+{
+	COUNT_CALL(myStringArrayFree);
+	if (array != NULL)
+	{
+		munmap(array->_map, array->_mapSize);
+		freeBytes(array->_views, array->_len * sizeof(MyString));
+		freeBytes(array->_strings, array->_len * sizeof(MyString*));
+		freeBytes(array, sizeof(MyStringArray));
+	}
+}
+
+/**
+ * @return the number of MyStrings in array, or 0 if array is NULL.
+ */
+size_t myStringArrayLen(const MyStringArray *array)
+{
+	COUNT_CALL(myStringArrayLen);
+	return array == NULL ? 0 : array->_len;
+}
+
+/**
+ * @brief Returns the MyStrings of array, in the order they were written. The pointers may be
+ * 	reordered (e.g. by myStringSort), and are valid until the array is freed.
+ * COMPLEXITY: O(1)
+ * @param array
+ * RETURN VALUE:
+ *  @return the array of myStringArrayLen(array) MyString pointers, or NULL if array is NULL.
+ */
+MyString ** myStringArrayStrings(MyStringArray *array)
+{
+	COUNT_CALL(myStringArrayStrings);
+	return array == NULL ? NULL : array->_strings;
+}
+
+/**
+ * @brief Makes room for n more chars in the buffer of builder, at least doubling it if it grows.
+ * @param builder
+ * @param n
+ * @return true on success, false if the allocation failed (and builder is not changed).
+ */
+static bool reserveBuilder(MyStringBuilder* builder, size_t n)
+{
+	if (builder->_capacity - builder->_length >= n)
+	{
+		return true;
+	}
+	if (n > SIZE_MAX / 2 - builder->_length)
+	{
+		return false;
+	}
+
+	size_t capacity = 2 * builder->_capacity;
+	if (capacity < builder->_length + n)
+	{
+		capacity = builder->_length + n;
+	}
+	if (capacity < MIN_BUILDER_CAPACITY)
+	{
+		capacity = MIN_BUILDER_CAPACITY;
+	}
+
+	char* string = builder->_string == NULL ? (char*)allocBytes(capacity * sizeof(char)) :
+				   (char*)reallocBytes(builder->_string, builder->_capacity, capacity * sizeof(char));
+	if (string == NULL)
+	{
+		return false;
+	}
+	builder->_string = string;
+	builder->_capacity = capacity;
+	return true;
+}
+
+/**
+ * @brief Appends n chars to builder.
+ * @param builder
+ * @param chars
+ * @param n
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal appendChars(MyStringBuilder* builder, const char* chars, size_t n)
+{
+	if (!reserveBuilder(builder, n))
+	{
+		return MYSTRING_ERROR;
+	}
+	copyBytes(builder->_string + builder->_length, chars, n);
+	builder->_length += n;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Allocates a new empty MyStringBuilder with room for capacity chars. It is the caller's
+ * 	responsibility to free the returned MyStringBuilder.
+ * COMPLEXITY: O(1)
+ * @param capacity the number of chars to allocate, 0 to allocate on the first append
+ * RETURN VALUE:
+ *  @return a pointer to the new builder, or NULL if the allocation failed.
+ */
+MyStringBuilder * myStringBuilderAlloc(size_t capacity)
+{
+	COUNT_CALL(myStringBuilderAlloc);
+	MyStringBuilder* builder = (MyStringBuilder*)allocBytes(sizeof(MyStringBuilder));
+	if (builder == NULL)
+	{
+		return NULL;
+	}
+
+	builder->_string = NULL;
+	builder->_length = 0;
+	builder->_capacity = 0;
+	if (capacity > 0)
+	{
+		builder->_string = (char*)allocBytes(capacity * sizeof(char));
+		if (builder->_string == NULL)
+		{
+			freeBytes(builder, sizeof(MyStringBuilder));
+			return NULL;
+		}
+		builder->_capacity = capacity;
+	}
+
+	return builder;
+}
+
+/**
+ * @brief Frees the memory allocated to builder.
+ * COMPLEXITY: O(1)
+ * @param builder If NULL, no operation is performed.
+ */
+void myStringBuilderFree(MyStringBuilder *builder)
+{
+	COUNT_CALL(myStringBuilderFree);
+	if (builder != NULL)
+	{
+		freeBytes(builder->_string, builder->_capacity);
+		freeBytes(builder, sizeof(MyStringBuilder));
+	}
+}
+
+/**
+ * @brief Empties builder, keeping its buffer for the next appends.
+ * COMPLEXITY: O(1)
+ * @param builder
+ */
+void myStringBuilderReset(MyStringBuilder *builder)
+{
+	COUNT_CALL(myStringBuilderReset);
+	if (builder != NULL)
+	{
+		builder->_length = 0;
+	}
+}
+
+/**
+ * @return the number of chars appended to builder, or 0 if builder is NULL.
+ */
+unsigned long myStringBuilderLen(const MyStringBuilder *builder)
+{
+	COUNT_CALL(myStringBuilderLen);
+	return builder == NULL ? 0 : builder->_length;
+}
+
+/**
+ * @brief Appends the char ch to builder.
+ * COMPLEXITY: O(1) amortized, since the buffer at least doubles when it grows.
+ * @param builder
+ * @param ch
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderAppendChar(MyStringBuilder *builder, char ch)
+{
+	COUNT_CALL(myStringBuilderAppendChar);
+	if (builder == NULL || !reserveBuilder(builder, 1))
+	{
+		return MYSTRING_ERROR;
+	}
+	builder->_string[builder->_length++] = ch;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Appends the C string cString, terminated by the null character, to builder.
+ * COMPLEXITY: O(N) amortized, where N is the length of cString.
+ * @param builder
+ * @param cString
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderAppendCString(MyStringBuilder *builder, const char *cString)
+{
+	COUNT_CALL(myStringBuilderAppendCString);
+	if (builder == NULL || cString == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+	return appendChars(builder, cString, strlen(cString));
+}
+
+/**
+ * @brief Appends the value of str to builder.
+ * COMPLEXITY: O(N) amortized, where N is the length of str.
+ * @param builder
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderAppendMyString(MyStringBuilder *builder, const MyString *str)
+{
+	COUNT_CALL(myStringBuilderAppendMyString);
+	if (builder == NULL || str == NULL || !expandString(str))
+	{
+		return MYSTRING_ERROR;
+	}
+	return appendChars(builder, str->_string, str->_length);
+}
+
+/**
+ * @brief Appends the integer n to builder, like myStringSetFromInt.
+ * COMPLEXITY: O(N) amortized, where N is the number of digits of n.
+ * @param builder
+ * @param n
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderAppendInt(MyStringBuilder *builder, int n)
+{
+	COUNT_CALL(myStringBuilderAppendInt);
+	size_t length = getIntLength(n);
+	if (builder == NULL || !reserveBuilder(builder, length))
+	{
+		return MYSTRING_ERROR;
+	}
+	writeInt(builder->_string + builder->_length, n, length);
+	builder->_length += length;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Appends the double x to builder, formatted like printf's "%g".
+ * COMPLEXITY: O(1) amortized, since "%g" has at most MAX_DOUBLE_LENGTH chars.
+ * @param builder
+ * @param x
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderAppendDouble(MyStringBuilder *builder, double x)
+{
+	COUNT_CALL(myStringBuilderAppendDouble);
+	// snprintf writes a null character after the chars, so there must be room for it too
+	if (builder == NULL || !reserveBuilder(builder, MAX_DOUBLE_LENGTH + 1))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	int written = snprintf(builder->_string + builder->_length, MAX_DOUBLE_LENGTH + 1, "%g", x);
+	if (written < 0 || written > MAX_DOUBLE_LENGTH)
+	{
+		return MYSTRING_ERROR;
+	}
+	builder->_length += (size_t)written;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Appends the arguments formatted by format (like printf()) to builder. The chars are
+ * 	formatted directly into the buffer of builder, which grows and formats them again only if
+ * 	they don't fit in it.
+ * COMPLEXITY: O(N) amortized, where N is the number of chars formatted.
+ * @param builder
+ * @param format
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and builder is not changed).
+ */
+MyStringRetVal myStringBuilderAppendf(MyStringBuilder *builder, const char *format, ...)
+{
+	COUNT_CALL(myStringBuilderAppendf);
+	if (builder == NULL || format == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	va_list args;
+	va_list argsCopy;
+	va_start(args, format);
+	va_copy(argsCopy, args);
+
+	// The room left includes the char vsnprintf uses for the null character
+	size_t room = builder->_capacity - builder->_length;
+	int written = vsnprintf(builder->_string == NULL ? NULL : builder->_string + builder->_length,
+							room, format, args);
+	if (written >= 0 && (size_t)written >= room)
+	{
+		written = reserveBuilder(builder, (size_t)written + 1) ?
+				  vsnprintf(builder->_string + builder->_length, (size_t)written + 1, format,
+							argsCopy) : -1;
+	}
+	va_end(argsCopy);
+	va_end(args);
+
+	if (written < 0)
+	{
+		return MYSTRING_ERROR;
+	}
+	builder->_length += (size_t)written;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Sets the value of str to the chars appended to builder, and resets builder.
+ * 	The buffer of builder is handed to str without copying it, and builder takes the old string
+ * 	of str as its buffer, so building into the same MyString again and again doesn't allocate
+ * 	once the buffers are big enough.
+ * COMPLEXITY: O(1)
+ * @param builder
+ * @param str the MyString to set
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderBuild(MyStringBuilder *builder, MyString *str)
+{
+	COUNT_CALL(myStringBuilderBuild);
+	// A builder that never allocated has no buffer, but str must still be set to ""
+	if (builder == NULL || !isMutable(str) || !reserveBuilder(builder, 1))
+	{
+		return MYSTRING_ERROR;
+	}
+
+	char* string = str->_string;
+	size_t capacity = str->_capacity;
+
+	str->_string = builder->_string;
+	str->_capacity = builder->_capacity;
+	str->_length = builder->_length;
+	str->_compressed = false;
+	str->_utf8 = UTF8_UNKNOWN;
+	builder->_string = string;
+	builder->_capacity = capacity;
+	builder->_length = 0;
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Sets stats to the statistics of the library, summed over all the threads.
+ * 	Available only if the library is built with MYSTRING_STATS.
+ * COMPLEXITY: O(T) where T is the number of threads that used the library, because the counters
+ * 			   of every thread are summed.
+ * @param stats
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (or if the statistics are not
+ *  available).
+ */
+MyStringRetVal myStringStatsGet(MyStringStats *stats)
+{
+#ifdef MYSTRING_STATS
+	if (stats == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	unsigned long long totals[NUM_OF_STATS];
+	sumStats(totals);
+
+	stats->allocations = totals[STAT_ALLOCATIONS];
+	stats->frees = totals[STAT_FREES];
+	stats->bytesAllocated = totals[STAT_BYTES_ALLOCATED];
+	stats->bytesFreed = totals[STAT_BYTES_FREED];
+	stats->copies = totals[STAT_COPIES];
+	stats->bytesCopied = totals[STAT_BYTES_COPIED];
+	return MYSTRING_SUCCESS;
+#else
+	(void)stats;
+	return MYSTRING_ERROR;
+#endif
+}
+
+/**
+ * @brief Writes the statistics of the library, summed over all the threads, to stream: the
+ * 	counters of myStringStatsGet and the number of calls to every public function.
+ * 	Available only if the library is built with MYSTRING_STATS.
+ * COMPLEXITY: O(T) where T is the number of threads that used the library, because the counters
+ * 			   of every thread are summed.
+ * @param stream
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (or if the statistics are not
+ *  available).
+ */
+MyStringRetVal myStringStatsDump(FILE *stream)
+{
+#ifdef MYSTRING_STATS
+	if (stream == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	unsigned long long totals[NUM_OF_STATS];
+	sumStats(totals);
+
+	int written = fprintf(stream, "allocations %llu\nfrees %llu\nbytesAllocated %llu\n"
+						  "bytesFreed %llu\ncopies %llu\nbytesCopied %llu\n",
+						  totals[STAT_ALLOCATIONS], totals[STAT_FREES],
+						  totals[STAT_BYTES_ALLOCATED], totals[STAT_BYTES_FREED],
+						  totals[STAT_COPIES], totals[STAT_BYTES_COPIED]);
+
+	size_t i;
+	for (i = STAT_CALLS_myStringAlloc; i < NUM_OF_STATS && written >= 0; i++)
+	{
+		if (totals[i] > 0)
+		{
+			written = fprintf(stream, "calls %s %llu\n",
+							  functionNames[i - STAT_CALLS_myStringAlloc], totals[i]);
+		}
+	}
+
+	return written >= 0 ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+#else
+	(void)stream;
+	return MYSTRING_ERROR;
+#endif
+}
+
+// ------------------------------ test ---------------------------------
+
+#ifndef NDEBUG
+
+#include <ctype.h>
+
+#define NUM_OF_READERS 16
+#define READER_ROUNDS 2000
+
+/**
+ * @brief Unit-testing to myStringAlloc()
+ */
+void testMyStringAlloc()
+{
+	printf("Testing myStringAlloc()...\n");
+	printf("Allocating a new empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+
+	if(myString == NULL)
+	{
+		perror("Error in memory allocation.\n");
+	}
+	else
+	{
+		printf("Empty string successfully allocated\n");
+	}
+
+	myStringFree(myString);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringFree()
+ */
+void testMyStringFree()
+{
+	printf("Testing myStringFree()...\n");
+	printf("Allocating a new empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+	printf("Trying to free to memory allocated to myString\n");
+	myStringFree(myString);
+	printf("Memory successfully freed. Setting myString to NULL\n");
+	myString = NULL;
+	printf("Trying to free memory allocated to NULL\n");
+	myStringFree(myString);
+	printf("Nothing happened as needed\n");
+
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringClone()
+ */
+void testMyStringClone()
+{
+	printf("Testing myStringClone()...\n");
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString1 = myStringAlloc();
+	printf("Setting myString to be \"abc\"\n");
+	myStringSetFromCString(myString1, "abc");
+	printf("Cloning myString1 into myString2\n");
+	MyString* myString2 = myStringClone(myString1);
+	if (myString2 == NULL)
+	{
+		perror("Error in memory allocation.\n");
+	}
+	else
+	{
+		char* res = myStringToCString(myString2);
+		printf("Cloning success. myString2 is \"%s\"\n", res);
+		free(res);
+	}
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringSetFromMyString()
+ */
+void testMyStringSetFromMyString()
+{
+	printf("Testing myStringSetFromMyString()...\n");
+
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString1 = myStringAlloc();
+	printf("Setting myString1 to be \"abc\"\n");
+	myStringSetFromCString(myString1, "abc");
+
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString2 = myStringAlloc();
+	printf("Setting myString2 to be \"def\"\n");
+	myStringSetFromCString(myString2, "def");
+
+	if (myStringSetFromMyString(myString2, myString1) == MYSTRING_ERROR)
+	{
+		perror("Error in allocating memory.\n");
+	}
+	else
+	{
+		char* res = myStringToCString(myString2);
+		printf("Success. myString2 = %s\n", res);
+		free(res);
+	}
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+
+	printf("\n");
+}
+
+/**
+ * @brief Used as an argument to myStringFilter() in testMyStringFilter()
+ * @parm pointer to char for filtering
+ * @return true if the given char is filtered, false otherwise.
+ */
+static bool filter(const char* letter)
+{
+	if (*letter == 'b' || *letter == 'g')
+	{
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Unit-testing to myStringFilter()
+ */
+void testMyStringFilter()
+{
+	printf("Testing myStringFilter()...\n");
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString = myStringAlloc();
+	printf("Setting myString to be \"abcbfdgbdfsgjh\"\n");
+	myStringSetFromCString(myString, "abcbfdgbdfsgjh");
+
+	bool (*filt)(const char *);
+	filt = filter;
+
+	int x = myStringFilter(myString, filt);
+
+	if (x == MYSTRING_ERROR)
+	{
+		perror("Error in allocating memory\n");
+	}
+	else
+	{
+		char* str = myStringToCString(myString);
+		printf("Success. myString = %s\n", str);
+		free(str);
+	}
+
+	myStringFree(myString);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringSetFromCString()
+ */
+void testMyStringSetFromCString()
+{
+	printf("Testing myStringSetFromCString()...\n");
+	printf("Allocating empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+	printf("Setting myString1 to \"abc\"\n");
+	char* res = NULL;
+	if (myStringSetFromCString(myString, "abc") == MYSTRING_SUCCESS)
+	{
+		res = myStringToCString(myString);
+		printf("SUCCESS. myString = %s\n", res);
+		free(res);
+	}
+	else
+	{
+		perror("Error allocating memory.");
+	}
+
+	printf("Setting myString to \"def\"\n");
+	if (myStringSetFromCString(myString, "def") == MYSTRING_SUCCESS)
+	{
+		res = myStringToCString(myString);
+		printf("SUCCESS. myString1 = %s\n", res);
+		free(res);
+	}
+	else
+	{
+		perror("Error allocating memory.");
+	}
+
+	myStringFree(myString);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringSetFromBuffer()
+ */
+void testMyStringSetFromBuffer()
+{
+	printf("Testing myStringSetFromBuffer()...\n");
+	printf("Allocating empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+
+	printf("Setting myString to 5 chars with null characters in them\n");
+	bool success = myStringSetFromBuffer(myString, "a\0b\0c", 5) == MYSTRING_SUCCESS &&
+				   myStringLen(myString) == 5 && memcmp(myStringData(myString), "a\0b\0c", 5) == 0;
+	const char* string = myStringData(myString);
+
+	printf("Setting myString to the last 3 chars of its own string\n");
+	success = success && myStringSetFromBuffer(myString, string + 2, 3) == MYSTRING_SUCCESS &&
+			  myStringData(myString) == string && myStringLen(myString) == 3 &&
+			  memcmp(myStringData(myString), "b\0c", 3) == 0;
+	if (success)
+	{
+		printf("SUCCESS. The chars were kept, and the string of myString was reused\n");
+	}
+	else
+	{
+		printf("ERROR in myStringSetFromBuffer()\n");
+	}
+
+	printf("Setting myString from NULL\n");
+	if (myStringSetFromBuffer(myString, NULL, 1) == MYSTRING_ERROR &&
+		myStringSetFromBuffer(myString, NULL, 0) == MYSTRING_SUCCESS && myStringLen(myString) == 0)
+	{
+		printf("Returns error as expected, because of bad argument.\n");
+	}
+	else
+	{
+		printf("ERROR in myStringSetFromBuffer()\n");
+	}
+
+	myStringFree(myString);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringSetFromInt()
+ */
+void testMyStringSetFromInt()
+{
+	printf("Testing myStringSetFromInt()...\n");
+	printf("Allocating a new empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+	char* res = NULL;
+
+	printf("Setting myString to 765\n");
+	if (myStringSetFromInt(myString, 765) == MYSTRING_ERROR)
+	{
+		perror("Error in memory allocation.\n");
+	}
+	else
+	{
+		res = myStringToCString(myString);
+		printf("Success. myString = %s\n", res);
+		free(res);
+	}
+
+	printf("Setting myString to -1385\n");
+	if (myStringSetFromInt(myString, -1385) == MYSTRING_ERROR)
+	{
+		perror("Error in memory allocation.\n");
+	}
+	else
+	{
+		res = myStringToCString(myString);
+		printf("Success. myString = %s\n", res);
+		free(res);
+	}
+
+	printf("Setting myString to 0 and to INT_MIN\n");
+	myStringSetFromInt(myString, 0);
+	res = myStringToCString(myString);
+	if (res != NULL && strcmp(res, "0") == 0)
+	{
+		free(res);
+		myStringSetFromInt(myString, INT_MIN);
+		res = myStringToCString(myString);
+	}
+	if (res != NULL && strcmp(res, "-2147483648") == 0)
+	{
+		printf("Success. myString = %s\n", res);
+	}
+	else
+	{
+		printf("ERROR in myStringSetFromInt()\n");
+	}
+	free(res);
+
+	myStringFree(myString);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringToInt()
+ */
+void testMyStringToInt()
+{
+	printf("Testing myStringSetFromInt()...\n");
+	printf("Allocating a new empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+	printf("Setting myString to 765\n");
+	myStringSetFromInt(myString, 765);
+	int num = myStringToInt(myString);
+	if (num == MYSTR_ERROR_CODE)
+	{
+		perror("Error in function myStringToInt.\n");
+	}
+	else
+	{
+		printf("Success. num = %d\n", num);
+	}
+
+	printf("Setting myString to \"abc\"\n");
+	myStringSetFromCString(myString, "abc");
+	num = myStringToInt(myString);
+	if (num == MYSTR_ERROR_CODE)
+	{
+		printf("Returns error as expected, because of bad argument.\n");
+	}
+	else
+	{
+		perror("ERROR");
+	}
+
+	printf("Parsing INT_MIN, INT_MAX, a number out of range, a sign alone and \"\"\n");
+	myStringSetFromCString(myString, "-2147483648");
+	bool success = myStringToInt(myString) == INT_MIN;
+	myStringSetFromCString(myString, "+2147483647");
+	success = success && myStringToInt(myString) == INT_MAX;
+	myStringSetFromCString(myString, "2147483648");
+	success = success && myStringToInt(myString) == MYSTR_ERROR_CODE;
+	myStringSetFromCString(myString, "-");
+	success = success && myStringToInt(myString) == MYSTR_ERROR_CODE;
+	myStringSetFromCString(myString, "");
+	success = success && myStringToInt(myString) == MYSTR_ERROR_CODE;
+	if (success)
+	{
+		printf("Success. The limits of int are parsed\n");
+	}
+	else
+	{
+		printf("ERROR in myStringToInt()\n");
+	}
+
+	myStringFree(myString);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringToCString()
+ */
+void testMyStringToCString()
+{
+	printf("Testing myStringToCString()...\n");
+
+	printf("Allocating a new empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+	printf("Setting myString to \"abc\"\n");
+	myStringSetFromCString(myString, "abc");
+	char* cString = myStringToCString(myString);
+	if (cString == NULL)
+	{
+		perror("Error in memory allocation.\n");
+	}
+	else
+	{
+		printf("Success. cString = %s\n", cString);
+	}
+
+	free(cString);
+	myStringFree(myString);
+	printf("\n");
+}
+
+/**
+ * @brief Filter of testMyStringCStr(): removes the 'b' chars.
+ * @param ch
+ * @return true if ch is 'b'
+ */
+static bool isB(const char* ch)
+{
+	return *ch == 'b';
+}
+
+/**
+ * @brief Unit-testing to myStringCStr()
+ */
+void testMyStringCStr()
+{
+	printf("Testing myStringCStr()...\n");
+	printf("Allocating a new empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+	bool success = strcmp(myStringCStr(myString), "") == 0 && myStringCStr(NULL) == NULL;
+
+	printf("Setting myString to \"abcb\", and filtering out the 'b' chars\n");
+	myStringSetFromCString(myString, "abcb");
+	long long bytesBefore = myStringLiveBytes();
+	success = success && strcmp(myStringCStr(myString), "abcb") == 0 &&
+			  myStringCStr(myString) == myStringData(myString);
+	myStringFilter(myString, isB);
+	success = success && strcmp(myStringCStr(myString), "ac") == 0 &&
+			  myStringLiveBytes() == bytesBefore;
+	if (success)
+	{
+		printf("Success. myString = %s, in its own string\n", myStringCStr(myString));
+	}
+	else
+	{
+		printf("ERROR in myStringCStr()\n");
+	}
+
+	printf("Adopting a full buffer, and freezing myString\n");
+	char* buf = myStringBufferAlloc(3);
+	memcpy(buf, "xyz", 3);
+	myStringAdoptBuffer(myString, buf, 3, 3);
+	myStringFreeze(myString);
+	if (strcmp(myStringCStr(myString), "xyz") == 0)
+	{
+		printf("Success. The string grew by 1 char when myString was frozen\n");
+	}
+	else
+	{
+		printf("ERROR in myStringCStr()\n");
+	}
+
+	myStringFree(myString);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringCat()
+ */
+void testMyStringCat()
+{
+	printf("Testing myStringToCString()...\n");
+
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString1 = myStringAlloc();
+	printf("Setting myString1 to \"abc\"\n");
+	myStringSetFromCString(myString1, "abc");
+
+	printf("Allocating a new empty MyString to myString2\n");
+	MyString* myString2 = myStringAlloc();
+	printf("Setting myString2 to \"def\"\n");
+	myStringSetFromCString(myString2, "def");
+
+	printf("Appending myString2 to myString1:\n");
+	if(myStringCat(myString1, myString2) == MYSTRING_ERROR)
+	{
+		perror("Error in memory allocation.\n");
+	}
+	else
+	{
+		char* res = myStringToCString(myString1);
+		printf("Success. myString1 = %s\n", res);
+		free(res);
+	}
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringCatTo()
+ */
+void testMyStringCatTo()
+{
+	printf("Testing myStringCatTo()...\n");
+
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString1 = myStringAlloc();
+	printf("Setting myString1 to \"abc\"\n");
+	myStringSetFromCString(myString1, "abc");
+
+	printf("Allocating a new empty MyString to myString2\n");
+	MyString* myString2 = myStringAlloc();
+	printf("Setting myString2 to \"def\"\n");
+	myStringSetFromCString(myString2, "def");
+
+	printf("Allocating a new empty MyString to result\n");
+	MyString* result = myStringAlloc();
+
+	printf("Concatenate myString1 and myString2 into result\n");
+	if(myStringCatTo(myString1, myString2, result) == MYSTRING_ERROR)
+	{
+		perror("Error in memory Allocation.\n");
+	}
+	else
+	{
+		char* res = myStringToCString(result);
+		printf("Success. result = %s\n", res);
+		free(res);
+	}
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	myStringFree(result);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringCatMany()
+ */
+void testMyStringCatMany()
+{
+	printf("Testing myStringCatMany()...\n");
+
+	printf("Allocating myString1 set to \"ab\" and myString2 set to \"-\"\n");
+	MyString* myString1 = myStringAlloc();
+	MyString* myString2 = myStringAlloc();
+	myStringSetFromCString(myString1, "ab");
+	myStringSetFromCString(myString2, "-");
+
+	printf("Concatenate myString1, myString2, myString1, myString2 and myString1 into myString1\n");
+	const MyString* parts[] = {myString1, myString2, myString1, myString2, myString1};
+	bool success = myStringCatMany(myString1, parts, 5) == MYSTRING_SUCCESS &&
+				   myStringLen(myString1) == 8 && memcmp(myStringData(myString1), "ab-ab-ab", 8) == 0;
+	if (success)
+	{
+		printf("Success. myString1 = ab-ab-ab\n");
+	}
+	else
+	{
+		printf("ERROR in myStringCatMany()\n");
+	}
+
+	printf("Concatenate a NULL part into myString1\n");
+	parts[1] = NULL;
+	if (myStringCatMany(myString1, parts, 2) == MYSTRING_ERROR && myStringLen(myString1) == 8)
+	{
+		printf("Returns error as expected, because of bad argument.\n");
+	}
+	else
+	{
+		printf("ERROR in myStringCatMany()\n");
+	}
+
+	printf("Concatenate no parts into myString2\n");
+	if (myStringCatMany(myString2, NULL, 0) == MYSTRING_SUCCESS && myStringLen(myString2) == 0)
+	{
+		printf("Success. myString2 is empty\n");
+	}
+	else
+	{
+		printf("ERROR in myStringCatMany()\n");
+	}
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringMove(), myStringSwap(), myStringAdoptBuffer() and
+ * 		  myStringReleaseBuffer()
+ */
+void testMyStringMove()
+{
+	printf("Testing myStringMove(), myStringSwap() and the buffer functions...\n");
+
+	printf("Allocating myString1 set to \"abc\" and myString2 set to \"de\"\n");
+	MyString* myString1 = myStringAlloc();
+	MyString* myString2 = myStringAlloc();
+	myStringSetFromCString(myString1, "abc");
+	myStringSetFromCString(myString2, "de");
+	const char* string1 = myStringData(myString1);
+
+	printf("Swapping myString1 and myString2, and moving myString2 to myString1\n");
+	bool success = myStringSwap(myString1, myString2) == MYSTRING_SUCCESS &&
+				   myStringData(myString2) == string1 &&
+				   myStringMove(myString1, myString2) == MYSTRING_SUCCESS &&
+				   myStringData(myString1) == string1 && myStringLen(myString1) == 3 &&
+				   myStringData(myString2) == NULL && myStringLen(myString2) == 0;
+	if (success)
+	{
+		printf("Success. myString1 has the string of \"abc\" without copying it\n");
+	}
+	else
+	{
+		printf("ERROR in myStringMove()\n");
+	}
+
+	printf("Releasing the string of myString1 and adopting it in myString2\n");
+	size_t len = 0, capacity = 0;
+	char* buf = myStringReleaseBuffer(myString1, &len, &capacity);
+	success = buf == string1 && len == 3 && myStringData(myString1) == NULL &&
+			  myStringAdoptBuffer(myString2, buf, 2, capacity) == MYSTRING_SUCCESS &&
+			  myStringLen(myString2) == 2 && memcmp(myStringData(myString2), "ab", 2) == 0;
+	if (success)
+	{
+		printf("Success. myString2 = ab\n");
+	}
+	else
+	{
+		printf("ERROR in myStringReleaseBuffer()\n");
+	}
+
+	printf("Adopting a new buffer in myString1, and moving to a frozen MyString\n");
+	buf = myStringBufferAlloc(4);
+	memcpy(buf, "wxyz", 4);
+	myStringFreeze(myString2);
+	success = myStringAdoptBuffer(myString1, buf, 5, 4) == MYSTRING_ERROR &&
+			  myStringAdoptBuffer(myString1, buf, 4, 4) == MYSTRING_SUCCESS &&
+			  myStringMove(myString2, myString1) == MYSTRING_ERROR &&
+			  myStringSwap(myString1, myString2) == MYSTRING_ERROR &&
+			  myStringReleaseBuffer(myString2, &len, &capacity) == NULL &&
+			  myStringLen(myString1) == 4 && myStringLen(myString2) == 2;
+	if (success)
+	{
+		printf("Returns error as expected, because of bad argument.\n");
+	}
+	else
+	{
+		printf("ERROR in myStringAdoptBuffer()\n");
+	}
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringCompare()
+ */
+void testMyStringCompare()
+{
+	printf("Testing myStringCompare()...\n");
+
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString1 = myStringAlloc();
+	printf("Setting myString1 to \"abc\"\n");
+	myStringSetFromCString(myString1, "abc");
+
+	printf("Allocating a new empty MyString to myString2\n");
+	MyString* myString2 = myStringAlloc();
+	printf("Setting myString2 to \"def\"\n");
+	myStringSetFromCString(myString2, "def");
+
+	int compare = myStringCompare(myString1, myString2);
+
+	if (compare == MYSTR_ERROR_CODE)
+	{
+		perror("Error in myStringCompare()\n");
+	}
+	else if (compare > 0)
+	{
+		printf("myString1 is bigger then myString2\n");
+	}
+	else if (compare < 0)
+	{
+		printf("myString2 is bigger then myString1\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+
+	printf("Setting myString2 to \"abc\"\n");
+	myStringSetFromCString(myString2, "abc");
+
+	compare = myStringCompare(myString1, myString2);
+
+	if (compare == MYSTR_ERROR_CODE)
+	{
+		perror("Error in myStringCompare()\n");
+	}
+	else if (compare > 0)
+	{
+		printf("myString1 is bigger then myString2\n");
+	}
+	else if (compare < 0)
+	{
+		printf("myString2 is bigger then myString1\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+
+	printf("Setting myString2 to NULL\n");
+	freeString(myString2);
+	myString2->_string = NULL;
+
+	compare = myStringCompare(myString1, myString2);
+
+	if (compare == MYSTR_ERROR_CODE)
+	{
+		perror("ERROR as expected, because and compare\n");
+	}
+	else if (compare > 0)
+	{
+		printf("myString1 is bigger then myString2\n");
+	}
+	else if (compare < 0)
+	{
+		printf("myString2 is bigger then myString1\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringCustomCompare()
+ */
+void testMyStringCustomCompare()
+{
+	printf("Testing myStringCustomCompare()...\n");
+
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString1 = myStringAlloc();
+	printf("Setting myString1 to \"abc\"\n");
+	myStringSetFromCString(myString1, "abc");
+
+	printf("Allocating a new empty MyString to myString2\n");
+	MyString* myString2 = myStringAlloc();
+	printf("Setting myString2 to \"def\"\n");
+	myStringSetFromCString(myString2, "def");
+
+	int (*comparator)(const char, const char);
+	comparator = defaultComparator;
+
+	int compare = myStringCustomCompare(myString1, myString2, comparator);
+
+	if (compare == MYSTR_ERROR_CODE)
+	{
+		perror("ERROR in myStringCustomCompare()\n");
+	}
+	else if (compare > 0)
+	{
+		printf("myString1 is bigger then myString2\n");
+	}
+	else if (compare < 0)
+	{
+		printf("myString2 is bigger then myString1\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+
+	printf("Setting myString2 to \"abc\"\n");
+	myStringSetFromCString(myString2, "abc");
+
+	compare = myStringCustomCompare(myString1, myString2, comparator);
+
+	if (compare == MYSTR_ERROR_CODE)
+	{
+		perror("ERROR in myStringCustomCompare()\n");
+	}
+	else if (compare > 0)
+	{
+		printf("myString1 is bigger then myString2\n");
+	}
+	else if (compare < 0)
+	{
+		printf("myString2 is bigger then myString1\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+
+	printf("Setting myString2 to NULL\n");
+	freeString(myString2);
+	myString2->_string = NULL;
+
+	compare = myStringCustomCompare(myString1, myString2, comparator);
+
+	if (compare == MYSTR_ERROR_CODE)
+	{
+		perror("ERROR as expected, because and compare\n");
+	}
+	else if (compare > 0)
+	{
+		printf("myString1 is bigger then myString2\n");
+	}
+	else if (compare < 0)
+	{
+		printf("myString2 is bigger then myString1\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringEqual()
+ */
+void testMyStringEqual()
+{
+	printf("Testing myStringEqual()...\n");
+
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString1 = myStringAlloc();
+	printf("Setting myString1 to \"abc\"\n");
+	myStringSetFromCString(myString1, "abc");
+
+	printf("Allocating a new empty MyString to myString2\n");
+	MyString* myString2 = myStringAlloc();
+	printf("Setting myString2 to \"def\"\n");
+	myStringSetFromCString(myString2, "def");
+
+	int equal = myStringEqual(myString1, myString2);
+	if (equal == MYSTR_ERROR_CODE)
+	{
+		perror ("ERROR in myStringEqual()\n");
+	}
+	else if (equal > 0)
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are not equal\n");
+	}
+
+	printf("Setting myString2 to \"abc\"\n");
+	myStringSetFromCString(myString2, "abc");
+
+	equal = myStringEqual(myString1, myString2);
+	if (equal == MYSTR_ERROR_CODE)
+	{
+		perror ("ERROR in myStringEqual()\n");
+	}
+	else if (equal > 0)
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are not equal\n");
+	}
+
+	printf("Setting myString2 to NULL\n");
+	freeString(myString2);
+	myString2->_string = NULL;
+
+	equal = myStringEqual(myString1, myString2);
+	if (equal == MYSTR_ERROR_CODE)
+	{
+		perror ("ERROR as expected because can't compare\n");
+	}
+	else if (equal > 0)
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are not equal\n");
+	}
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringCustomEqual()
+ */
+void testMyStringCustomEqual()
+{
+	printf("Testing myStringCustomEqual()...\n");
+
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString1 = myStringAlloc();
+	printf("Setting myString1 to \"abc\"\n");
+	myStringSetFromCString(myString1, "abc");
+
+	printf("Allocating a new empty MyString to myString2\n");
+	MyString* myString2 = myStringAlloc();
+	printf("Setting myString2 to \"def\"\n");
+	myStringSetFromCString(myString2, "def");
+
+	int (*comparator)(const char, const char);
+	comparator = defaultComparator;
+
+	int equal = myStringCustomEqual(myString1, myString2, comparator);
+	if (equal == MYSTR_ERROR_CODE)
+	{
+		perror ("ERROR in myStringCustomEqual\n");
+	}
+	else if (equal > 0)
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are not equal\n");
+	}
+
+	printf("Setting myString2 to \"abc\"\n");
+	myStringSetFromCString(myString2, "abc");
+
+	equal = myStringCustomEqual(myString1, myString2, comparator);
+	if (equal == MYSTR_ERROR_CODE)
+	{
+		perror ("ERROR in myStringCustomEqual\n");
+	}
+	else if (equal > 0)
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are not equal\n");
+	}
+
+	printf("Setting myString2 to NULL\n");
+	freeString(myString2);
+	myString2->_string = NULL;
+
+	equal = myStringCustomEqual(myString1, myString2, comparator);
+	if (equal == MYSTR_ERROR_CODE)
+	{
+		perror("ERROR as expected\n");
+	}
+	else if (equal > 0)
+	{
+		printf("myString1 and myString2 are equal\n");
+	}
+	else
+	{
+		printf("myString1 and myString2 are not equal\n");
+	}
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringMemUsage()
+ */
+void testMyStringMemUsage()
+{
+	printf("Testing myStringMemUsage()...\n");
+
+	printf("Allocating a new empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+	printf("Setting myString to \"abc\"\n");
+	myStringSetFromCString(myString, "abc");
+
+	unsigned long memory = myStringMemUsage(myString);
+
+	printf("Memory usage of myString: %lu", memory);
+
+	myStringFree(myString);
+	printf("\n");
+}
+
+/**
+ * @brief Worker thread of testMyStringMemInfo(). Allocates a MyString, to be freed by the creating
+ * 		  thread.
+ * @param arg the place of the MyString pointer
+ * @return NULL
+ */
+static void* gaugesWorker(void* arg)
+{
+	*(MyString**)arg = myStringAlloc();
+	return NULL;
+}
+
+/**
+ * @return the number of ThreadGauges ever allocated.
+ */
+static size_t countThreadGauges()
+{
+	size_t count = 0;
+	ThreadGauges* gauges;
+
+	for (gauges = __atomic_load_n(&allGauges, __ATOMIC_ACQUIRE); gauges != NULL;
+		 gauges = gauges->_next)
+	{
+		count++;
+	}
+	return count;
+}
+
+/**
+ * @brief Unit-testing to myStringMemInfo(), myStringLiveBytes() and myStringLiveObjects()
+ */
+void testMyStringMemInfo()
+{
+	printf("Testing myStringMemInfo()...\n");
+
+	long long bytesBefore = myStringLiveBytes(), objectsBefore = myStringLiveObjects();
+
+	printf("Allocating a new empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+	printf("Setting myString to \"abc\" and freezing it with 2 references\n");
+	myStringSetFromCString(myString, "abc");
+	myStringFreeze(myString);
+	myStringRetain(myString);
+
+	MyStringMemInfo info;
+	if (myStringMemInfo(myString, &info) == MYSTRING_SUCCESS && info.length == 3 &&
+		info.capacity == 4 && info.references == 2 && info.objectBytes >= sizeof(MyString) &&
+		myStringMemUsage(myString) == info.objectBytes + info.stringBytes)
+	{
+		printf("Success. myString takes %lu bytes and %lu bytes for its string\n",
+			   info.objectBytes, info.stringBytes);
+	}
+	else
+	{
+		printf("ERROR in myStringMemInfo()\n");
+	}
+
+	if (myStringLiveObjects() - objectsBefore == 1 &&
+		myStringLiveBytes() - bytesBefore == (long long)myStringMemUsage(myString))
+	{
+		printf("Success. The gauges count myString\n");
+	}
+	else
+	{
+		printf("ERROR in myStringLiveBytes()\n");
+	}
+
+	myStringFree(myString);
+	myStringFree(myString);
+
+	if (myStringLiveObjects() == objectsBefore && myStringLiveBytes() == bytesBefore)
+	{
+		printf("Success. The gauges are back after freeing myString\n");
+	}
+	else
+	{
+		printf("ERROR in myStringLiveObjects()\n");
+	}
+
+	printf("Allocating a MyString in %d threads, one after the other, and freeing them here\n",
+		   NUM_OF_READERS);
+	MyString* arr[NUM_OF_READERS];
+	size_t numOfGauges = countThreadGauges();
+	bool success = true;
+	int i;
+
+	for (i = 0; i < NUM_OF_READERS; i++)
+	{
+		pthread_t worker;
+		arr[i] = NULL;
+		success = success && pthread_create(&worker, NULL, gaugesWorker, &arr[i]) == 0 &&
+				  pthread_join(worker, NULL) == 0;
+	}
+	success = success && myStringLiveObjects() - objectsBefore == NUM_OF_READERS;
+	for (i = 0; i < NUM_OF_READERS; i++)
+	{
+		myStringFree(arr[i]);
+	}
+
+	// Every thread gets the gauges of the one that exited before it
+	if (success && countThreadGauges() <= numOfGauges + 1 &&
+		myStringLiveObjects() == objectsBefore && myStringLiveBytes() == bytesBefore)
+	{
+		printf("Success. The threads shared one set of gauges, and they are back\n");
+	}
+	else
+	{
+		printf("ERROR in myStringLiveObjects()\n");
+	}
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringLen()
+ */
+void testMyStringLen()
+{
+	printf("Testing myStringLen()...\n");
+
+	printf("Allocating a new empty MyString to myString2\n");
+	MyString* myString = myStringAlloc();
+	printf("Setting myString to \"abc\"\n");
+	myStringSetFromCString(myString, "abc");
+
+	unsigned long len = myStringLen(myString);
+
+	printf("Length of myString: %lu", len);
+
+	myStringFree(myString);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringWrite()
+ */
+void testMyStringWrite()
+{
+	printf("Testing myStringWrite()...\n");
+
+	printf("Allocating a new empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+	printf("Setting myString to \"abc\"\n");
+	myStringSetFromCString(myString, "abc");
+
+	FILE* stream = fopen("testWrite.txt", "w");
+
+	if (myStringWrite(myString, stream) == MYSTRING_SUCCESS)
+	{
+		printf("Wrote myString to  test.txt successfully\n");
+	}
+	else
+	{
+		printf("ERROR\n");
+	}
+
+	fclose(stream);
+	myStringFree(myString);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringCustomSort()
+ */
+void testMyStringCustomSort()
+{
+	printf("Testing myStringCustomSort()...\n");
+
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString1 = myStringAlloc();
+	printf("Setting myString to \"abb\"\n");
+	myStringSetFromCString(myString1, "abb");
+
+	printf("Allocating a new empty MyString to myString2\n");
+	MyString* myString2 = myStringAlloc();
+	printf("Setting myString to \"aab\"\n");
+	myStringSetFromCString(myString2, "aab");
+
+	printf("Allocating a new empty MyString to myString3\n");
+	MyString* myString3 = myStringAlloc();
+	printf("Setting myString to \"bbb\"\n");
+	myStringSetFromCString(myString3, "bbb");
+
+	printf("Allocating a new empty MyString to myString4\n");
+	MyString* myString4 = myStringAlloc();
+	printf("Setting myString to \"aaa\"\n");
+	myStringSetFromCString(myString4, "aaa");
+
+	MyString* arr[] = {myString1, myString2, myString3, myString4};
+
+	myStringCustomSort(arr, 4, myStringComparatorCasting);
+
+	int i;
+	FILE* stream = fopen("testSort.txt", "w");
+
+	for (i = 0; i < 4; i++)
+	{
+		myStringWrite(arr[i], stream);
+	}
+
+	printf("Sorting success. Results in testSort.txt.\n");
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	myStringFree(myString3);
+	myStringFree(myString4);
+	fclose(stream);
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringSort()
+ */
+void testMyStringSort()
+{
+	printf("Testing myStringSort()...\n");
+
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString1 = myStringAlloc();
+	printf("Setting myString to \"abb\"\n");
+	myStringSetFromCString(myString1, "abb");
+
+	printf("Allocating a new empty MyString to myString2\n");
+	MyString* myString2 = myStringAlloc();
+	printf("Setting myString to \"aab\"\n");
+	myStringSetFromCString(myString2, "aab");
+
+	printf("Allocating a new empty MyString to myString3\n");
+	MyString* myString3 = myStringAlloc();
+	printf("Setting myString to \"bbb\"\n");
+	myStringSetFromCString(myString3, "bbb");
+
+	printf("Allocating a new empty MyString to myString4\n");
+	MyString* myString4 = myStringAlloc();
+	printf("Setting myString to \"aaa\"\n");
+	myStringSetFromCString(myString4, "aaa");
+
+	MyString* arr[] = {myString1, myString2, myString3, myString4};
+
+	myStringSort(arr, 4);
+
+	int i;
+	FILE* stream = fopen("test2Sort.txt", "w");
+
+	for (i = 0; i < 4; i++)
+	{
+		myStringWrite(arr[i], stream);
+	}
+
+	printf("Sorting success. Results in testSort.txt.\n");
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	myStringFree(myString3);
+	myStringFree(myString4);
+	fclose(stream);
+	printf("\n");
+}
+
+/**
+ * Case insensitive comparator used by testMyStringDefineComparator()
+ */
+MYSTRING_DEFINE_COMPARATOR(caseless, tolower((unsigned char)ch1) - tolower((unsigned char)ch2))
+
+/**
+ * @brief Unit-testing to MYSTRING_DEFINE_COMPARATOR
+ */
+void testMyStringDefineComparator()
+{
+	printf("Testing MYSTRING_DEFINE_COMPARATOR...\n");
+
+	printf("Allocating a new empty MyString to myString1\n");
+	MyString* myString1 = myStringAlloc();
+	printf("Setting myString1 to \"aBc\"\n");
+	myStringSetFromCString(myString1, "aBc");
+
+	printf("Allocating a new empty MyString to myString2\n");
+	MyString* myString2 = myStringAlloc();
+	printf("Setting myString2 to \"ABC\"\n");
+	myStringSetFromCString(myString2, "ABC");
+
+	printf("Allocating a new empty MyString to myString3\n");
+	MyString* myString3 = myStringAlloc();
+	printf("Setting myString3 to \"Ab\"\n");
+	myStringSetFromCString(myString3, "Ab");
+
+	if (caselessEqual(myString1, myString2) > 0 && myStringEqual(myString1, myString2) == 0)
+	{
+		printf("Success. myString1 and myString2 are equal when ignoring case\n");
+	}
+	else
+	{
+		printf("ERROR in caselessEqual()\n");
+	}
+
+	if (caselessCompare(myString3, myString1) < 0 && caselessCompare(myString2, myString3) > 0)
+	{
+		printf("Success. myString3 is smaller then myString1 and myString2\n");
+	}
+	else
+	{
+		printf("ERROR in caselessCompare()\n");
+	}
+
+	MyString* arr[] = {myString1, myString3, myString2};
+	caselessSort(arr, 3);
+
+	if (arr[0] == myString3 && caselessEqual(arr[1], arr[2]) > 0)
+	{
+		printf("Sorting success. myString3 is first\n");
+	}
+	else
+	{
+		printf("ERROR in caselessSort()\n");
+	}
+
+	printf("Sorting 1000 MyStrings in random case, a never set one and a compressed one\n");
+	MyString* many[1000];
+	char chars[MIN_COMPRESS_LENGTH + 1];
+	bool sorted = true;
+	int i, j;
+	srand(1);
+	for (i = 0; i < 1000; i++)
+	{
+		many[i] = myStringAlloc();
+		for (j = 0; j < 4; j++)
+		{
+			chars[j] = (char)((rand() % 2 ? 'a' : 'A') + rand() % 3);
+		}
+		chars[j] = '\0';
+		if (i > 0)
+		{
+			myStringSetFromCString(many[i], chars);
+		}
+	}
+	memset(chars, 'b', MIN_COMPRESS_LENGTH);
+	chars[MIN_COMPRESS_LENGTH] = '\0';
+	myStringSetFromCString(many[1], chars);
+	myStringCompress(many[1]);
+	MyString* neverSet = many[0];
+	// Sorted in reverse first, so the quicksort partitions have work to do
+	for (i = 0; i < 500; i++)
+	{
+		MyString* temp = many[i];
+		many[i] = many[999 - i];
+		many[999 - i] = temp;
+	}
+
+	caselessSort(many, 1000);
+	for (i = 2; i < 1000 && sorted; i++)
+	{
+		sorted = caselessCompare(many[i - 1], many[i]) <= 0;
+	}
+	if (sorted && many[0] == neverSet && !myStringIsCompressed(many[1]))
+	{
+		printf("Sorting success. The never set MyString is first, and the rest are in order\n");
+	}
+	else
+	{
+		printf("ERROR in caselessSort()\n");
+	}
+	for (i = 0; i < 1000; i++)
+	{
+		myStringFree(many[i]);
+	}
+
+	printf("Setting myString2 to NULL\n");
+	freeString(myString2);
+	myString2->_string = NULL;
+
+	if (caselessCompare(myString1, myString2) == MYSTR_ERROR_CODE)
+	{
+		printf("ERROR as expected, because can't compare\n");
+	}
+	else
+	{
+		printf("ERROR in caselessCompare()\n");
+	}
+
+	myStringFree(myString1);
+	myStringFree(myString2);
+	myStringFree(myString3);
+	printf("\n");
+}
+
+/**
+ * @brief Allocates len MyStrings set to the numbers len - 1 down to 0, used by the sorting tests.
+ * @param arr
+ * @param len
+ */
+static void allocDescendingNumbers(MyString** arr, int len)
+{
+	int i;
+	for (i = 0; i < len; i++)
+	{
+		arr[i] = myStringAlloc();
+		myStringSetFromInt(arr[i], len - 1 - i);
+	}
+}
+
+/**
+ * @brief Unit-testing to myStringPartialSort()
+ */
+void testMyStringPartialSort()
+{
+	printf("Testing myStringPartialSort()...\n");
+
+	printf("Allocating 10 MyStrings set to \"9\" down to \"0\"\n");
+	MyString* arr[10];
+	allocDescendingNumbers(arr, 10);
+
+	printf("Sorting the 3 smallest MyStrings\n");
+	myStringPartialSort(arr, 10, 3);
+
+	if (myStringToInt(arr[0]) == 0 && myStringToInt(arr[1]) == 1 && myStringToInt(arr[2]) == 2)
+	{
+		printf("Sorting success. The first MyStrings are 0, 1, 2\n");
+	}
+	else
+	{
+		printf("ERROR in myStringPartialSort()\n");
+	}
+
+	printf("Setting the MyStrings back to \"9\" down to \"0\", and sorting the 20 smallest\n");
+	int i;
+	for (i = 0; i < 10; i++)
+	{
+		myStringFree(arr[i]);
+	}
+	allocDescendingNumbers(arr, 10);
+	myStringPartialSort(arr, 10, 20);
+
+	bool sorted = true;
+	for (i = 0; i < 10 && sorted; i++)
+	{
+		sorted = myStringToInt(arr[i]) == i;
+	}
+	if (sorted)
+	{
+		printf("Sorting success. k bigger than the length sorts all the MyStrings\n");
+	}
+	else
+	{
+		printf("ERROR in myStringPartialSort()\n");
+	}
+
+	printf("Sorting an empty array\n");
+	myStringPartialSort(arr, 0, 0);
+	myStringPartialSort(arr, 0, 3);
+	if (myStringToInt(arr[0]) == 0 && myStringToInt(arr[9]) == 9)
+	{
+		printf("Sorting success. Nothing changed\n");
+	}
+	else
+	{
+		printf("ERROR in myStringPartialSort()\n");
+	}
+
+	for (i = 0; i < 10; i++)
+	{
+		myStringFree(arr[i]);
+	}
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringNthElement()
+ */
+void testMyStringNthElement()
+{
+	printf("Testing myStringNthElement()...\n");
+
+	printf("Allocating 40 MyStrings set to \"39\" down to \"0\"\n");
+	MyString* arr[40];
+	allocDescendingNumbers(arr, 40);
+
+	printf("Finding the MyString in place 25\n");
+	myStringNthElement(arr, 40, 25);
+
+	bool success = true;
+	int i;
+	for (i = 0; i < 40 && success; i++)
+	{
+		success = (i < 25 && myStringCompare(arr[i], arr[25]) <= 0) ||
+				  (i >= 25 && myStringCompare(arr[i], arr[25]) >= 0);
+	}
+
+	char* res = myStringToCString(arr[25]);
+	if (success)
+	{
+		printf("Success. The MyString in place 25 is %s\n", res);
+	}
+	else
+	{
+		printf("ERROR in myStringNthElement()\n");
+	}
+	free(res);
+
+	for (i = 0; i < 40; i++)
+	{
+		myStringFree(arr[i]);
+	}
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringUnique()
+ */
+void testMyStringUnique()
+{
+	printf("Testing myStringUnique()...\n");
+
+	const char* values[] = {"b", "a", "b", "c", "a", "b"};
+	MyString* arr[6];
+	int i;
+
+	printf("Allocating 6 MyStrings set to b, a, b, c, a, b\n");
+	for (i = 0; i < 6; i++)
+	{
+		arr[i] = myStringAlloc();
+		myStringSetFromCString(arr[i], values[i]);
+	}
+	MyString* secondB = arr[2];
+
+	size_t uniqueLen = 0;
+	printf("Removing the duplicates without freeing them\n");
+	if (myStringUnique(arr, 6, false, &uniqueLen) == MYSTRING_SUCCESS && uniqueLen == 3 &&
+		arr[0]->_string[0] == 'b' && arr[1]->_string[0] == 'a' && arr[2]->_string[0] == 'c' &&
+		arr[3] == secondB)
+	{
+		printf("Success. Kept b, a, c and moved the duplicates after them\n");
+	}
+	else
+	{
+		printf("ERROR in myStringUnique()\n");
+	}
+
+	printf("Removing the duplicates of the duplicates and freeing them\n");
+	if (myStringUnique(arr + 3, 3, true, &uniqueLen) == MYSTRING_SUCCESS && uniqueLen == 2)
+	{
+		printf("Success. Kept b, a and freed b\n");
+	}
+	else
+	{
+		printf("ERROR in myStringUnique()\n");
+	}
+
+	printf("Removing the duplicates of c, c again and a copy of c, and freeing them\n");
+	MyString* copy = myStringAlloc();
+	myStringSetFromCString(copy, "c");
+	MyString* twice[] = {arr[2], arr[2], copy};
+	if (myStringUnique(twice, 3, true, &uniqueLen) == MYSTRING_SUCCESS && uniqueLen == 1 &&
+		twice[0] == arr[2] && arr[2]->_string[0] == 'c')
+	{
+		printf("Success. Kept c, freed its copy and didn't free it\n");
+	}
+	else
+	{
+		printf("ERROR in myStringUnique()\n");
+	}
+
+	for (i = 0; i < 5; i++)
+	{
+		myStringFree(arr[i]);
+	}
+	printf("\n");
+}
+
+/**
+ * @brief Unit-testing to myStringCountDistinct() and myStringEstimateDistinct()
+ */
+void testMyStringCountDistinct()
+{
+	printf("Testing myStringCountDistinct()...\n");
+
+	printf("Allocating 3000 MyStrings set to the numbers 0 to 999, 3 times each\n");
+	MyString* arr[3000];
+	int i;
+	for (i = 0; i < 3000; i++)
+	{
+		arr[i] = myStringAlloc();
+		myStringSetFromInt(arr[i], i % 1000);
+	}
+
+	size_t count = 0;
+	if (myStringCountDistinct(arr, 3000, &count) == MYSTRING_SUCCESS && count == 1000)
+	{
+		printf("Success. Counted %lu distinct values\n", (unsigned long)count);
+	}
+	else
+	{
+		printf("ERROR in myStringCountDistinct()\n");
+	}
+
+	if (myStringEstimateDistinct(arr, 3000, &count) == MYSTRING_SUCCESS && count > 970 &&
+		count < 1030)
+	{
+		printf("Success. Estimated about 1000 distinct values\n");
+	}
+	else
+	{
+		printf("ERROR in myStringEstimateDistinct()\n");
+	}
+
+	for (i = 0; i < 3000; i++)
+	{
+		myStringFree(arr[i]);
+	}
+	printf("\n");
+}
+
+/**
+ * @brief Reader thread of testMyStringFreeze(). Reads the shared frozen MyString many times and
+ * 		  releases the reference taken for it by the creating thread.
+ * @param arg the shared frozen MyString
+ * @return NULL if all the reads were correct, arg otherwise.
+ */
+static void* frozenReader(void* arg)
+{
+	MyString* shared = (MyString*)arg;
+	MyString* expected = myStringAlloc();
+	myStringSetFromCString(expected, "shared value");
+	void* result = NULL;
+	int i;
+
+	for (i = 0; i < READER_ROUNDS; i++)
+	{
+		MyString* reference = myStringRetain(shared);
+		char* cString = myStringToCString(reference);
+
+		if (myStringEqual(reference, expected) <= 0 || strcmp(cString, "shared value") != 0 ||
+			myStringSetFromCString(reference, "changed") != MYSTRING_ERROR)
+		{
+			result = arg;
+		}
+
+		free(cString);
+		myStringFree(reference);
+	}
+
+	myStringFree(expected);
+	myStringFree(shared);
+	return result;
+}
+
+/**
+ * @brief Unit-testing to myStringFreeze() and myStringRetain(), with many threads sharing a
+ * 		  frozen MyString. Should also be run by the tsan target.
+ */
+void testMyStringFreeze()
+{
+	printf("Testing myStringFreeze()...\n");
+
+	printf("Allocating a new empty MyString to myString\n");
+	MyString* myString = myStringAlloc();
+	printf("Setting myString to \"shared value\"\n");
+	myStringSetFromCString(myString, "shared value");
+
+	if (myStringRetain(myString) == NULL && myStringFreeze(myString) == MYSTRING_SUCCESS &&
+		myStringIsFrozen(myString) && myStringCat(myString, myString) == MYSTRING_ERROR)
+	{
+		printf("Success. myString is frozen and can't be changed\n");
+	}
+	else
+	{
+		printf("ERROR in myStringFreeze()\n");
+	}
+
+	printf("Sharing myString with %d reader threads\n", NUM_OF_READERS);
+	pthread_t readers[NUM_OF_READERS];
+	bool created[NUM_OF_READERS];
+	bool success = true;
+	int i;
+
+	for (i = 0; i < NUM_OF_READERS; i++)
+	{
+		created[i] = pthread_create(&readers[i], NULL, frozenReader, myStringRetain(myString)) == 0;
+		if (!created[i])
+		{
+			myStringFree(myString);
+		}
+	}
+
+	// Releasing the first reference while the readers still hold theirs
+	myStringFree(myString);
 
-/**
- * @brief Unit-testing to myStringAlloc()
- */
-void testMyStringAlloc()
-{
-	printf("Testing myStringAlloc()...\n");
-	printf("Allocating a new empty MyString to myString\n");
-	MyString* myString = myStringAlloc();
+	for (i = 0; i < NUM_OF_READERS; i++)
+	{
+		void* result = NULL;
+		if (created[i])
+		{
+			pthread_join(readers[i], &result);
+		}
+		success = success && created[i] && result == NULL;
+	}
 
-	if(myString == NULL)
+	if (success)
 	{
-		perror("Error in memory allocation.\n");
+		printf("Success. All the readers read myString correctly\n");
 	}
 	else
 	{
-		printf("Empty string successfully allocated\n");
+		printf("ERROR in sharing a frozen MyString\n");
 	}
-
-	free(myString);
 	printf("\n");
 }
 
 /**
- * @brief Unit-testing to myStringFree()
+ * @brief Worker thread of testCrossThreadFree(). Allocates READER_ROUNDS MyStrings set to their
+ * 		  indexes, to be freed by the creating thread.
+ * @param arg array of READER_ROUNDS MyString pointers to fill
+ * @return NULL if all the MyStrings were allocated and set, arg otherwise.
  */
-void testMyStringFree()
+static void* allocatingWorker(void* arg)
 {
-	printf("Testing myStringFree()...\n");
-	printf("Allocating a new empty MyString to myString\n");
-	MyString* myString = myStringAlloc();
-	printf("Trying to free to memory allocated to myString\n");
-	myStringFree(myString);
-	printf("Memory successfully freed. Setting myString to NULL\n");
-	myString = NULL;
-	printf("Trying to free memory allocated to NULL\n");
-	myStringFree(myString);
-	printf("Nothing happened as needed\n");
+	MyString** arr = (MyString**)arg;
+	void* result = NULL;
+	int i;
 
-	printf("\n");
+	for (i = 0; i < READER_ROUNDS; i++)
+	{
+		arr[i] = myStringAlloc();
+		if (myStringSetFromInt(arr[i], i + 1) == MYSTRING_ERROR)
+		{
+			result = arg;
+		}
+	}
+	return result;
 }
 
 /**
- * @brief Unit-testing to myStringClone()
+ * @brief Unit-testing to freeing MyStrings in another thread than the one allocated them, which
+ * 		  goes through the remote free lists when built with MYSTRING_THREAD_CACHE.
  */
-void testMyStringClone()
+void testCrossThreadFree()
 {
-	printf("Testing myStringClone()...\n");
-	printf("Allocating a new empty MyString to myString1\n");
-	MyString* myString1 = myStringAlloc();
-	printf("Setting myString to be \"abc\"\n");
-	myStringSetFromCString(myString1, "abc");
-	printf("Cloning myString1 into myString2\n");
-	MyString* myString2 = myStringClone(myString1);
-	if (myString2 == NULL)
+	printf("Testing freeing MyStrings from another thread...\n");
+
+	MyString* arr[READER_ROUNDS];
+	bool success = true;
+	int round, i;
+
+	for (round = 0; round < 3; round++)
 	{
-		perror("Error in memory allocation.\n");
+		printf("Allocating %d MyStrings in a worker thread and freeing them here\n", READER_ROUNDS);
+		pthread_t worker;
+		void* result = arr;
+
+		if (pthread_create(&worker, NULL, allocatingWorker, arr) != 0)
+		{
+			success = false;
+			break;
+		}
+		pthread_join(worker, &result);
+
+		for (i = 0; i < READER_ROUNDS; i++)
+		{
+			success = success && result == NULL && myStringToInt(arr[i]) == i + 1;
+			myStringFree(arr[i]);
+		}
+	}
+
+	if (success)
+	{
+		printf("Success. All the MyStrings were set and freed\n");
 	}
 	else
 	{
-		char* res = myStringToCString(myString2);
-		printf("Cloning success. myString2 is \"%s\"\n", res);
-		free(res);
+		printf("ERROR in freeing MyStrings from another thread\n");
 	}
-
-	myStringFree(myString1);
-	myStringFree(myString2);
 	printf("\n");
 }
 
 /**
- * @brief Unit-testing to myStringSetFromMyString()
+ * @brief Worker thread of testMyStringHashSet(). Inserts frozen MyStrings set to the numbers
+ * 		  0 to READER_ROUNDS - 1 to the shared set, and checks they can be found.
+ * @param arg the shared MyStringHashSet
+ * @return NULL if all the MyStrings were inserted and found, arg otherwise.
  */
-void testMyStringSetFromMyString()
+static void* hashSetWorker(void* arg)
 {
-	printf("Testing myStringSetFromMyString()...\n");
+	MyStringHashSet* set = (MyStringHashSet*)arg;
+	void* result = NULL;
+	int i;
 
-	printf("Allocating a new empty MyString to myString1\n");
-	MyString* myString1 = myStringAlloc();
-	printf("Setting myString1 to be \"abc\"\n");
-	myStringSetFromCString(myString1, "abc");
+	for (i = 0; i < READER_ROUNDS; i++)
+	{
+		MyString* str = myStringAlloc();
+		myStringSetFromInt(str, i);
+		myStringFreeze(str);
 
-	printf("Allocating a new empty MyString to myString1\n");
-	MyString* myString2 = myStringAlloc();
-	printf("Setting myString2 to be \"def\"\n");
-	myStringSetFromCString(myString2, "def");
+		MyString* inserted = myStringHashSetInsert(set, str);
+		if (inserted == NULL || myStringEqual(inserted, str) <= 0 ||
+			myStringHashSetFind(set, str) != inserted)
+		{
+			result = arg;
+		}
+		myStringFree(str);
+	}
+	return result;
+}
 
-	if (myStringSetFromMyString(myString2, myString1) == MYSTRING_ERROR)
+/**
+ * @brief Unit-testing to MyStringHashSet, with many threads inserting the same MyStrings.
+ */
+void testMyStringHashSet()
+{
+	printf("Testing MyStringHashSet...\n");
+
+	printf("Allocating a set for %d MyStrings\n", READER_ROUNDS);
+	MyStringHashSet* set = myStringHashSetAlloc(READER_ROUNDS);
+
+	printf("Inserting the numbers 0 to %d from %d threads\n", READER_ROUNDS - 1, NUM_OF_READERS);
+	pthread_t workers[NUM_OF_READERS];
+	bool created[NUM_OF_READERS];
+	bool success = set != NULL;
+	int i;
+
+	for (i = 0; i < NUM_OF_READERS && success; i++)
 	{
-		perror("Error in allocating memory.\n");
+		created[i] = pthread_create(&workers[i], NULL, hashSetWorker, set) == 0;
+	}
+	for (i = 0; i < NUM_OF_READERS && set != NULL; i++)
+	{
+		void* result = NULL;
+		if (created[i])
+		{
+			pthread_join(workers[i], &result);
+		}
+		success = success && created[i] && result == NULL;
+	}
+
+	if (success && myStringHashSetSize(set) == READER_ROUNDS)
+	{
+		printf("Success. The set has every number once\n");
 	}
 	else
 	{
-		char* res = myStringToCString(myString2);
-		printf("Success. myString2 = %s\n", res);
-		free(res);
+		printf("ERROR in myStringHashSetInsert()\n");
 	}
 
-	myStringFree(myString1);
-	myStringFree(myString2);
+	MyString* missing = myStringAlloc();
+	myStringSetFromCString(missing, "missing");
+	MyString* notFrozen = myStringAlloc();
+	myStringSetFromInt(notFrozen, 1);
+
+	if (myStringHashSetFind(set, missing) == NULL && myStringHashSetInsert(set, notFrozen) == NULL &&
+		myStringHashSetFind(set, notFrozen) != NULL)
+	{
+		printf("Success. Found only the MyStrings in the set\n");
+	}
+	else
+	{
+		printf("ERROR in myStringHashSetFind()\n");
+	}
 
+	myStringFree(missing);
+	myStringFree(notFrozen);
+	myStringHashSetFree(set);
 	printf("\n");
 }
 
+#ifdef MYSTRING_STATS
 /**
- * @brief Used as an argument to myStringFilter() in testMyStringFilter()
- * @parm pointer to char for filtering
- * @return true if the given char is filtered, false otherwise.
+ * @brief Worker thread of testMyStringStats(). Allocates a MyString and frees it.
+ * @param arg unused
+ * @return NULL
  */
-static bool filter(const char* letter)
+static void* statsWorker(void* arg)
 {
-	if (*letter == 'b' || *letter == 'g')
+	(void)arg;
+	myStringFree(myStringAlloc());
+	return NULL;
+}
+
+/**
+ * @return the number of ThreadStats ever allocated.
+ */
+static size_t countThreadStats()
+{
+	size_t count = 0;
+	ThreadStats* stats;
+
+	pthread_mutex_lock(&statsLock);
+	for (stats = allStats; stats != NULL; stats = stats->_next)
 	{
-		return true;
+		count++;
 	}
-
-	return false;
+	pthread_mutex_unlock(&statsLock);
+	return count;
 }
+#endif
 
 /**
- * @brief Unit-testing to myStringFilter()
+ * @brief Unit-testing to myStringStatsGet() and myStringStatsDump()
  */
-void testMyStringFilter()
+void testMyStringStats()
 {
-	printf("Testing myStringFilter()...\n");
-	printf("Allocating a new empty MyString to myString1\n");
-	MyString* myString = myStringAlloc();
-	printf("Setting myString to be \"abcbfdgbdfsgjh\"\n");
-	myStringSetFromCString(myString, "abcbfdgbdfsgjh");
+	printf("Testing myStringStatsGet()...\n");
 
-	bool (*filt)(const char *);
-	filt = filter;
+	MyStringStats before, after;
 
-	int x = myStringFilter(myString, filt);
+	if (myStringStatsGet(&before) == MYSTRING_ERROR)
+	{
+		printf("Statistics are not available, build with MYSTRING_STATS to test them\n\n");
+		return;
+	}
 
-	if (x == MYSTRING_ERROR)
+	printf("Allocating a new empty MyString to myString and setting it to \"abc\"\n");
+	MyString* myString = myStringAlloc();
+	myStringSetFromCString(myString, "abc");
+	printf("Converting myString to a C string, which is freed by free()\n");
+	free(myStringToCString(myString));
+	myStringFree(myString);
+	myStringStatsGet(&after);
+
+	if (after.allocations - before.allocations == 2 && after.frees - before.frees == 2 &&
+		after.bytesAllocated - before.bytesAllocated == sizeof(MyString) + 4 &&
+		after.bytesCopied - before.bytesCopied == 6)
 	{
-		perror("Error in allocating memory\n");
+		// The string of "abc" has a spare char for the null character of myStringCStr
+		printf("Success. Counted 2 allocations of %lu bytes and 2 copies of 3 bytes\n",
+			   (unsigned long)(sizeof(MyString) + 4));
 	}
 	else
 	{
-		char* str = myStringToCString(myString);
-		printf("Success. myString = %s\n", str);
-		free(str);
+		printf("ERROR in myStringStatsGet()\n");
 	}
 
-	myStringFree(myString);
-	printf("\n");
-}
+#ifdef MYSTRING_STATS
+	printf("Comparing and sorting 3 MyStrings\n");
+	MyString* arr[3];
+	unsigned long long callsBefore[NUM_OF_STATS], callsAfter[NUM_OF_STATS];
+	int i;
+	for (i = 0; i < 3; i++)
+	{
+		arr[i] = myStringAlloc();
+		myStringSetFromInt(arr[i], 3 - i);
+	}
 
-/**
- * @brief Unit-testing to myStringSetFromCString()
- */
-void testMyStringSetFromCString()
-{
-	printf("Testing myStringSetFromCString()...\n");
-	printf("Allocating empty MyString to myString\n");
-	MyString* myString = myStringAlloc();
-	printf("Setting myString1 to \"abc\"\n");
-	char* res = NULL;
-	if (myStringSetFromCString(myString, "abc") == MYSTRING_SUCCESS)
+	sumStats(callsBefore);
+	myStringCompare(arr[0], arr[1]);
+	myStringEqual(arr[0], arr[1]);
+	myStringSort(arr, 3);
+	sumStats(callsAfter);
+
+	// The public functions called by the library itself, or as comparators, must not be counted
+	unsigned long long calls[NUM_OF_STATS];
+	for (i = 0; i < NUM_OF_STATS; i++)
 	{
-		res = myStringToCString(myString);
-		printf("SUCCESS. myString = %s\n", res);
-		free(res);
+		calls[i] = callsAfter[i] - callsBefore[i];
+	}
+	if (calls[STAT_CALLS_myStringCompare] == 1 && calls[STAT_CALLS_myStringEqual] == 1 &&
+		calls[STAT_CALLS_myStringSort] == 1 && calls[STAT_CALLS_myStringCustomCompare] == 0 &&
+		calls[STAT_CALLS_myStringCustomEqual] == 0 && calls[STAT_CALLS_myStringCustomSort] == 0)
+	{
+		printf("Success. Counted one call to every function called\n");
 	}
 	else
 	{
-		perror("Error allocating memory.");
+		printf("ERROR in myStringStatsGet()\n");
 	}
 
-	printf("Setting myString to \"def\"\n");
-	if (myStringSetFromCString(myString, "def") == MYSTRING_SUCCESS)
+	for (i = 0; i < 3; i++)
 	{
-		res = myStringToCString(myString);
-		printf("SUCCESS. myString1 = %s\n", res);
-		free(res);
+		myStringFree(arr[i]);
+	}
+
+	printf("Allocating a MyString in %d threads, one after the other\n", NUM_OF_READERS);
+	size_t numOfStats = countThreadStats();
+	bool success = true;
+
+	sumStats(callsBefore);
+	for (i = 0; i < NUM_OF_READERS && success; i++)
+	{
+		pthread_t worker;
+		success = pthread_create(&worker, NULL, statsWorker, NULL) == 0 &&
+				  pthread_join(worker, NULL) == 0;
+	}
+	sumStats(callsAfter);
+
+	// Every thread gets the counters of the one that exited before it
+	if (success && countThreadStats() <= numOfStats + 1 &&
+		callsAfter[STAT_CALLS_myStringAlloc] - callsBefore[STAT_CALLS_myStringAlloc] ==
+		NUM_OF_READERS)
+	{
+		printf("Success. The threads shared one set of counters, and all their calls counted\n");
 	}
 	else
 	{
-		perror("Error allocating memory.");
+		printf("ERROR in myStringStatsGet()\n");
 	}
+#endif
 
-	myStringFree(myString);
+	printf("Dumping the statistics:\n");
+	myStringStatsDump(stdout);
 	printf("\n");
 }
 
 /**
- * @brief Unit-testing to myStringSetFromInt()
+ * The allocator of testMyStringSetAllocator(): counts the allocations and the bytes asked by
+ * malloc, and fails the allocations after _failAfter allocations.
  */
-void testMyStringSetFromInt()
+typedef struct
 {
-	printf("Testing myStringSetFromInt()...\n");
-	printf("Allocating a new empty MyString to myString\n");
-	MyString* myString = myStringAlloc();
-	char* res = NULL;
+	size_t _allocations;
+	size_t _failAfter;
+	size_t _bytes;
+} TestAllocator;
 
-	printf("Setting myString to 765\n");
-	if (myStringSetFromInt(myString, 765) == MYSTRING_ERROR)
+/**
+ * @brief malloc of TestAllocator.
+ * @param size
+ * @param ctx the TestAllocator
+ * @return the result of malloc, or NULL if the allocation should fail.
+ */
+static void* testMalloc(size_t size, void* ctx)
+{
+	TestAllocator* testAllocator = (TestAllocator*)ctx;
+	if (testAllocator->_allocations >= testAllocator->_failAfter)
 	{
-		perror("Error in memory allocation.\n");
+		return NULL;
+	}
+	testAllocator->_allocations++;
+	testAllocator->_bytes += size;
+	return malloc(size);
+}
+
+/**
+ * @brief realloc of TestAllocator.
+ * @param ptr
+ * @param size
+ * @param ctx the TestAllocator
+ * @return the result of realloc, or NULL if the allocation should fail.
+ */
+static void* testRealloc(void* ptr, size_t size, void* ctx)
+{
+	TestAllocator* testAllocator = (TestAllocator*)ctx;
+	if (testAllocator->_allocations >= testAllocator->_failAfter)
+	{
+		return NULL;
+	}
+	testAllocator->_allocations++;
+	return realloc(ptr, size);
+}
+
+/**
+ * @brief free of TestAllocator.
+ * @param ptr
+ * @param ctx unused
+ */
+static void testFree(void* ptr, void* ctx)
+{
+	(void)ctx;
+	free(ptr);
+}
+
+/**
+ * @brief Unit-testing to myStringArraySerialize() and myStringArrayLoad()
+ */
+void testMyStringArray()
+{
+	printf("Testing myStringArraySerialize() and myStringArrayLoad()...\n");
+	const char* values[] = {"pear", "", "apple", "fig"};
+	MyString* arr[4];
+	int i;
+
+	printf("Writing 4 MyStrings to testArray.txt\n");
+	for (i = 0; i < 4; i++)
+	{
+		arr[i] = myStringAlloc();
+		myStringSetFromCString(arr[i], values[i]);
+	}
+	FILE* stream = fopen("testArray.txt", "wb");
+	bool success = stream != NULL && myStringArraySerialize(arr, 4, stream) == MYSTRING_SUCCESS;
+	if (stream != NULL)
+	{
+		success = fclose(stream) == 0 && success;
+	}
+
+	printf("Loading testArray.txt, and sorting its MyStrings\n");
+	MyStringArray* array = myStringArrayLoad("testArray.txt");
+	MyString** strings = myStringArrayStrings(array);
+	success = success && array != NULL && myStringArrayLen(array) == 4;
+	for (i = 0; i < 4 && success; i++)
+	{
+		success = myStringEqual(strings[i], arr[i]) == 1 && myStringIsFrozen(strings[i]);
+	}
+	if (success)
+	{
+		myStringSort(strings, 4);
+		myStringFree(strings[0]);
+		success = myStringLen(strings[0]) == 0 && myStringCompare(strings[1], arr[2]) == 0 &&
+				  myStringCompare(strings[3], arr[0]) == 0;
+	}
+	if (success)
+	{
+		printf("Success. The MyStrings were loaded without copying them, and sorted\n");
 	}
 	else
 	{
-		res = myStringToCString(myString);
-		printf("Success. myString = %s\n", res);
-		free(res);
+		printf("ERROR in myStringArrayLoad()\n");
 	}
 
-	printf("Setting myString to -1385\n");
-	if (myStringSetFromInt(myString, -1385) == MYSTRING_ERROR)
+	printf("Loading a file that wasn't written by myStringArraySerialize()\n");
+	stream = fopen("testArray.txt", "wb");
+	if (stream != NULL)
 	{
-		perror("Error in memory allocation.\n");
+		fputs("MYSTRAR1 is not enough", stream);
+		fclose(stream);
+	}
+	if (myStringArrayLoad("testArray.txt") == NULL && myStringArrayLoad(NULL) == NULL)
+	{
+		printf("Returns error as expected, because of bad argument.\n");
 	}
 	else
 	{
-		res = myStringToCString(myString);
-		printf("Success. myString = %s\n", res);
-		free(res);
+		printf("ERROR in myStringArrayLoad()\n");
 	}
 
-	myStringFree(myString);
+	myStringArrayFree(array);
+	for (i = 0; i < 4; i++)
+	{
+		myStringFree(arr[i]);
+	}
 	printf("\n");
 }
 
 /**
- * @brief Unit-testing to myStringToInt()
+ * @brief Unit-testing to myStringCompress() and myStringIsCompressed()
  */
-void testMyStringToInt()
+void testMyStringCompress()
 {
-	printf("Testing myStringSetFromInt()...\n");
-	printf("Allocating a new empty MyString to myString\n");
+	printf("Testing myStringCompress()...\n");
+	printf("Setting myString to 4096 chars of repeated log lines, and cloning it\n");
+	MyStringBuilder* builder = myStringBuilderAlloc(0);
 	MyString* myString = myStringAlloc();
-	printf("Setting myString to 765\n");
-	myStringSetFromInt(myString, 765);
-	int num = myStringToInt(myString);
-	if (num == MYSTR_ERROR_CODE)
+	int i;
+
+	for (i = 0; myStringBuilderLen(builder) < 4096; i++)
+	{
+		myStringBuilderAppendf(builder, "request %d: status=ok\n", i % 10);
+	}
+	myStringBuilderBuild(builder, myString);
+	myStringBuilderFree(builder);
+	MyString* clone = myStringClone(myString);
+	unsigned long length = myStringLen(myString), memUsage = myStringMemUsage(myString);
+
+	printf("Compressing myString\n");
+	bool success = myStringCompress(myString) == MYSTRING_SUCCESS &&
+				   myStringIsCompressed(myString) && myStringLen(myString) == length &&
+				   myStringMemUsage(myString) < memUsage / 4 &&
+				   myStringCompress(myString) == MYSTRING_SUCCESS;
+
+	printf("Comparing myString to its clone\n");
+	success = success && myStringEqual(myString, clone) == 1 && !myStringIsCompressed(myString) &&
+			  memcmp(myStringData(myString), myStringData(clone), length) == 0;
+
+	printf("Compressing myString again, appending to it and setting it\n");
+	success = success && myStringCompress(myString) == MYSTRING_SUCCESS &&
+			  myStringCat(myString, clone) == MYSTRING_SUCCESS &&
+			  myStringLen(myString) == 2 * length &&
+			  memcmp(myStringData(myString) + length, myStringData(clone), length) == 0 &&
+			  myStringCompress(myString) == MYSTRING_SUCCESS &&
+			  myStringSetFromCString(myString, "request") == MYSTRING_SUCCESS &&
+			  !myStringIsCompressed(myString) && myStringLen(myString) == 7 &&
+			  memcmp(myStringData(myString), "request", 7) == 0;
+	if (success)
+	{
+		printf("SUCCESS. myString shrank, and kept its value\n");
+	}
+	else
 	{
-		perror("Error in function myStringToInt.\n");
+		printf("ERROR in myStringCompress()\n");
+	}
+
+	printf("Compressing a short MyString and a MyString of chars that don't repeat\n");
+	char chars[256];
+	unsigned int seed = 1;
+	for (i = 0; i < 256; i++)
+	{
+		seed = seed * 1103515245U + 12345U;
+		chars[i] = (char)(seed >> 16);
+	}
+	success = myStringSetFromBuffer(clone, chars, 256) == MYSTRING_SUCCESS &&
+			  myStringCompress(clone) == MYSTRING_SUCCESS && !myStringIsCompressed(clone) &&
+			  myStringCompress(myString) == MYSTRING_SUCCESS && !myStringIsCompressed(myString);
+	if (success)
+	{
+		printf("SUCCESS. They were left as they are\n");
 	}
 	else
 	{
-		printf("Success. num = %d\n", num);
+		printf("ERROR in myStringCompress()\n");
 	}
 
-	printf("Setting myString to \"abc\"\n");
-	myStringSetFromCString(myString, "abc");
-	num = myStringToInt(myString);
-	if (num == MYSTR_ERROR_CODE)
+	printf("Compressing NULL and a frozen MyString\n");
+	myStringFreeze(clone);
+	if (myStringCompress(NULL) == MYSTRING_ERROR && myStringCompress(clone) == MYSTRING_ERROR &&
+		!myStringIsCompressed(NULL))
 	{
 		printf("Returns error as expected, because of bad argument.\n");
 	}
 	else
 	{
-		perror("ERROR");
+		printf("ERROR in myStringCompress()\n");
 	}
 
 	myStringFree(myString);
+	myStringFree(clone);
 	printf("\n");
 }
 
 /**
- * @brief Unit-testing to myStringToCString()
+ * @brief Unit-testing to myStringValidateUtf8(), myStringCodepointLen() and myStringNextCodepoint()
  */
-void testMyStringToCString()
+void testMyStringUtf8()
 {
-	printf("Testing myStringToCString()...\n");
-
-	printf("Allocating a new empty MyString to myString\n");
+	printf("Testing myStringValidateUtf8()...\n");
+	printf("Setting myString to a German greeting, a euro sign and a G clef in UTF-8\n");
 	MyString* myString = myStringAlloc();
-	printf("Setting myString to \"abc\"\n");
-	myStringSetFromCString(myString, "abc");
-	char* cString = myStringToCString(myString);
-	if (cString == NULL)
+	myStringSetFromCString(myString, "Gr\xC3\xBC\xC3\x9F Gott \xE2\x82\xAC \xF0\x9D\x84\x9E");
+	int expected[] = {'G', 'r', 0xFC, 0xDF, ' ', 'G', 'o', 't', 't', ' ', 0x20AC, ' ', 0x1D11E};
+	size_t offset = 0, i = 0;
+	int codepoint;
+
+	bool success = myStringValidateUtf8(myString) && myStringCodepointLen(myString) == 13 &&
+				   myStringValidateUtf8(myString);
+	while ((codepoint = myStringNextCodepoint(myString, &offset)) >= 0)
 	{
-		perror("Error in memory allocation.\n");
+		success = success && i < 13 && codepoint == expected[i];
+		i++;
+	}
+	success = success && codepoint == MYSTR_END_CODE && i == 13 &&
+			  offset == myStringLen(myString);
+	if (success)
+	{
+		printf("SUCCESS. myString is valid, and has 13 code points\n");
 	}
 	else
 	{
-		printf("Success. cString = %s\n", cString);
+		printf("ERROR in myStringValidateUtf8()\n");
 	}
 
-	free(cString);
-	myStringFree(myString);
-	printf("\n");
-}
-
-/**
- * @brief Unit-testing to myStringCat()
- */
-void testMyStringCat()
-{
-	printf("Testing myStringToCString()...\n");
-
-	printf("Allocating a new empty MyString to myString1\n");
-	MyString* myString1 = myStringAlloc();
-	printf("Setting myString1 to \"abc\"\n");
-	myStringSetFromCString(myString1, "abc");
-
-	printf("Allocating a new empty MyString to myString2\n");
-	MyString* myString2 = myStringAlloc();
-	printf("Setting myString2 to \"def\"\n");
-	myStringSetFromCString(myString2, "def");
-
-	printf("Appending myString2 to myString1:\n");
-	if(myStringCat(myString1, myString2) == MYSTRING_ERROR)
+	printf("Appending an overlong encoding, a surrogate, a code point above U+10FFFF and a "
+		   "truncated sequence\n");
+	const char* invalid[] = {"\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xE2\x82",
+							 "\x80", "\xF8\x88\x80\x80\x80"};
+	MyString* suffix = myStringAlloc();
+	MyString* clone = myStringClone(myString);
+	success = true;
+	for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
 	{
-		perror("Error in memory allocation.\n");
+		myStringSetFromMyString(myString, clone);
+		myStringSetFromCString(suffix, invalid[i]);
+		myStringCat(myString, suffix);
+		offset = myStringLen(clone);
+		success = success && !myStringValidateUtf8(myString) &&
+				  myStringCodepointLen(myString) == MYSTR_ERROR_CODE &&
+				  myStringNextCodepoint(myString, &offset) == MYSTR_ERROR_CODE &&
+				  offset == myStringLen(clone);
+	}
+	if (success)
+	{
+		printf("SUCCESS. The kept result was dropped, and none of them is valid\n");
 	}
 	else
 	{
-		char* res = myStringToCString(myString1);
-		printf("Success. myString1 = %s\n", res);
-		free(res);
+		printf("ERROR in myStringValidateUtf8()\n");
 	}
 
-	myStringFree(myString1);
-	myStringFree(myString2);
-	printf("\n");
-}
-
-/**
- * @brief Unit-testing to myStringCatTo()
- */
-void testMyStringCatTo()
-{
-	printf("Testing myStringCatTo()...\n");
-
-	printf("Allocating a new empty MyString to myString1\n");
-	MyString* myString1 = myStringAlloc();
-	printf("Setting myString1 to \"abc\"\n");
-	myStringSetFromCString(myString1, "abc");
-
-	printf("Allocating a new empty MyString to myString2\n");
-	MyString* myString2 = myStringAlloc();
-	printf("Setting myString2 to \"def\"\n");
-	myStringSetFromCString(myString2, "def");
-
-	printf("Allocating a new empty MyString to result\n");
-	MyString* result = myStringAlloc();
+	printf("Setting myString to 40 ASCII chars and a char that isn't valid at every place\n");
+	char chars[41];
+	success = true;
+	for (i = 0; i <= 40; i++)
+	{
+		memset(chars, 'a', 40);
+		chars[i] = (char)0xFF;
+		myStringSetFromBuffer(myString, chars, 41);
+		success = success && !myStringValidateUtf8(myString);
+	}
+	myStringSetFromBuffer(myString, chars, 40);
+	success = success && myStringValidateUtf8(myString) && myStringCodepointLen(myString) == 40;
+	if (success)
+	{
+		printf("SUCCESS. The invalid char was found at every place\n");
+	}
+	else
+	{
+		printf("ERROR in myStringValidateUtf8()\n");
+	}
 
-	printf("Concatenate myString1 and myString2 into result\n");
-	if(myStringCatTo(myString1, myString2, result) == MYSTRING_ERROR)
+	printf("Checking NULL and offsets past the end\n");
+	offset = 41;
+	if (!myStringValidateUtf8(NULL) && myStringCodepointLen(NULL) == MYSTR_ERROR_CODE &&
+		myStringNextCodepoint(myString, &offset) == MYSTR_ERROR_CODE &&
+		myStringNextCodepoint(myString, NULL) == MYSTR_ERROR_CODE)
 	{
-		perror("Error in memory Allocation.\n");
+		printf("Returns error as expected, because of bad argument.\n");
 	}
 	else
 	{
-		char* res = myStringToCString(result);
-		printf("Success. result = %s\n", res);
-		free(res);
+		printf("ERROR in myStringValidateUtf8()\n");
 	}
 
-	myStringFree(myString1);
-	myStringFree(myString2);
-	myStringFree(result);
+	myStringFree(myString);
+	myStringFree(suffix);
+	myStringFree(clone);
 	printf("\n");
 }
 
 /**
- * @brief Unit-testing to myStringCompare()
+ * @brief Unit-testing to myStringToLower(), myStringToUpper() and myStringTranslate()
  */
-void testMyStringCompare()
+void testMyStringCase()
 {
-	printf("Testing myStringCompare()...\n");
-
-	printf("Allocating a new empty MyString to myString1\n");
-	MyString* myString1 = myStringAlloc();
-	printf("Setting myString1 to \"abc\"\n");
-	myStringSetFromCString(myString1, "abc");
-
-	printf("Allocating a new empty MyString to myString2\n");
-	MyString* myString2 = myStringAlloc();
-	printf("Setting myString2 to \"def\"\n");
-	myStringSetFromCString(myString2, "def");
-
-	int compare = myStringCompare(myString1, myString2);
+	printf("Testing myStringToLower(), myStringToUpper() and myStringTranslate()...\n");
+	printf("Setting myString to all the 256 chars, twice\n");
+	MyString* myString = myStringAlloc();
+	char chars[2 * NUM_OF_CHARS];
+	int i;
+	for (i = 0; i < 2 * NUM_OF_CHARS; i++)
+	{
+		chars[i] = (char)i;
+	}
+	myStringSetFromBuffer(myString, chars, sizeof(chars));
+	const char* string = myStringData(myString);
 
-	if (compare == MYSTR_ERROR_CODE)
+	printf("Converting myString to lower case, then to upper case\n");
+	bool success = myStringToLower(myString) == MYSTRING_SUCCESS;
+	for (i = 0; i < 2 * NUM_OF_CHARS; i++)
 	{
-		perror("Error in myStringCompare()\n");
+		unsigned char ch = (unsigned char)i;
+		success = success && (unsigned char)myStringData(myString)[i] ==
+							 (ch >= 'A' && ch <= 'Z' ? ch + 'a' - 'A' : ch);
 	}
-	else if (compare > 0)
+	success = success && myStringToUpper(myString) == MYSTRING_SUCCESS;
+	for (i = 0; i < 2 * NUM_OF_CHARS; i++)
 	{
-		printf("myString1 is bigger then myString2\n");
+		unsigned char ch = (unsigned char)i;
+		success = success && (unsigned char)myStringData(myString)[i] ==
+							 (ch >= 'a' && ch <= 'z' ? ch - 'a' + 'A' : ch);
 	}
-	else if (compare < 0)
+	success = success && myStringData(myString) == string;
+	if (success)
 	{
-		printf("myString2 is bigger then myString1\n");
+		printf("SUCCESS. Only the ASCII letters were converted, in place\n");
 	}
 	else
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("ERROR in myStringToLower()\n");
 	}
 
-	printf("Setting myString2 to \"abc\"\n");
-	myStringSetFromCString(myString2, "abc");
-
-	compare = myStringCompare(myString1, myString2);
-
-	if (compare == MYSTR_ERROR_CODE)
-	{
-		perror("Error in myStringCompare()\n");
-	}
-	else if (compare > 0)
+	printf("Translating \"Hello, World!\" by ROT13\n");
+	uint8_t rot13[NUM_OF_CHARS];
+	for (i = 0; i < NUM_OF_CHARS; i++)
 	{
-		printf("myString1 is bigger then myString2\n");
+		rot13[i] = (uint8_t)(isalpha(i) ? (tolower(i) - 'a' + 13) % 26 + (i & ~0x1F) + 1 : i);
 	}
-	else if (compare < 0)
+	myStringSetFromCString(myString, "Hello, World!");
+	success = myStringTranslate(myString, rot13) == MYSTRING_SUCCESS &&
+			  myStringLen(myString) == 13 &&
+			  memcmp(myStringData(myString), "Uryyb, Jbeyq!", 13) == 0 &&
+			  myStringTranslate(myString, rot13) == MYSTRING_SUCCESS &&
+			  memcmp(myStringData(myString), "Hello, World!", 13) == 0;
+	if (success)
 	{
-		printf("myString2 is bigger then myString1\n");
+		printf("SUCCESS. Translating it twice gave it back\n");
 	}
 	else
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("ERROR in myStringTranslate()\n");
 	}
 
-	printf("Setting myString2 to NULL\n");
-	freeString(myString2);
-	myString2->_string = NULL;
-
-	compare = myStringCompare(myString1, myString2);
-
-	if (compare == MYSTR_ERROR_CODE)
-	{
-		perror("ERROR as expected, because and compare\n");
-	}
-	else if (compare > 0)
-	{
-		printf("myString1 is bigger then myString2\n");
-	}
-	else if (compare < 0)
+	printf("Converting NULL, a frozen MyString and translating by a NULL table\n");
+	MyString* frozen = myStringClone(myString);
+	myStringFreeze(frozen);
+	if (myStringToLower(NULL) == MYSTRING_ERROR && myStringToUpper(frozen) == MYSTRING_ERROR &&
+		myStringTranslate(myString, NULL) == MYSTRING_ERROR &&
+		myStringTranslate(frozen, rot13) == MYSTRING_ERROR)
 	{
-		printf("myString2 is bigger then myString1\n");
+		printf("Returns error as expected, because of bad argument.\n");
 	}
 	else
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("ERROR in myStringToLower()\n");
 	}
 
-	myStringFree(myString1);
-	myStringFree(myString2);
+	myStringFree(myString);
+	myStringFree(frozen);
 	printf("\n");
 }
 
 /**
- * @brief Unit-testing to myStringCustomCompare()
+ * @brief Check if the value of str is the given C string.
+ * @param str
+ * @param cString
+ * @return true if they are equal, false otherwise.
  */
-void testMyStringCustomCompare()
+static bool hasValue(const MyString* str, const char* cString)
 {
-	printf("Testing myStringCustomCompare()...\n");
-
-	printf("Allocating a new empty MyString to myString1\n");
-	MyString* myString1 = myStringAlloc();
-	printf("Setting myString1 to \"abc\"\n");
-	myStringSetFromCString(myString1, "abc");
-
-	printf("Allocating a new empty MyString to myString2\n");
-	MyString* myString2 = myStringAlloc();
-	printf("Setting myString2 to \"def\"\n");
-	myStringSetFromCString(myString2, "def");
-
-	int (*comparator)(const char, const char);
-	comparator = defaultComparator;
-
-	int compare = myStringCustomCompare(myString1, myString2, comparator);
+	return myStringLen(str) == strlen(cString) &&
+		   (myStringLen(str) == 0 || memcmp(myStringData(str), cString, strlen(cString)) == 0);
+}
 
-	if (compare == MYSTR_ERROR_CODE)
-	{
-		perror("ERROR in myStringCustomCompare()\n");
-	}
-	else if (compare > 0)
-	{
-		printf("myString1 is bigger then myString2\n");
-	}
-	else if (compare < 0)
+/**
+ * @brief Unit-testing to myStringTrim(), myStringReplace() and myStringReplaceAll()
+ */
+void testMyStringReplace()
+{
+	printf("Testing myStringTrim(), myStringReplace() and myStringReplaceAll()...\n");
+	printf("Trimming \" \\t a b \\r\\n\", \"ab\" and \" \\n \"\n");
+	MyString* myString = myStringAlloc();
+	MyString* from = myStringAlloc();
+	MyString* to = myStringAlloc();
+	bool success = myStringSetFromCString(myString, " \t a b \r\n") == MYSTRING_SUCCESS &&
+				   myStringTrim(myString) == MYSTRING_SUCCESS && hasValue(myString, "a b") &&
+				   myStringSetFromCString(myString, "ab") == MYSTRING_SUCCESS &&
+				   myStringTrim(myString) == MYSTRING_SUCCESS && hasValue(myString, "ab") &&
+				   myStringSetFromCString(myString, " \n ") == MYSTRING_SUCCESS &&
+				   myStringTrim(myString) == MYSTRING_SUCCESS && hasValue(myString, "");
+	if (success)
 	{
-		printf("myString2 is bigger then myString1\n");
+		printf("SUCCESS. Only the whitespace at the ends was removed\n");
 	}
 	else
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("ERROR in myStringTrim()\n");
 	}
 
-	printf("Setting myString2 to \"abc\"\n");
-	myStringSetFromCString(myString2, "abc");
-
-	compare = myStringCustomCompare(myString1, myString2, comparator);
-
-	if (compare == MYSTR_ERROR_CODE)
-	{
-		perror("ERROR in myStringCustomCompare()\n");
-	}
-	else if (compare > 0)
+	printf("Replacing \"ab\" in \"xabyabab\" by \"\", \"c\", \"cd\" and \"cde\"\n");
+	const char* tos[] = {"", "c", "cd", "cde"};
+	const char* firsts[] = {"xyabab", "xcyabab", "xcdyabab", "xcdeyabab"};
+	const char* alls[] = {"xy", "xcycc", "xcdycdcd", "xcdeycdecde"};
+	size_t i;
+	myStringSetFromCString(from, "ab");
+	success = true;
+	for (i = 0; i < 4; i++)
 	{
-		printf("myString1 is bigger then myString2\n");
+		myStringSetFromCString(to, tos[i]);
+		myStringSetFromCString(myString, "xabyabab");
+		const char* string = myStringData(myString);
+		success = success && myStringReplace(myString, from, to) == MYSTRING_SUCCESS &&
+				  hasValue(myString, firsts[i]) && (i > 2 || myStringData(myString) == string);
+		myStringSetFromCString(myString, "xabyabab");
+		success = success && myStringReplaceAll(myString, from, to) == MYSTRING_SUCCESS &&
+				  hasValue(myString, alls[i]);
 	}
-	else if (compare < 0)
+	if (success)
 	{
-		printf("myString2 is bigger then myString1\n");
+		printf("SUCCESS. The replacements that are not longer were made in place\n");
 	}
 	else
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("ERROR in myStringReplaceAll()\n");
 	}
 
-	printf("Setting myString2 to NULL\n");
-	freeString(myString2);
-	myString2->_string = NULL;
-
-	compare = myStringCustomCompare(myString1, myString2, comparator);
-
-	if (compare == MYSTR_ERROR_CODE)
+	printf("Replacing \"aa\" in \"aaaaa\", \"q\" in \"aaaaa\" and myString in itself\n");
+	myStringSetFromCString(myString, "aaaaa");
+	myStringSetFromCString(from, "aa");
+	myStringSetFromCString(to, "b");
+	success = myStringReplaceAll(myString, from, to) == MYSTRING_SUCCESS &&
+			  hasValue(myString, "bba") && myStringSetFromCString(from, "q") == MYSTRING_SUCCESS &&
+			  myStringReplaceAll(myString, from, to) == MYSTRING_SUCCESS &&
+			  hasValue(myString, "bba") &&
+			  myStringReplaceAll(myString, to, myString) == MYSTRING_SUCCESS &&
+			  hasValue(myString, "bbabbaa") &&
+			  myStringReplace(myString, myString, to) == MYSTRING_SUCCESS &&
+			  hasValue(myString, "b");
+	if (success)
 	{
-		perror("ERROR as expected, because and compare\n");
+		printf("SUCCESS. The occurrences didn't overlap\n");
 	}
-	else if (compare > 0)
+	else
 	{
-		printf("myString1 is bigger then myString2\n");
+		printf("ERROR in myStringReplaceAll()\n");
 	}
-	else if (compare < 0)
+
+	printf("Replacing an empty MyString, in NULL and by NULL\n");
+	myStringSetFromCString(from, "");
+	if (myStringReplaceAll(myString, from, to) == MYSTRING_ERROR &&
+		myStringReplace(NULL, to, to) == MYSTRING_ERROR &&
+		myStringReplaceAll(myString, to, NULL) == MYSTRING_ERROR &&
+		myStringTrim(NULL) == MYSTRING_ERROR && hasValue(myString, "b"))
 	{
-		printf("myString2 is bigger then myString1\n");
+		printf("Returns error as expected, because of bad argument.\n");
 	}
 	else
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("ERROR in myStringReplaceAll()\n");
 	}
 
-	myStringFree(myString1);
-	myStringFree(myString2);
+	myStringFree(myString);
+	myStringFree(from);
+	myStringFree(to);
 	printf("\n");
 }
 
 /**
- * @brief Unit-testing to myStringEqual()
+ * @brief Unit-testing to myStringParseInts()
  */
-void testMyStringEqual()
+void testMyStringParseInts()
 {
-	printf("Testing myStringEqual()...\n");
-
-	printf("Allocating a new empty MyString to myString1\n");
-	MyString* myString1 = myStringAlloc();
-	printf("Setting myString1 to \"abc\"\n");
-	myStringSetFromCString(myString1, "abc");
-
-	printf("Allocating a new empty MyString to myString2\n");
-	MyString* myString2 = myStringAlloc();
-	printf("Setting myString2 to \"def\"\n");
-	myStringSetFromCString(myString2, "def");
+	printf("Testing myStringParseInts()...\n");
+	printf("Parsing \" 1, -22 ,+333,12345678901234567, -9223372036854775808,"
+		   "9223372036854775807 \"\n");
+	MyString* myString = myStringAlloc();
+	int64_t out[8];
+	int64_t expected[] = {1, -22, 333, 12345678901234567LL, INT64_MIN, INT64_MAX};
+	size_t count = 0, offset = 0, i;
+
+	myStringSetFromCString(myString, " 1, -22 ,+333,12345678901234567, -9223372036854775808,"
+						   "9223372036854775807 ");
+	bool success = myStringParseInts(myString, ',', out, 8, &count, &offset) ==
+				   MYSTRING_SUCCESS && count == 6;
+	for (i = 0; i < 6; i++)
+	{
+		success = success && out[i] == expected[i];
+	}
+	myStringSetFromCString(myString, "\t10  20\n30 ");
+	success = success && myStringParseInts(myString, ' ', out, 8, &count, NULL) ==
+			  MYSTRING_SUCCESS && count == 3 && out[0] == 10 && out[1] == 20 && out[2] == 30;
+	myStringSetFromCString(myString, "  ");
+	success = success && myStringParseInts(myString, ',', NULL, 0, &count, NULL) ==
+			  MYSTRING_SUCCESS && count == 0;
+	if (success)
+	{
+		printf("SUCCESS. All the integers were parsed\n");
+	}
+	else
+	{
+		printf("ERROR in myStringParseInts()\n");
+	}
 
-	int equal = myStringEqual(myString1, myString2);
-	if (equal == MYSTR_ERROR_CODE)
+	printf("Parsing lists with an error, and a list longer than out\n");
+	const char* lists[] = {"1,2,,3", "1,2x", "1, 9223372036854775808", "1 2", "1,2,", "-",
+						   "1,2,3"};
+	size_t counts[] = {2, 2, 1, 1, 2, 0, 2};
+	size_t offsets[] = {4, 3, 3, 2, 4, 1, 4};
+	success = true;
+	for (i = 0; i < sizeof(lists) / sizeof(lists[0]); i++)
 	{
-		perror ("ERROR in myStringEqual()\n");
+		myStringSetFromCString(myString, lists[i]);
+		success = success && myStringParseInts(myString, ',', out, 2, &count, &offset) ==
+				  MYSTRING_ERROR && count == counts[i] && offset == offsets[i];
 	}
-	else if (equal > 0)
+	if (success)
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("SUCCESS. Every error was found at its offset\n");
 	}
 	else
 	{
-		printf("myString1 and myString2 are not equal\n");
+		printf("ERROR in myStringParseInts()\n");
 	}
 
-	printf("Setting myString2 to \"abc\"\n");
-	myStringSetFromCString(myString2, "abc");
-
-	equal = myStringEqual(myString1, myString2);
-	if (equal == MYSTR_ERROR_CODE)
-	{
-		perror ("ERROR in myStringEqual()\n");
-	}
-	else if (equal > 0)
+	printf("Parsing NULL, and to a NULL out\n");
+	if (myStringParseInts(NULL, ',', out, 8, &count, NULL) == MYSTRING_ERROR &&
+		myStringParseInts(myString, ',', NULL, 8, &count, NULL) == MYSTRING_ERROR &&
+		myStringParseInts(myString, ',', out, 8, NULL, NULL) == MYSTRING_ERROR)
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("Returns error as expected, because of bad argument.\n");
 	}
 	else
 	{
-		printf("myString1 and myString2 are not equal\n");
+		printf("ERROR in myStringParseInts()\n");
 	}
 
-	printf("Setting myString2 to NULL\n");
-	freeString(myString2);
-	myString2->_string = NULL;
+	myStringFree(myString);
+	printf("\n");
+}
 
-	equal = myStringEqual(myString1, myString2);
-	if (equal == MYSTR_ERROR_CODE)
+/**
+ * @brief Unit-testing to myStringSetAllocator()
+ */
+void testMyStringSetAllocator()
+{
+	printf("Testing myStringSetAllocator()...\n");
+	TestAllocator testAllocator = {0, SIZE_MAX, 0};
+
+	printf("Setting an allocator that counts allocations\n");
+	if (myStringSetAllocator(testMalloc, testRealloc, testFree, &testAllocator) == MYSTRING_ERROR)
 	{
-		perror ("ERROR as expected because can't compare\n");
+		printf("ERROR in myStringSetAllocator()\n\n");
+		return;
 	}
-	else if (equal > 0)
+
+	printf("Allocating 2 MyStrings set to \"hello\" and \"world!\"\n");
+	MyString* myString1 = myStringAlloc();
+	MyString* myString2 = myStringAlloc();
+	myStringSetFromCString(myString1, "hello");
+	myStringSetFromCString(myString2, "world!");
+	bool success = testAllocator._allocations == 4 &&
+				   myStringSetAllocator(NULL, NULL, NULL, NULL) == MYSTRING_ERROR;
+	// The overhead of a custom allocator is unknown, so only the bytes asked of it are counted
+	success = success && myStringMemUsage(myString1) + myStringMemUsage(myString2) ==
+			  testAllocator._bytes;
+
+	printf("Failing every allocation\n");
+	testAllocator._failAfter = testAllocator._allocations;
+	MyString* arr[] = {myString1, myString2};
+	size_t count;
+
+	// The values don't fit in the string of myString1, so setting them must allocate
+	success = success && myStringSetFromCString(myString1, "abcdef") == MYSTRING_ERROR &&
+			  myStringSetFromInt(myString1, 1234567) == MYSTRING_ERROR &&
+			  myStringSetFromMyString(myString1, myString2) == MYSTRING_ERROR &&
+			  myStringCat(myString1, myString2) == MYSTRING_ERROR &&
+			  myStringCatTo(myString2, myString2, myString1) == MYSTRING_ERROR &&
+			  myStringClone(myString1) == NULL &&
+			  myStringKeySort(arr, 2, NULL) == MYSTRING_ERROR &&
+			  myStringCountDistinct(arr, 2, &count) == MYSTRING_ERROR &&
+			  myStringLen(myString1) == 5 && memcmp(myStringData(myString1), "hello", 5) == 0;
+
+	// Without room for the terminating '\0', freezing myString1 must allocate
+	size_t capacity = myString1->_capacity;
+	myString1->_capacity = myString1->_length;
+	success = success && myStringFreeze(myString1) == MYSTRING_ERROR &&
+			  !myStringIsFrozen(myString1);
+	myString1->_capacity = capacity;
+	if (success)
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("Success. The allocations were counted, and failed without changing myString1\n");
 	}
 	else
 	{
-		printf("myString1 and myString2 are not equal\n");
+		printf("ERROR in myStringSetAllocator()\n");
 	}
 
 	myStringFree(myString1);
 	myStringFree(myString2);
+	if (myStringSetAllocator(NULL, NULL, NULL, NULL) == MYSTRING_SUCCESS)
+	{
+		printf("Success. The default allocator is set back\n");
+	}
+	else
+	{
+		printf("ERROR in myStringSetAllocator()\n");
+	}
 	printf("\n");
 }
 
 /**
- * @brief Unit-testing to myStringCustomEqual()
+ * @brief Unit-testing to the MyStringBuilder functions
  */
-void testMyStringCustomEqual()
+void testMyStringBuilder()
 {
-	printf("Testing myStringCustomEqual()...\n");
+	printf("Testing MyStringBuilder...\n");
+	TestAllocator testAllocator = {0, SIZE_MAX, 0};
+	bool counting = myStringSetAllocator(testMalloc, testRealloc, testFree,
+										 &testAllocator) == MYSTRING_SUCCESS;
 
-	printf("Allocating a new empty MyString to myString1\n");
+	printf("Appending a char, a C string, a MyString, ints, a double and a format\n");
+	MyStringBuilder* builder = myStringBuilderAlloc(0);
 	MyString* myString1 = myStringAlloc();
-	printf("Setting myString1 to \"abc\"\n");
-	myStringSetFromCString(myString1, "abc");
-
-	printf("Allocating a new empty MyString to myString2\n");
 	MyString* myString2 = myStringAlloc();
-	printf("Setting myString2 to \"def\"\n");
-	myStringSetFromCString(myString2, "def");
-
-	int (*comparator)(const char, const char);
-	comparator = defaultComparator;
-
-	int equal = myStringCustomEqual(myString1, myString2, comparator);
-	if (equal == MYSTR_ERROR_CODE)
+	myStringSetFromCString(myString1, "abc");
+	myStringBuilderAppendChar(builder, '[');
+	myStringBuilderAppendCString(builder, "x=");
+	myStringBuilderAppendMyString(builder, myString1);
+	myStringBuilderAppendInt(builder, -42);
+	myStringBuilderAppendInt(builder, INT_MIN);
+	myStringBuilderAppendDouble(builder, 0.5);
+	myStringBuilderAppendf(builder, "%s:%05d]", "pad", 7);
+	const char* expected = "[x=abc-42-21474836480.5pad:00007]";
+
+	bool success = myStringBuilderBuild(builder, myString2) == MYSTRING_SUCCESS &&
+				   myStringLen(myString2) == strlen(expected) &&
+				   memcmp(myStringData(myString2), expected, strlen(expected)) == 0 &&
+				   myStringBuilderLen(builder) == 0;
+	if (success)
 	{
-		perror ("ERROR in myStringCustomEqual\n");
+		printf("Success. myString2 is \"%s\"\n", expected);
 	}
-	else if (equal > 0)
+	else
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("ERROR in MyStringBuilder\n");
+	}
+
+	printf("Formatting a string longer than the buffer\n");
+	char longString[200];
+	memset(longString, 'z', sizeof(longString) - 1);
+	longString[sizeof(longString) - 1] = '\0';
+	success = myStringBuilderAppendf(builder, "<%s>", longString) == MYSTRING_SUCCESS &&
+			  myStringBuilderBuild(builder, myString2) == MYSTRING_SUCCESS &&
+			  myStringLen(myString2) == strlen(longString) + 2 &&
+			  myStringData(myString2)[strlen(longString)] == 'z' &&
+			  myStringData(myString2)[strlen(longString) + 1] == '>';
+	if (success)
+	{
+		printf("Success. The buffer grew and the string was formatted again\n");
 	}
 	else
 	{
-		printf("myString1 and myString2 are not equal\n");
+		printf("ERROR in myStringBuilderAppendf()\n");
 	}
 
-	printf("Setting myString2 to \"abc\"\n");
-	myStringSetFromCString(myString2, "abc");
-
-	equal = myStringCustomEqual(myString1, myString2, comparator);
-	if (equal == MYSTR_ERROR_CODE)
+	printf("Building into myString2 1000 times\n");
+	size_t allocations = testAllocator._allocations;
+	int i;
+	for (i = 0; i < 1000 && success; i++)
 	{
-		perror ("ERROR in myStringCustomEqual\n");
+		myStringBuilderReset(builder);
+		success = myStringBuilderAppendf(builder, "line %d: ", i) == MYSTRING_SUCCESS &&
+				  myStringBuilderAppendMyString(builder, myString1) == MYSTRING_SUCCESS &&
+				  myStringBuilderBuild(builder, myString2) == MYSTRING_SUCCESS;
 	}
-	else if (equal > 0)
+	if (success && counting && testAllocator._allocations == allocations)
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("Success. The buffers were reused without allocating\n");
 	}
-	else
+	else if (success && !counting)
 	{
-		printf("myString1 and myString2 are not equal\n");
+		printf("Success. The allocations can't be counted, memory is still allocated\n");
 	}
-
-	printf("Setting myString2 to NULL\n");
-	freeString(myString2);
-	myString2->_string = NULL;
-
-	equal = myStringCustomEqual(myString1, myString2, comparator);
-	if (equal == MYSTR_ERROR_CODE)
+	else
 	{
-		perror("ERROR as expected\n");
+		printf("ERROR in myStringBuilderBuild()\n");
 	}
-	else if (equal > 0)
+
+	printf("Building into a frozen MyString\n");
+	myStringFreeze(myString1);
+	if (myStringBuilderBuild(builder, myString1) == MYSTRING_ERROR &&
+		myStringBuilderAppendf(NULL, "%d", 1) == MYSTRING_ERROR)
 	{
-		printf("myString1 and myString2 are equal\n");
+		printf("Returns error as expected, because of bad argument.\n");
 	}
 	else
 	{
-		printf("myString1 and myString2 are not equal\n");
+		printf("ERROR in myStringBuilderBuild()\n");
 	}
 
+	myStringBuilderFree(builder);
 	myStringFree(myString1);
 	myStringFree(myString2);
+	if (counting)
+	{
+		myStringSetAllocator(NULL, NULL, NULL, NULL);
+	}
 	printf("\n");
 }
 
 /**
- * @brief Unit-testing to myStringMemUsage()
+ * @brief Used as the transform of myStringKeySort() in testMyStringKeySort(). Sets key to str in
+ * 		  lower case.
+ * @param str
+ * @param key
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
  */
-void testMyStringMemUsage()
+static MyStringRetVal lowerCaseKey(const MyString* str, MyString* key)
 {
-	printf("Testing myStringMemUsage()...\n");
-
-	printf("Allocating a new empty MyString to myString\n");
-	MyString* myString = myStringAlloc();
-	printf("Setting myString to \"abc\"\n");
-	myStringSetFromCString(myString, "abc");
-
-	unsigned long memory = myStringMemUsage(myString);
+	if (myStringSetFromMyString(key, str) == MYSTRING_ERROR)
+	{
+		return MYSTRING_ERROR;
+	}
 
-	printf("Memory usage of myString: %lu", memory);
+	size_t i;
+	for (i = 0; i < key->_length; i++)
+	{
+		key->_string[i] = (char)tolower((unsigned char)key->_string[i]);
+	}
 
-	myStringFree(myString);
-	printf("\n");
+	return MYSTRING_SUCCESS;
 }
 
 /**
- * @brief Unit-testing to myStringLen()
+ * @brief Unit-testing to myStringKeySort()
  */
-void testMyStringLen()
+void testMyStringKeySort()
 {
-	printf("Testing myStringLen()...\n");
+	printf("Testing myStringKeySort()...\n");
 
-	printf("Allocating a new empty MyString to myString2\n");
-	MyString* myString = myStringAlloc();
-	printf("Setting myString to \"abc\"\n");
-	myStringSetFromCString(myString, "abc");
-
-	unsigned long len = myStringLen(myString);
-
-	printf("Length of myString: %lu", len);
-
-	myStringFree(myString);
-	printf("\n");
-}
+	const char* values[] = {"Banana split", "apple pie", "banana bread", "APPLE", "b", "apple pie!"};
+	const char* expected[] = {"APPLE", "apple pie", "apple pie!", "b", "banana bread",
+							  "Banana split"};
+	MyString* arr[6];
+	int i;
 
-/**
- * @brief Unit-testing to myStringWrite()
- */
-void testMyStringWrite()
-{
-	printf("Testing myStringWrite()...\n");
+	printf("Allocating 6 MyStrings with long common prefixes\n");
+	for (i = 0; i < 6; i++)
+	{
+		arr[i] = myStringAlloc();
+		myStringSetFromCString(arr[i], values[i]);
+	}
 
-	printf("Allocating a new empty MyString to myString\n");
-	MyString* myString = myStringAlloc();
-	printf("Setting myString to \"abc\"\n");
-	myStringSetFromCString(myString, "abc");
+	printf("Sorting by the lower case keys\n");
+	bool success = myStringKeySort(arr, 6, lowerCaseKey) == MYSTRING_SUCCESS;
 
-	FILE* stream = fopen("testWrite.txt", "w");
+	for (i = 0; i < 6 && success; i++)
+	{
+		char* res = myStringToCString(arr[i]);
+		success = strcmp(res, expected[i]) == 0;
+		free(res);
+	}
 
-	if (myStringWrite(myString, stream) == MYSTRING_SUCCESS)
+	if (success)
 	{
-		printf("Wrote myString to  test.txt successfully\n");
+		printf("Sorting success. The strings are in case insensitive order\n");
 	}
 	else
 	{
-		printf("ERROR\n");
+		printf("ERROR in myStringKeySort()\n");
 	}
 
-	fclose(stream);
-	myStringFree(myString);
-	printf("\n");
-}
-
-/**
- * @brief Unit-testing to myStringCustomSort()
- */
-void testMyStringCustomSort()
-{
-	printf("Testing myStringCustomSort()...\n");
-
-	printf("Allocating a new empty MyString to myString1\n");
-	MyString* myString1 = myStringAlloc();
-	printf("Setting myString to \"abb\"\n");
-	myStringSetFromCString(myString1, "abb");
-
-	printf("Allocating a new empty MyString to myString2\n");
-	MyString* myString2 = myStringAlloc();
-	printf("Setting myString to \"aab\"\n");
-	myStringSetFromCString(myString2, "aab");
-
-	printf("Allocating a new empty MyString to myString3\n");
-	MyString* myString3 = myStringAlloc();
-	printf("Setting myString to \"bbb\"\n");
-	myStringSetFromCString(myString3, "bbb");
-
-	printf("Allocating a new empty MyString to myString4\n");
-	MyString* myString4 = myStringAlloc();
-	printf("Setting myString to \"aaa\"\n");
-	myStringSetFromCString(myString4, "aaa");
-
-	MyString* arr[] = {myString1, myString2, myString3, myString4};
-
-	myStringCustomSort(arr, 4, myStringComparatorCasting);
+	printf("Sorting with the strings as keys\n");
+	myStringKeySort(arr, 6, NULL);
 
-	int i;
-	FILE* stream = fopen("testSort.txt", "w");
+	for (i = 1; i < 6 && success; i++)
+	{
+		success = myStringCompare(arr[i - 1], arr[i]) <= 0;
+	}
 
-	for (i = 0; i < 4; i++)
+	if (success)
 	{
-		myStringWrite(arr[i], stream);
+		printf("Sorting success. The strings are in the default order\n");
+	}
+	else
+	{
+		printf("ERROR in myStringKeySort()\n");
 	}
 
-	printf("Sorting success. Results in testSort.txt.\n");
+	printf("Sorting an array with a NULL MyString\n");
+	MyString* withNull[2] = {arr[0], NULL};
+	if (myStringKeySort(withNull, 2, lowerCaseKey) == MYSTRING_ERROR && withNull[0] == arr[0])
+	{
+		printf("Returns error as expected, because of a NULL MyString\n");
+	}
+	else
+	{
+		printf("ERROR in myStringKeySort()\n");
+	}
 
-	myStringFree(myString1);
-	myStringFree(myString2);
-	myStringFree(myString3);
-	myStringFree(myString4);
-	fclose(stream);
+	for (i = 0; i < 6; i++)
+	{
+		myStringFree(arr[i]);
+	}
 	printf("\n");
 }
 
 /**
- * @brief Unit-testing to myStringSort()
+ * @brief Unit-testing to myStringNaturalSort()
  */
-void testMyStringSort()
+void testMyStringNaturalSort()
 {
-	printf("Testing myStringSort()...\n");
-
-	printf("Allocating a new empty MyString to myString1\n");
-	MyString* myString1 = myStringAlloc();
-	printf("Setting myString to \"abb\"\n");
-	myStringSetFromCString(myString1, "abb");
-
-	printf("Allocating a new empty MyString to myString2\n");
-	MyString* myString2 = myStringAlloc();
-	printf("Setting myString to \"aab\"\n");
-	myStringSetFromCString(myString2, "aab");
-
-	printf("Allocating a new empty MyString to myString3\n");
-	MyString* myString3 = myStringAlloc();
-	printf("Setting myString to \"bbb\"\n");
-	myStringSetFromCString(myString3, "bbb");
+	printf("Testing myStringNaturalSort()...\n");
+
+	const char* values[] = {"v1.10.2", "file10", "x", "v1.9.12", "file9", "file", "file0",
+							"file100000000000000000000000", "v1.10.10",
+							"file99999999999999999999999", "file007"};
+	const char* expected[] = {"file", "file0", "file007", "file9", "file10",
+							  "file99999999999999999999999", "file100000000000000000000000",
+							  "v1.9.12", "v1.10.2", "v1.10.10", "x"};
+	MyString* arr[13];
+	char digits[200];
+	int i;
 
-	printf("Allocating a new empty MyString to myString4\n");
-	MyString* myString4 = myStringAlloc();
-	printf("Setting myString to \"aaa\"\n");
-	myStringSetFromCString(myString4, "aaa");
+	printf("Allocating MyStrings with numbers of different lengths\n");
+	for (i = 0; i < 11; i++)
+	{
+		arr[i] = myStringAlloc();
+		myStringSetFromCString(arr[i], values[i]);
+	}
 
-	MyString* arr[] = {myString1, myString2, myString3, myString4};
+	printf("Sorting in natural order\n");
+	bool success = myStringNaturalSort(arr, 11) == MYSTRING_SUCCESS;
 
-	myStringSort(arr, 4);
+	for (i = 0; i < 11 && success; i++)
+	{
+		char* res = myStringToCString(arr[i]);
+		success = strcmp(res, expected[i]) == 0;
+		free(res);
+	}
 
-	int i;
-	FILE* stream = fopen("test2Sort.txt", "w");
+	if (success)
+	{
+		printf("Sorting success. The numbers are in numeric order\n");
+	}
+	else
+	{
+		printf("ERROR in myStringNaturalSort()\n");
+	}
 
-	for (i = 0; i < 4; i++)
+	printf("Sorting numbers with lengths of more than one byte\n");
+	arr[11] = myStringAlloc();
+	arr[12] = myStringAlloc();
+	memset(digits, '1', 200);
+	myStringSetFromBuffer(arr[11], digits, 200);
+	memset(digits, '9', 200);
+	myStringSetFromBuffer(arr[12], digits, 127);
+	success = myStringNaturalSort(arr + 11, 2) == MYSTRING_SUCCESS &&
+			  myStringLen(arr[11]) == 127 && myStringLen(arr[12]) == 200;
+
+	if (success)
 	{
-		myStringWrite(arr[i], stream);
+		printf("Sorting success. The shorter number is first\n");
+	}
+	else
+	{
+		printf("ERROR in myStringNaturalSort()\n");
 	}
 
-	printf("Sorting success. Results in testSort.txt.\n");
+	printf("Sorting an array with a NULL MyString\n");
+	MyString* withNull[2] = {arr[0], NULL};
+	if (myStringNaturalSort(withNull, 2) == MYSTRING_ERROR && withNull[0] == arr[0])
+	{
+		printf("Returns error as expected, because of a NULL MyString\n");
+	}
+	else
+	{
+		printf("ERROR in myStringNaturalSort()\n");
+	}
 
-	myStringFree(myString1);
-	myStringFree(myString2);
-	myStringFree(myString3);
-	myStringFree(myString4);
-	fclose(stream);
+	for (i = 0; i < 13; i++)
+	{
+		myStringFree(arr[i]);
+	}
 	printf("\n");
 }
 
@@ -1583,20 +7850,44 @@ int main()
 	testMyStringSetFromMyString();
 	testMyStringFilter();
 	testMyStringSetFromCString();
+	testMyStringSetFromBuffer();
 	testMyStringSetFromInt();
 	testMyStringToInt();
 	testMyStringToCString();
+	testMyStringCStr();
 	testMyStringCat();
 	testMyStringCatTo();
+	testMyStringCatMany();
+	testMyStringMove();
 	testMyStringCompare();
 	testMyStringCustomCompare();
 	testMyStringEqual();
 	testMyStringCustomEqual();
 	testMyStringMemUsage();
+	testMyStringMemInfo();
 	testMyStringLen();
 	testMyStringWrite();
 	testMyStringCustomSort();
 	testMyStringSort();
+	testMyStringDefineComparator();
+	testMyStringKeySort();
+	testMyStringNaturalSort();
+	testMyStringPartialSort();
+	testMyStringNthElement();
+	testMyStringUnique();
+	testMyStringCountDistinct();
+	testMyStringFreeze();
+	testCrossThreadFree();
+	testMyStringHashSet();
+	testMyStringArray();
+	testMyStringCompress();
+	testMyStringUtf8();
+	testMyStringCase();
+	testMyStringReplace();
+	testMyStringParseInts();
+	testMyStringStats();
+	testMyStringSetAllocator();
+	testMyStringBuilder();
 	return 0;
 }
 
@@ -26,12 +26,20 @@
  * Most functions may fail due to failure to allocate dynamic memory. When
  * this happens the functions will return an appropriate failure value. If this
  * happens, then the state of the other outputs of the function is undefined.
+ *
+ * Thread safety
+ * ~~~~~~~~~~~~~
+ * A MyString may be used by a single thread at a time. A MyString frozen by
+ * myStringFreeze can't be changed anymore, so any number of threads may read it
+ * concurrently. Every thread takes its own reference with myStringRetain and
+ * releases it with myStringFree; the MyString is freed with its last reference.
  ********************************************************************************/
 
 // ------------------------------ includes ------------------------------
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -42,12 +50,64 @@
 */
 #define MYSTR_ERROR_CODE -999
 
+/*
+ * returned by myStringNextCodepoint at the end of the string
+ */
+#define MYSTR_END_CODE -1
+
 /*
  * MyString represents a manipulable string.
  */
 struct _MyString;
 typedef struct _MyString MyString;
 
+/*
+ * MyStringHashSet is a set of frozen MyStrings that many threads may insert to and look up
+ * in concurrently, without locking.
+ */
+struct _MyStringHashSet;
+typedef struct _MyStringHashSet MyStringHashSet;
+
+/*
+ * MyStringBuilder composes a string by appending to a growing buffer, and hands the buffer off to
+ * a MyString when it is done.
+ */
+struct _MyStringBuilder;
+typedef struct _MyStringBuilder MyStringBuilder;
+
+/*
+ * MyStringArray is an array of frozen, read-only MyStrings loaded by myStringArrayLoad, whose
+ * strings are in a file mapped to memory instead of being copied.
+ */
+struct _MyStringArray;
+typedef struct _MyStringArray MyStringArray;
+
+/*
+ * Statistics of the library, counted when it is built with MYSTRING_STATS
+ */
+typedef struct
+{
+	unsigned long long allocations; // The number of allocations by the library
+	unsigned long long frees; // The number of allocations freed by the library
+	unsigned long long bytesAllocated; // The number of bytes allocated
+	unsigned long long bytesFreed; // The number of bytes freed by the library
+	unsigned long long copies; // The number of copies of strings
+	unsigned long long bytesCopied; // The number of bytes copied
+} MyStringStats;
+
+/*
+ * The memory used by a MyString, returned by myStringMemInfo
+ */
+typedef struct
+{
+	unsigned long objectBytes; // The bytes taken by the MyString object itself
+	unsigned long stringBytes; // The bytes taken by the allocated string
+	unsigned long capacity; // The number of chars allocated to the string
+	unsigned long length; // The number of chars used by the string
+	unsigned int references; // The number of owners sharing a frozen MyString, 1 otherwise
+	bool compressed; // Whether the string is compressed by myStringCompress
+} MyStringMemInfo;
+
 /* Return values */
 typedef enum 
 {
@@ -70,6 +130,7 @@ MyString * myStringAlloc();
 
 /**
  * @brief Frees the memory and resources allocated to str.
+ * 	If str is frozen, releases one reference to it, and frees it only when no references are left.
  * @param str the MyString to free.
  * If str is NULL, no operation is performed.
  */
@@ -105,6 +166,67 @@ MyStringRetVal myStringSetFromMyString(MyString *str, const MyString *other);
  *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure. */
 MyStringRetVal myStringFilter(MyString *str, bool (*filt)(const char *));
 
+/**
+ * @brief Converts the ASCII letters of str to lower case, in place. Other chars (including the
+ * 	chars of UTF-8 sequences) are not changed.
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (if str is NULL or frozen).
+ */
+MyStringRetVal myStringToLower(MyString *str);
+
+/**
+ * @brief Converts the ASCII letters of str to upper case, in place, like myStringToLower.
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (if str is NULL or frozen).
+ */
+MyStringRetVal myStringToUpper(MyString *str);
+
+/**
+ * @brief Replaces every char ch of str by table[(uint8_t)ch], in place.
+ * @param str
+ * @param table the char to replace every one of the 256 chars by
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (if str or table is NULL, or
+ *  str is frozen).
+ */
+MyStringRetVal myStringTranslate(MyString *str, const uint8_t table[256]);
+
+/**
+ * @brief Removes the whitespace (' ', '\t', '\n', '\v', '\f' and '\r') from the start and the
+ * 	end of str, in place.
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (if str is NULL or frozen).
+ */
+MyStringRetVal myStringTrim(MyString *str);
+
+/**
+ * @brief Replaces the first occurrence of from in str by to. If to is not longer than from, str
+ * 	is changed in place, otherwise its new string is allocated once. from and to may be str.
+ * @param str
+ * @param from the chars to look for, which must not be empty
+ * @param to the chars to put instead
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success (even if from wasn't found), MYSTRING_ERROR on failure
+ *  (and str is not changed).
+ */
+MyStringRetVal myStringReplace(MyString *str, const MyString *from, const MyString *to);
+
+/**
+ * @brief Replaces every occurrence of from in str by to, from the start of str and without
+ * 	overlapping. The occurrences are counted first, so the result is made in place if to is not
+ * 	longer than from, or in a single allocation of its final size otherwise.
+ * @param str
+ * @param from the chars to look for, which must not be empty
+ * @param to the chars to put instead
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success (even if from wasn't found), MYSTRING_ERROR on failure
+ *  (and str is not changed).
+ */
+MyStringRetVal myStringReplaceAll(MyString *str, const MyString *from, const MyString *to);
+
 
 /**
  * @brief Sets the value of str to the value of the given C string.
@@ -117,6 +239,17 @@ MyStringRetVal myStringFilter(MyString *str, bool (*filt)(const char *));
  */
 MyStringRetVal myStringSetFromCString(MyString *str, const char * cString);
 
+/**
+ * @brief Sets the value of str to the first len chars of buf, which may include null characters.
+ * 	The string of str is reused if the chars fill at least half of it.
+ * @param str the MyString to set.
+ * @param buf the chars to set from, may be NULL if len is 0.
+ * @param len
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and str is not changed).
+ */
+MyStringRetVal myStringSetFromBuffer(MyString *str, const char *buf, size_t len);
+
 
 /**
  * @brief Sets the value of str to the value of the integer n.
@@ -136,11 +269,31 @@ MyStringRetVal myStringSetFromInt(MyString *str, int n);
  * 	If str cannot be parsed as an integer, 
  * 	the return value should be MYSTR_ERROR_CODE
  * 	NOTE: positive and negative integers should be supported.
+ * 	An empty string, a sign without digits and a number out of the range of int can't be
+ * 	parsed.
  * @param str the MyString 
  * @return an integer
  */
 int myStringToInt(const MyString *str);
 
+/**
+ * @brief Parses a list of integers separated by sep, like "1, -2, +3" with sep ','. Whitespace
+ * 	around the integers is skipped; if sep is whitespace itself, every run of whitespace
+ * 	separates two integers. An empty list (or one of whitespace only) has no integers.
+ * @param str the MyString
+ * @param sep the separator
+ * @param out set to the integers
+ * @param cap the maximal number of integers in out
+ * @param count set to the number of integers set in out, also on failure
+ * @param errorOffset if it isn't NULL, set on failure to the offset in str of the integer that
+ * 	is out of the range of int64_t or doesn't fit in out, or of the first char that can't be
+ * 	parsed (the length of str if it ended too early)
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringParseInts(const MyString *str, char sep, int64_t *out, size_t cap,
+								 size_t *count, size_t *errorOffset);
+
 
 /**
  * @brief Returns the value of str as a C string, terminated with the
@@ -152,6 +305,19 @@ int myStringToInt(const MyString *str);
  */
 char * myStringToCString(const MyString *str);
 
+/**
+ * @brief Returns the value of str as a C string borrowed from str: its own string, terminated
+ * 	with the null character in the char kept after it. Nothing is allocated or copied, unless
+ * 	the string of str has no room left for the null character.
+ * 	The pointer is valid until the next change to str, and must not be freed. A frozen MyString
+ * 	is terminated when it is frozen, so it may be read by many threads at once.
+ * @param str the MyString
+ * RETURN VALUE:
+ *  @return the C string, "" if str was never set, or NULL if str is NULL or the allocation
+ *  failed.
+ */
+const char * myStringCStr(MyString *str);
+
 
 /**
  * @brief Appends a copy of the source MyString src to the destination MyString dst.
@@ -174,6 +340,82 @@ MyStringRetVal myStringCat(MyString * dest, const MyString * src);
  */
 MyStringRetVal myStringCatTo(const MyString *str1, const MyString *str2, MyString *result);
 
+/**
+ * @brief Sets result to be the concatenation of the n MyStrings of parts, in order.
+ * 	The string is allocated once, and every part is copied once. result may also be one (or
+ * 	more) of the parts, which are then concatenated with the old value of result.
+ * @param result
+ * @param parts
+ * @param n the number of parts
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and result is not changed).
+ */
+MyStringRetVal myStringCatMany(MyString *result, const MyString **parts, size_t n);
+
+/**
+ * @brief Moves the value of src to dst without copying it: dst takes the string of src, and src
+ * 	is left like a new MyString. Moving a MyString to itself does nothing.
+ * @param dst
+ * @param src
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (if one of them is NULL or
+ *  frozen).
+ */
+MyStringRetVal myStringMove(MyString *dst, MyString *src);
+
+/**
+ * @brief Swaps the values of str1 and str2 without copying them.
+ * @param str1
+ * @param str2
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (if one of them is NULL or
+ *  frozen).
+ */
+MyStringRetVal myStringSwap(MyString *str1, MyString *str2);
+
+/**
+ * @brief Allocates a buffer of capacity chars for myStringAdoptBuffer, with the allocator of the
+ * 	library. It is the caller's responsibility to give it to a MyString, or to free it with
+ * 	myStringBufferFree.
+ * @param capacity
+ * RETURN VALUE:
+ *  @return a pointer to the buffer, or NULL if the allocation failed.
+ */
+char * myStringBufferAlloc(size_t capacity);
+
+/**
+ * @brief Frees a buffer of myStringBufferAlloc or myStringReleaseBuffer.
+ * @param buf If NULL, no operation is performed.
+ * @param capacity the number of chars allocated to buf
+ */
+void myStringBufferFree(char *buf, size_t capacity);
+
+/**
+ * @brief Sets the value of str to the first len chars of buf, without copying them: str takes
+ * 	buf as its string, and frees it like its other strings.
+ * 	buf must be allocated by myStringBufferAlloc or released by myStringReleaseBuffer.
+ * @param str
+ * @param buf
+ * @param len the number of chars of the value
+ * @param capacity the number of chars allocated to buf
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and buf is still owned by the
+ *  caller).
+ */
+MyStringRetVal myStringAdoptBuffer(MyString *str, char *buf, size_t len, size_t capacity);
+
+/**
+ * @brief Takes the string of str without copying it, and leaves str like a new MyString.
+ * 	It is the caller's responsibility to give the string to a MyString by myStringAdoptBuffer,
+ * 	or to free it with myStringBufferFree. The chars are not terminated by the null character.
+ * @param str
+ * @param len set to the number of chars of the string
+ * @param capacity set to the number of chars allocated to the string
+ * RETURN VALUE:
+ *  @return the string, or NULL if str is NULL, frozen or was never set.
+ */
+char * myStringReleaseBuffer(MyString *str, size_t *len, size_t *capacity);
+
 /**
  * @brief Compare str1 and str2.
  * @param str1
@@ -241,15 +483,91 @@ int myStringCustomEqual(const MyString* str1, const MyString* str2,
 
 /**
  * @return the amount of memory (all the memory that used by the MyString object itself
- * and its allocations), in bytes, allocated to str1.
+ * and its allocations, including the overhead of the allocator and unused capacity), in bytes,
+ * allocated to str1. The overhead of the default allocator is estimated from glibc's malloc,
+ * and that of an allocator set by myStringSetAllocator is not counted.
  */
 unsigned long myStringMemUsage(const MyString *str1);
 
+/**
+ * @brief Sets info to the details of the memory used by str. The share of every owner of a
+ * 	frozen MyString is (info->objectBytes + info->stringBytes) / info->references.
+ * @param str
+ * @param info
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringMemInfo(const MyString *str, MyStringMemInfo *info);
+
+/**
+ * @brief Compresses the string of str to save memory while str is not used, with a fast LZ77
+ * 	codec. The value of str doesn't change: the first function reading str decompresses it back.
+ * 	Meant for cold strings of repetitive text (logs, markup, JSON); strings shorter than 64
+ * 	chars, or that don't shrink by at least an eighth, are left as they are.
+ * 	Compressing a compressed MyString does nothing.
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success (even if str was left as it is), MYSTRING_ERROR on failure
+ *  (if str is NULL or frozen, or the allocation failed).
+ */
+MyStringRetVal myStringCompress(MyString *str);
+
+/**
+ * @brief Check if the string of str is compressed by myStringCompress.
+ * @param str
+ * RETURN VALUE:
+ *  @return true if str is compressed, false otherwise (or if str is NULL).
+ */
+bool myStringIsCompressed(const MyString *str);
+
+/**
+ * @return the number of bytes allocated by the library for MyStrings, their strings and its other
+ * structures that are not freed yet, including the overhead of the allocator (like in
+ * myStringMemUsage). Cheap enough to be polled often.
+ */
+long long myStringLiveBytes();
+
+/**
+ * @return the number of MyStrings that are allocated and not freed yet. Cheap enough to be polled
+ * often.
+ */
+long long myStringLiveObjects();
+
+/**
+ * @brief Sets the allocator of the library, e.g. a faster allocator, or one that fails on purpose
+ * 	to test the handling of allocation failures. mallocFn, reallocFn and freeFn are called like
+ * 	malloc, realloc and free, with ctx as their last argument. Passing NULL for all of them
+ * 	restores the default allocator.
+ * 	Must be called when the library has no memory allocated (see myStringLiveBytes), and not
+ * 	concurrently with other functions of the library. The C strings of myStringToCString are
+ * 	still allocated by malloc, since the caller frees them by calling free().
+ * @param mallocFn
+ * @param reallocFn
+ * @param freeFn
+ * @param ctx
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (if only some of the functions
+ *  are NULL, or the library has memory allocated).
+ */
+MyStringRetVal myStringSetAllocator(void* (*mallocFn)(size_t size, void* ctx),
+									void* (*reallocFn)(void* ptr, size_t size, void* ctx),
+									void (*freeFn)(void* ptr, void* ctx), void* ctx);
+
 /**
  * @return the length of the string in str1.
  */
 unsigned long myStringLen(const MyString *str1);
 
+/**
+ * @brief Returns a read-only pointer to the chars of str. The chars are not terminated by the
+ * 	null character, use myStringLen() to get their number.
+ * 	The pointer is valid until the next change to str.
+ * @param str the MyString
+ * RETURN VALUE:
+ *  @return pointer to the chars of str, or NULL if str is NULL or was never set.
+ */
+const char * myStringData(const MyString *str);
+
 /**
  * Writes the content of str to stream. (like fputs())
  *
@@ -258,6 +576,39 @@ unsigned long myStringLen(const MyString *str1);
  */
 MyStringRetVal myStringWrite(const MyString *str, FILE *stream);
 
+/**
+ * @brief Check if the chars of str are valid UTF-8: no overlong encodings, no surrogates and no
+ * 	code points above U+10FFFF. The result is kept in str, so checking it again is free until
+ * 	str is changed.
+ * @param str
+ * RETURN VALUE:
+ *  @return true if str is valid UTF-8, false otherwise (or if str is NULL).
+ */
+bool myStringValidateUtf8(const MyString *str);
+
+/**
+ * @brief Counts the code points of str, which must be valid UTF-8. Like myStringValidateUtf8,
+ * 	the count is kept in str until it is changed.
+ * @param str
+ * RETURN VALUE:
+ *  @return the number of code points, or MYSTR_ERROR_CODE if str is NULL or not valid UTF-8.
+ */
+long myStringCodepointLen(const MyString *str);
+
+/**
+ * @brief Decodes the UTF-8 code point starting at the char *offset of str, and advances *offset
+ * 	to the char after it. Start with *offset = 0 to iterate over all the code points:
+ * 		size_t offset = 0;
+ * 		int codepoint;
+ * 		while ((codepoint = myStringNextCodepoint(str, &offset)) >= 0) { ... }
+ * @param str
+ * @param offset the offset in chars, not in code points
+ * RETURN VALUE:
+ *  @return the code point, MYSTR_END_CODE at the end of str, or MYSTR_ERROR_CODE if str or
+ *  offset is NULL, or the chars at *offset are not valid UTF-8 (and *offset is not changed).
+ */
+int myStringNextCodepoint(const MyString *str, size_t *offset);
+
 /**
  * @brief sort an array of MyString pointers
  * @param arr
@@ -277,7 +628,594 @@ void myStringCustomSort(MyString** arr, size_t len, int (*comparator)(const void
  * RETURN VALUE: none
   */
 void myStringSort(MyString** arr, size_t len);
- 
+
+/**
+ * @brief sorts the k smallest MyStrings of an array of MyString pointers into its first k
+ * 	places, using a custom comparator (like in myStringCustomSort). The order of the other
+ * 	places is unspecified.
+ * 	If k is bigger than len, the whole array is sorted.
+ * @param arr
+ * @param len
+ * @param k
+ * @param comparator custom comparator
+ *
+ * RETURN VALUE: none
+  */
+void myStringCustomPartialSort(MyString** arr, size_t len, size_t k,
+							   int (*comparator)(const void*, const void*));
+
+/**
+ * @brief sorts the k smallest MyStrings of an array of MyString pointers into its first k
+ * 	places, according to the default comparison (like in myStringCompare). The order of the
+ * 	other places is unspecified.
+ * 	If k is bigger than len, the whole array is sorted.
+ * @param arr
+ * @param len
+ * @param k
+ *
+ * RETURN VALUE: none
+  */
+void myStringPartialSort(MyString** arr, size_t len, size_t k);
+
+/**
+ * @brief reorders an array of MyString pointers so that arr[n] is the MyString that would be in
+ * 	that place if the array was sorted with the custom comparator (like in myStringCustomSort),
+ * 	no MyString before it is bigger than it and no MyString after it is smaller than it.
+ * 	If n is not smaller than len, no operation is performed.
+ * @param arr
+ * @param len
+ * @param n
+ * @param comparator custom comparator
+ *
+ * RETURN VALUE: none
+  */
+void myStringCustomNthElement(MyString** arr, size_t len, size_t n,
+							  int (*comparator)(const void*, const void*));
+
+/**
+ * @brief reorders an array of MyString pointers so that arr[n] is the MyString that would be in
+ * 	that place if the array was sorted according to the default comparison (like in
+ * 	myStringCompare), no MyString before it is bigger than it and no MyString after it is smaller
+ * 	than it.
+ * 	If n is not smaller than len, no operation is performed.
+ * @param arr
+ * @param len
+ * @param n
+ *
+ * RETURN VALUE: none
+  */
+void myStringNthElement(MyString** arr, size_t len, size_t n);
+
+/**
+ * @brief sorts an array of MyString pointers according to keys made from the strings.
+ * 	transform is called once for every string and sets key to the normalized form of str
+ * 	(e.g. the string in lower case), and the strings are ordered like myStringCompare orders their
+ * 	keys. The first 8 chars of every key are cached next to it, so most comparisons don't access
+ * 	the keys themselves.
+ * 	If transform is NULL, the strings are their own keys.
+ * @param arr
+ * @param len
+ * @param transform sets key to the key of str. returns MYSTRING_SUCCESS on success,
+ * 	MYSTRING_ERROR on failure.
+ *
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is left unchanged).
+  */
+MyStringRetVal myStringKeySort(MyString** arr, size_t len,
+							   MyStringRetVal (*transform)(const MyString *str, MyString *key));
+
+/**
+ * @brief sorts an array of MyString pointers in natural order: runs of digits are compared by
+ * 	their numeric value, so "file9" comes before "file10" and "v1.9" before "v1.10", and the
+ * 	other chars are compared like in myStringCompare. A run of digits is ordered among the other
+ * 	chars like a digit. Signs aren't part of the numbers, and leading zeros are ignored, so
+ * 	MyStrings that differ only in them are in an unspecified order.
+ * 	The key of every string is made once, like in myStringKeySort, so the digits aren't parsed
+ * 	again on every comparison, and the chars common to all the keys are skipped.
+ * @param arr
+ * @param len
+ *
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is left unchanged).
+  */
+MyStringRetVal myStringNaturalSort(MyString** arr, size_t len);
+
+
+/**
+ * @brief Makes str immutable: every function changing str will fail from now on. A frozen
+ * 	MyString can be shared between threads without copying or locking: every thread reading it
+ * 	takes a reference with myStringRetain and releases it with myStringFree.
+ * 	Freezing a frozen MyString does nothing.
+ * @param str the MyString to freeze
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringFreeze(MyString *str);
+
+/**
+ * @brief Check if str is frozen.
+ * @param str
+ * RETURN VALUE:
+ *  @return true if str is frozen, false otherwise (or if str is NULL).
+ */
+bool myStringIsFrozen(const MyString *str);
+
+/**
+ * @brief Takes another reference to the frozen MyString str. Every reference is released by a
+ * 	call to myStringFree, and str is freed when its last reference is released.
+ * 	Can be called from any thread holding a reference to str.
+ * @param str the frozen MyString
+ * RETURN VALUE:
+ *  @return str, or NULL if str is NULL or not frozen.
+ */
+MyString * myStringRetain(MyString *str);
+
+/**
+ * @brief Allocates a new empty MyStringHashSet with room for capacity MyStrings.
+ * 	The capacity is fixed: MyStrings are never removed from the set and it never grows, so
+ * 	lookups don't have to lock or to protect the memory they read.
+ * 	It is the caller's responsibility to free the returned MyStringHashSet.
+ * @param capacity the maximal number of MyStrings in the set
+ * RETURN VALUE:
+ *  @return a pointer to the new set, or NULL if the allocation failed.
+ */
+MyStringHashSet * myStringHashSetAlloc(size_t capacity);
+
+/**
+ * @brief Frees set and releases its references to the MyStrings in it.
+ * 	Must not be called concurrently with other functions on set.
+ * 	If set is NULL, no operation is performed.
+ * @param set
+ */
+void myStringHashSetFree(MyStringHashSet *set);
+
+/**
+ * @brief Adds the frozen MyString str to set, unless set already has a MyString equal to it
+ * 	(like in myStringEqual). The set takes its own reference to str (like in myStringRetain).
+ * 	Can be called concurrently with myStringHashSetInsert and myStringHashSetFind.
+ * @param set
+ * @param str the frozen MyString to add
+ * RETURN VALUE:
+ *  @return the MyString in set equal to str (str itself if it was added), valid as long as set
+ *  is not freed, or NULL on failure (str is not frozen or set is full).
+ */
+MyString * myStringHashSetInsert(MyStringHashSet *set, MyString *str);
+
+/**
+ * @brief Looks for a MyString equal to str (like in myStringEqual) in set.
+ * 	Can be called concurrently with myStringHashSetInsert and myStringHashSetFind.
+ * @param set
+ * @param str
+ * RETURN VALUE:
+ *  @return the MyString in set equal to str, valid as long as set is not freed, or NULL if there
+ *  is no such MyString.
+ */
+MyString * myStringHashSetFind(const MyStringHashSet *set, const MyString *str);
+
+/**
+ * @return the number of MyStrings in set.
+ */
+size_t myStringHashSetSize(const MyStringHashSet *set);
+
+/**
+ * @brief removes the duplicates from an array of MyString pointers (MyStrings composed of the
+ * 	very same characters, like in myStringEqual). The first occurrence of every value is kept and
+ * 	the kept MyStrings are moved to the start of arr in the order they were first seen.
+ * 	If freeDuplicates is true the duplicates are freed, otherwise they are moved after the kept
+ * 	MyStrings in their original order.
+ * @param arr
+ * @param len
+ * @param freeDuplicates
+ * @param uniqueLen set to the number of kept MyStrings.
+ *
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is left unchanged).
+ */
+MyStringRetVal myStringUnique(MyString** arr, size_t len, bool freeDuplicates, size_t *uniqueLen);
+
+/**
+ * @brief counts the distinct values in an array of MyString pointers (like in myStringEqual).
+ * @param arr
+ * @param len
+ * @param count set to the number of distinct values.
+ *
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringCountDistinct(MyString** arr, size_t len, size_t *count);
+
+/**
+ * @brief estimates the number of distinct values in an array of MyString pointers using the
+ * 	HyperLogLog algorithm, with a relative error of about 1% and a fixed amount of memory (16KB),
+ * 	for arrays too big for myStringCountDistinct.
+ * @param arr
+ * @param len
+ * @param estimate set to the estimated number of distinct values.
+ *
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringEstimateDistinct(MyString** arr, size_t len, size_t *estimate);
+
+/**
+ * @brief Writes the n MyStrings of arr to stream, in the format read by myStringArrayLoad:
+ * 	the 8 chars "MYSTRAR1", the number of MyStrings, a table of n + 1 offsets to the start of
+ * 	every string (and to the end of the last one) from the start of the chars, and then the
+ * 	chars of all the strings. The numbers are unsigned 64 bit integers in the byte order of the
+ * 	machine writing them. The table lets every string be found without reading the ones before it.
+ * @param arr
+ * @param n
+ * @param stream a binary stream
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringArraySerialize(MyString** arr, size_t n, FILE *stream);
+
+/**
+ * @brief Maps the file fileName, written by myStringArraySerialize, to memory, and makes a frozen
+ * 	MyString for every string in it. The chars of the strings are not read or copied: the
+ * 	MyStrings point to the mapped file, which the system reads when they are used.
+ * 	The MyStrings can be used like other frozen MyStrings (e.g. compared, sorted, cloned or
+ * 	inserted to a MyStringHashSet) until the array is freed. They belong to the array, so
+ * 	myStringFree does nothing to them, and myStringCStr returns NULL for them.
+ * 	It is the caller's responsibility to free the returned MyStringArray.
+ * @param fileName
+ * RETURN VALUE:
+ *  @return a pointer to the array, or NULL if the file can't be mapped or isn't in the format of
+ *  myStringArraySerialize.
+ */
+MyStringArray * myStringArrayLoad(const char *fileName);
+
+/**
+ * @brief Unmaps the file of array, and frees its MyStrings.
+ * @param array If NULL, no operation is performed.
+ */
+void myStringArrayFree(MyStringArray *array);
+
+/**
+ * @return the number of MyStrings in array, or 0 if array is NULL.
+ */
+size_t myStringArrayLen(const MyStringArray *array);
+
+/**
+ * @brief Returns the MyStrings of array, in the order they were written. The pointers may be
+ * 	reordered (e.g. by myStringSort), and are valid until the array is freed.
+ * @param array
+ * RETURN VALUE:
+ *  @return the array of myStringArrayLen(array) MyString pointers, or NULL if array is NULL.
+ */
+MyString ** myStringArrayStrings(MyStringArray *array);
+
+/**
+ * @brief Allocates a new empty MyStringBuilder with room for capacity chars. It is the caller's
+ * 	responsibility to free the returned MyStringBuilder.
+ * @param capacity the number of chars to allocate, 0 to allocate on the first append
+ * RETURN VALUE:
+ *  @return a pointer to the new builder, or NULL if the allocation failed.
+ */
+MyStringBuilder * myStringBuilderAlloc(size_t capacity);
+
+/**
+ * @brief Frees the memory allocated to builder.
+ * @param builder If NULL, no operation is performed.
+ */
+void myStringBuilderFree(MyStringBuilder *builder);
+
+/**
+ * @brief Empties builder, keeping its buffer for the next appends.
+ * @param builder
+ */
+void myStringBuilderReset(MyStringBuilder *builder);
+
+/**
+ * @return the number of chars appended to builder, or 0 if builder is NULL.
+ */
+unsigned long myStringBuilderLen(const MyStringBuilder *builder);
+
+/**
+ * @brief Appends the char ch to builder.
+ * @param builder
+ * @param ch
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderAppendChar(MyStringBuilder *builder, char ch);
+
+/**
+ * @brief Appends the C string cString, terminated by the null character, to builder.
+ * @param builder
+ * @param cString
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderAppendCString(MyStringBuilder *builder, const char *cString);
+
+/**
+ * @brief Appends the value of str to builder.
+ * @param builder
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderAppendMyString(MyStringBuilder *builder, const MyString *str);
+
+/**
+ * @brief Appends the integer n to builder, like myStringSetFromInt.
+ * @param builder
+ * @param n
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderAppendInt(MyStringBuilder *builder, int n);
+
+/**
+ * @brief Appends the double x to builder, formatted like printf's "%g".
+ * @param builder
+ * @param x
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderAppendDouble(MyStringBuilder *builder, double x);
+
+/**
+ * @brief Appends the arguments formatted by format (like printf()) to builder. The chars are
+ * 	formatted directly into the buffer of builder.
+ * @param builder
+ * @param format
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (and builder is not changed).
+ */
+MyStringRetVal myStringBuilderAppendf(MyStringBuilder *builder, const char *format, ...)
+#ifdef __GNUC__
+	__attribute__((format(printf, 2, 3)))
+#endif
+	;
+
+/**
+ * @brief Sets the value of str to the chars appended to builder, and resets builder.
+ * 	The buffer of builder is handed to str without copying it, and builder takes the old string
+ * 	of str as its buffer, so building into the same MyString again and again doesn't allocate
+ * 	once the buffers are big enough.
+ * @param builder
+ * @param str the MyString to set
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBuilderBuild(MyStringBuilder *builder, MyString *str);
+
+/**
+ * @brief Sets stats to the statistics of the library, summed over all the threads.
+ * 	Available only if the library is built with MYSTRING_STATS.
+ * @param stats
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (or if the statistics are not
+ *  available).
+ */
+MyStringRetVal myStringStatsGet(MyStringStats *stats);
+
+/**
+ * @brief Writes the statistics of the library, summed over all the threads, to stream: the
+ * 	counters of myStringStatsGet and the number of calls to every public function.
+ * 	Available only if the library is built with MYSTRING_STATS.
+ * @param stream
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (or if the statistics are not
+ *  available).
+ */
+MyStringRetVal myStringStatsDump(FILE *stream);
+
+// ------------------------- specialized comparators ----------------------
+
+/**
+ * Represents a MyString. The fields are private to the library: they are defined here only so
+ * the functions of MYSTRING_DEFINE_COMPARATOR can read the chars without calling the library.
+ */
+struct _MyString
+{
+	char* _string; // The string
+	size_t _length; // The length of the string
+	size_t _capacity; // The number of chars allocated to the string
+	bool _frozen; // Whether the string can't be changed anymore
+	unsigned int _refCount; // The number of owners of a frozen string, changed atomically
+	uint64_t _hash; // The hash of a frozen string, or 0 if it wasn't computed yet
+	bool _borrowed; // The MyString and its string belong to a MyStringArray, so it is never freed
+	bool _compressed; // The string holds the _length chars compressed by myStringCompress
+	uint64_t _utf8; // UTF8_UNKNOWN, UTF8_INVALID, or UTF8_VALID plus the number of code points
+};
+
+/**
+ * @brief Defines specialized versions of myStringCustomCompare, myStringCustomEqual and
+ * 	myStringCustomSort for a custom comparator given as an expression, so the comparator is
+ * 	inlined into the compare loop instead of being called through a function pointer, and the
+ * 	sort is an introsort calling the inlined compare instead of qsort. expr compares the chars
+ * 	ch1 and ch2 and evaluates to an int like the comparator of myStringCustomCompare. For
+ * 	example:
+ *
+ * 	MYSTRING_DEFINE_COMPARATOR(caseless, tolower(ch1) - tolower(ch2))
+ *
+ * 	defines the static functions:
+ * 	 - int caselessCompare(const MyString *str1, const MyString *str2)
+ * 	 - int caselessEqual(const MyString *str1, const MyString *str2)
+ * 	 - void caselessSort(MyString** arr, size_t len)
+ * 	with the same return values as their myStringCustom* counterparts. caselessSort puts the
+ * 	MyStrings that were never set first, and leaves arr unchanged if one of them is NULL.
+ * 	The chars are read directly, and the library is called only to decompress a MyString
+ * 	compressed by myStringCompress.
+ * @param name prefix of the defined functions
+ * @param expr the comparator expression of ch1 and ch2
+ */
+#define MYSTRING_SORT_INSERTION_LIMIT 16
+
+#define MYSTRING_DEFINE_COMPARATOR(name, expr) \
+static inline int name##Chars(const char ch1, const char ch2) \
+{ \
+	return (expr); \
+} \
+\
+static inline int name##Order(const MyString *str1, const MyString *str2) \
+{ \
+	if (str1->_string == NULL || str2->_string == NULL) \
+	{ \
+		return (str1->_string != NULL) - (str2->_string != NULL); \
+	} \
+	size_t minLen = str1->_length < str2->_length ? str1->_length : str2->_length, i; \
+	for (i = 0; i < minLen; i++) \
+	{ \
+		int compare = name##Chars(str1->_string[i], str2->_string[i]); \
+		if (compare != 0) \
+		{ \
+			return compare > 0 ? 1 : -1; \
+		} \
+	} \
+	return str1->_length == str2->_length ? 0 : (str1->_length < str2->_length ? -1 : 1); \
+} \
+\
+static inline int name##Compare(const MyString *str1, const MyString *str2) \
+{ \
+	if (str1 == NULL || str2 == NULL || \
+		(str1->_compressed && myStringData(str1) == NULL) || \
+		(str2->_compressed && myStringData(str2) == NULL) || \
+		str1->_string == NULL || str2->_string == NULL) \
+	{ \
+		return MYSTR_ERROR_CODE; \
+	} \
+	return name##Order(str1, str2); \
+} \
+\
+static inline int name##Equal(const MyString *str1, const MyString *str2) \
+{ \
+	int compare = name##Compare(str1, str2); \
+	if (compare == MYSTR_ERROR_CODE) \
+	{ \
+		return MYSTR_ERROR_CODE; \
+	} \
+	return compare == 0; \
+} \
+\
+static inline void name##Swap(MyString** str1, MyString** str2) \
+{ \
+	MyString* temp = *str1; \
+	*str1 = *str2; \
+	*str2 = temp; \
+} \
+\
+static inline void name##SiftDown(MyString** heap, size_t len, size_t i) \
+{ \
+	while (2 * i + 1 < len) \
+	{ \
+		size_t child = 2 * i + 1; \
+		if (child + 1 < len && name##Order(heap[child + 1], heap[child]) > 0) \
+		{ \
+			child++; \
+		} \
+		if (name##Order(heap[child], heap[i]) <= 0) \
+		{ \
+			return; \
+		} \
+		name##Swap(&heap[i], &heap[child]); \
+		i = child; \
+	} \
+} \
+\
+static inline void name##SortRange(MyString** arr, size_t len, size_t depthLimit) \
+{ \
+	while (len > MYSTRING_SORT_INSERTION_LIMIT) \
+	{ \
+		if (depthLimit == 0) \
+		{ \
+			size_t i; \
+			for (i = len / 2; i > 0; i--) \
+			{ \
+				name##SiftDown(arr, len, i - 1); \
+			} \
+			for (i = len - 1; i > 0; i--) \
+			{ \
+				name##Swap(&arr[0], &arr[i]); \
+				name##SiftDown(arr, i, 0); \
+			} \
+			return; \
+		} \
+		depthLimit--; \
+\
+		size_t middle = (len - 1) / 2, i = 0, j = len - 1; \
+		if (name##Order(arr[middle], arr[0]) < 0) \
+		{ \
+			name##Swap(&arr[middle], &arr[0]); \
+		} \
+		if (name##Order(arr[len - 1], arr[0]) < 0) \
+		{ \
+			name##Swap(&arr[len - 1], &arr[0]); \
+		} \
+		if (name##Order(arr[len - 1], arr[middle]) < 0) \
+		{ \
+			name##Swap(&arr[len - 1], &arr[middle]); \
+		} \
+		MyString* pivot = arr[middle]; \
+		while (true) \
+		{ \
+			while (name##Order(arr[i], pivot) < 0) \
+			{ \
+				i++; \
+			} \
+			while (name##Order(arr[j], pivot) > 0) \
+			{ \
+				j--; \
+			} \
+			if (i >= j) \
+			{ \
+				break; \
+			} \
+			name##Swap(&arr[i], &arr[j]); \
+			i++; \
+			j--; \
+		} \
+\
+		/* The smaller part is sorted recursively, so the stack is O(log(len)) */ \
+		if (j + 1 < len - j - 1) \
+		{ \
+			name##SortRange(arr, j + 1, depthLimit); \
+			arr += j + 1; \
+			len -= j + 1; \
+		} \
+		else \
+		{ \
+			name##SortRange(arr + j + 1, len - j - 1, depthLimit); \
+			len = j + 1; \
+		} \
+	} \
+\
+	size_t i, j; \
+	for (i = 1; i < len; i++) \
+	{ \
+		MyString* current = arr[i]; \
+		for (j = i; j > 0 && name##Order(current, arr[j - 1]) < 0; j--) \
+		{ \
+			arr[j] = arr[j - 1]; \
+		} \
+		arr[j] = current; \
+	} \
+} \
+\
+static inline void name##Sort(MyString** arr, size_t len) \
+{ \
+	size_t i, depthLimit = 0; \
+	if (arr == NULL) \
+	{ \
+		return; \
+	} \
+	for (i = 0; i < len; i++) \
+	{ \
+		if (arr[i] == NULL || (arr[i]->_compressed && myStringData(arr[i]) == NULL)) \
+		{ \
+			return; \
+		} \
+	} \
+	for (i = len; i > 1; i >>= 1) \
+	{ \
+		depthLimit += 2; \
+	} \
+	name##SortRange(arr, len, depthLimit); \
+}
 
 #endif // _MYSTRING_H
 
@@ -0,0 +1,1278 @@
+/**
+ * @file MyStringBench.c
+ * @author  Idan Refaeli <idan.refaeli@mail.huji.ac.il>
+ * @version 1.0
+ * @date 13 Aug 2015
+ *
+ * @brief Benchmarks for the MyString library
+ *
+ * @section LICENSE
+ * This program is a free software
+ *
+ * @section DESCRIPTION
+ * Measures the time of MyString operations on generated strings and prints the results.
+ *
+ * Input  : None
+ * Process: Running every benchmark for a fixed number of repetitions. The micro-benchmarks of the
+ *          public functions are run after warmup batches, at string sizes from 0 to 16 MB.
+ * Output : The time per operation of every benchmark, and optionally the micro-benchmarks results
+ *          as JSON.
+ */
+
+// ------------------------------ includes ------------------------------
+#define _POSIX_C_SOURCE 199309L
+
+#include <ctype.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include "MyString.h"
+
+// ------------------------------ consts --------------------------------
+#define NUM_OF_STRINGS 20000
+#define STRING_LENGTH 64
+#define COMMON_PREFIX 48
+#define COMPARE_ROUNDS 50
+#define NUM_OF_SELECTED_STRINGS 200000
+#define TOP_K 100
+#define NUM_OF_DISTINCT_VALUES 50000
+#define ALLOC_ROUNDS 200000
+#define MAX_THREADS 32
+#define DICTIONARY_SIZE 10000
+#define LOOKUP_ROUNDS 200000
+#define MAX_LOOKUP_THREADS 64
+#define INSERT_EVERY 10
+#define KB 1024
+#define MB (1024 * KB)
+#define END_OF_SIZES SIZE_MAX
+#define MAX_INT_DIGITS 10
+#define SORT_BYTES (4 * MB)
+#define MIN_SORT_LEN 4
+#define MAX_SORT_LEN 1024
+#define BATCH_BYTES (64 * MB)
+#define MAX_BATCH 4096
+#define MIN_BATCH_NS 1e6
+#define WARMUP_BATCHES 2
+#define REPETITIONS 15
+#define NAME_LENGTH 64
+#define NUM_OF_PARSED_INTS 100000
+#define PARSE_ROUNDS 20
+#define INT64_LENGTH 21
+#define FILE_NAME_LENGTH 48
+
+// ------------------------------ comparators ---------------------------
+
+/**
+ * @brief Case insensitive comparator, used through a function pointer.
+ * @param ch1
+ * @param ch2
+ * @return the difference between the lower case values of ch1 and ch2
+ */
+static int caselessComparator(const char ch1, const char ch2)
+{
+	return tolower((unsigned char)ch1) - tolower((unsigned char)ch2);
+}
+
+/**
+ * @brief Casts 2 void* pointers into MyString** pointers and compare them with caselessComparator
+ * 		  through myStringCustomCompare.
+ * @param str1
+ * @param str2
+ * @return result of myStringCustomCompare
+ */
+static int pointerComparatorCasting(const void* str1, const void* str2)
+{
+	return myStringCustomCompare(*(MyString**)str1, *(MyString**)str2, caselessComparator);
+}
+
+MYSTRING_DEFINE_COMPARATOR(caseless, tolower((unsigned char)ch1) - tolower((unsigned char)ch2))
+
+/**
+ * @brief Natural order comparator for myStringCustomSort, like myStringNaturalSort: the runs of
+ * 		  digits are found and compared by their value again on every comparison.
+ * @param str1
+ * @param str2
+ * @return a negative value, zero or a positive value if str1 is smaller, equal or bigger
+ */
+static int naturalComparatorCasting(const void* str1, const void* str2)
+{
+	const char* chars1 = myStringData(*(MyString**)str1);
+	const char* chars2 = myStringData(*(MyString**)str2);
+	size_t len1 = myStringLen(*(MyString**)str1), len2 = myStringLen(*(MyString**)str2);
+	size_t i = 0, j = 0;
+
+	while (i < len1 && j < len2)
+	{
+		if (!isdigit((unsigned char)chars1[i]) || !isdigit((unsigned char)chars2[j]))
+		{
+			if (chars1[i] != chars2[j])
+			{
+				return chars1[i] < chars2[j] ? -1 : 1;
+			}
+			i++;
+			j++;
+			continue;
+		}
+
+		size_t end1 = i, end2 = j;
+		while (end1 < len1 && isdigit((unsigned char)chars1[end1]))
+		{
+			end1++;
+		}
+		while (end2 < len2 && isdigit((unsigned char)chars2[end2]))
+		{
+			end2++;
+		}
+		while (i < end1 - 1 && chars1[i] == '0')
+		{
+			i++;
+		}
+		while (j < end2 - 1 && chars2[j] == '0')
+		{
+			j++;
+		}
+		if (end1 - i != end2 - j)
+		{
+			return end1 - i < end2 - j ? -1 : 1;
+		}
+		int compare = memcmp(chars1 + i, chars2 + j, end1 - i);
+		if (compare != 0)
+		{
+			return compare;
+		}
+		i = end1;
+		j = end2;
+	}
+	return (i < len1) - (j < len2);
+}
+
+/**
+ * @brief Key transform for myStringKeySort: sets key to str in lower case.
+ * @param str
+ * @param key
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal lowerCaseKey(const MyString* str, MyString* key)
+{
+	char* cString = myStringToCString(str);
+	if (cString == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t i;
+	for (i = 0; cString[i] != '\0'; i++)
+	{
+		cString[i] = (char)tolower((unsigned char)cString[i]);
+	}
+
+	MyStringRetVal ret = myStringSetFromCString(key, cString);
+	free(cString);
+	return ret;
+}
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * @return the current time in nanoseconds
+ */
+static double nowNs()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+/**
+ * @brief Prints the result of a benchmark.
+ * @param name the name of the benchmark
+ * @param totalNs the total time of the benchmark in nanoseconds
+ * @param ops the number of operations done in the benchmark
+ */
+static void report(const char* name, double totalNs, size_t ops)
+{
+	printf("%-40s %12.2f ns/op\n", name, totalNs / (double)ops);
+}
+
+/**
+ * @brief Fills arr with len random MyStrings of STRING_LENGTH chars sharing a common prefix of
+ * 		  commonPrefix chars in random case, so comparisons have to go through commonPrefix chars.
+ * @param arr
+ * @param len
+ * @param commonPrefix
+ */
+static void fillStrings(MyString** arr, size_t len, size_t commonPrefix)
+{
+	char buffer[STRING_LENGTH + 1];
+	size_t i, j;
+
+	for (i = 0; i < len; i++)
+	{
+		for (j = 0; j < STRING_LENGTH; j++)
+		{
+			char letter = j < commonPrefix ? (char)('a' + j % 26) : (char)('a' + rand() % 26);
+			buffer[j] = rand() % 2 ? (char)toupper((unsigned char)letter) : letter;
+		}
+		buffer[STRING_LENGTH] = '\0';
+
+		arr[i] = myStringAlloc();
+		myStringSetFromCString(arr[i], buffer);
+	}
+}
+
+/**
+ * @brief Frees len MyStrings of arr.
+ * @param arr
+ * @param len
+ */
+static void freeStrings(MyString** arr, size_t len)
+{
+	size_t i;
+	for (i = 0; i < len; i++)
+	{
+		myStringFree(arr[i]);
+	}
+}
+
+/**
+ * @brief Compares a custom comparator called through a function pointer to the same comparator
+ * 		  specialized by MYSTRING_DEFINE_COMPARATOR, on compare and on sort.
+ */
+static void benchCustomComparator()
+{
+	MyString** arr = (MyString**)malloc(NUM_OF_STRINGS * sizeof(MyString*));
+	MyString** copy = (MyString**)malloc(NUM_OF_STRINGS * sizeof(MyString*));
+	if (arr == NULL || copy == NULL)
+	{
+		free(arr);
+		free(copy);
+		return;
+	}
+
+	fillStrings(arr, NUM_OF_STRINGS, COMMON_PREFIX);
+
+	size_t round, i;
+	volatile int sink = 0;
+	double start = nowNs();
+	for (round = 0; round < COMPARE_ROUNDS; round++)
+	{
+		for (i = 1; i < NUM_OF_STRINGS; i++)
+		{
+			sink += myStringCustomCompare(arr[i - 1], arr[i], caselessComparator);
+		}
+	}
+	report("customCompare/function-pointer", nowNs() - start,
+		   COMPARE_ROUNDS * (NUM_OF_STRINGS - 1));
+
+	start = nowNs();
+	for (round = 0; round < COMPARE_ROUNDS; round++)
+	{
+		for (i = 1; i < NUM_OF_STRINGS; i++)
+		{
+			sink += caselessCompare(arr[i - 1], arr[i]);
+		}
+	}
+	report("customCompare/specialized", nowNs() - start, COMPARE_ROUNDS * (NUM_OF_STRINGS - 1));
+
+	memcpy(copy, arr, NUM_OF_STRINGS * sizeof(MyString*));
+	start = nowNs();
+	myStringCustomSort(copy, NUM_OF_STRINGS, pointerComparatorCasting);
+	report("customSort/function-pointer", nowNs() - start, NUM_OF_STRINGS);
+
+	memcpy(copy, arr, NUM_OF_STRINGS * sizeof(MyString*));
+	start = nowNs();
+	caselessSort(copy, NUM_OF_STRINGS);
+	report("customSort/specialized", nowNs() - start, NUM_OF_STRINGS);
+
+	memcpy(copy, arr, NUM_OF_STRINGS * sizeof(MyString*));
+	start = nowNs();
+	myStringKeySort(copy, NUM_OF_STRINGS, lowerCaseKey);
+	report("customSort/key-sort", nowNs() - start, NUM_OF_STRINGS);
+
+	(void)sink;
+	freeStrings(arr, NUM_OF_STRINGS);
+	free(arr);
+	free(copy);
+}
+
+/**
+ * @brief Compares myStringSort to myStringKeySort with the strings as their own keys, on strings
+ * 		  without a common prefix.
+ */
+static void benchSort()
+{
+	MyString** arr = (MyString**)malloc(NUM_OF_STRINGS * sizeof(MyString*));
+	MyString** copy = (MyString**)malloc(NUM_OF_STRINGS * sizeof(MyString*));
+	if (arr == NULL || copy == NULL)
+	{
+		free(arr);
+		free(copy);
+		return;
+	}
+
+	fillStrings(arr, NUM_OF_STRINGS, 0);
+
+	memcpy(copy, arr, NUM_OF_STRINGS * sizeof(MyString*));
+	double start = nowNs();
+	myStringSort(copy, NUM_OF_STRINGS);
+	report("sort/qsort", nowNs() - start, NUM_OF_STRINGS);
+
+	memcpy(copy, arr, NUM_OF_STRINGS * sizeof(MyString*));
+	start = nowNs();
+	myStringKeySort(copy, NUM_OF_STRINGS, NULL);
+	report("sort/key-sort", nowNs() - start, NUM_OF_STRINGS);
+
+	freeStrings(arr, NUM_OF_STRINGS);
+	free(arr);
+	free(copy);
+}
+
+/**
+ * @brief Compares sorting file names with numbers in natural order by myStringNaturalSort and by
+ * 		  a comparator that parses the numbers on every comparison, to myStringSort of the same
+ * 		  names in the default order.
+ */
+static void benchNaturalSort()
+{
+	MyString** arr = (MyString**)malloc(NUM_OF_STRINGS * sizeof(MyString*));
+	MyString** copy = (MyString**)malloc(NUM_OF_STRINGS * sizeof(MyString*));
+	if (arr == NULL || copy == NULL)
+	{
+		free(arr);
+		free(copy);
+		return;
+	}
+
+	char buffer[FILE_NAME_LENGTH];
+	size_t i;
+	for (i = 0; i < NUM_OF_STRINGS; i++)
+	{
+		snprintf(buffer, FILE_NAME_LENGTH, "photos/IMG_%d_v%d.%d.jpg", rand() % 100000,
+				 rand() % 20, rand() % 200);
+		arr[i] = myStringAlloc();
+		myStringSetFromCString(arr[i], buffer);
+	}
+
+	memcpy(copy, arr, NUM_OF_STRINGS * sizeof(MyString*));
+	double start = nowNs();
+	myStringSort(copy, NUM_OF_STRINGS);
+	report("naturalSort/default-order", nowNs() - start, NUM_OF_STRINGS);
+
+	memcpy(copy, arr, NUM_OF_STRINGS * sizeof(MyString*));
+	start = nowNs();
+	myStringCustomSort(copy, NUM_OF_STRINGS, naturalComparatorCasting);
+	report("naturalSort/comparator", nowNs() - start, NUM_OF_STRINGS);
+
+	memcpy(copy, arr, NUM_OF_STRINGS * sizeof(MyString*));
+	start = nowNs();
+	myStringNaturalSort(copy, NUM_OF_STRINGS);
+	report("naturalSort/key-sort", nowNs() - start, NUM_OF_STRINGS);
+
+	freeStrings(arr, NUM_OF_STRINGS);
+	free(arr);
+	free(copy);
+}
+
+/**
+ * @brief Compares getting the TOP_K smallest MyStrings by a full myStringSort, by
+ * 		  myStringPartialSort, and by myStringNthElement followed by sorting the first TOP_K.
+ */
+static void benchPartialSort()
+{
+	MyString** arr = (MyString**)malloc(NUM_OF_SELECTED_STRINGS * sizeof(MyString*));
+	MyString** copy = (MyString**)malloc(NUM_OF_SELECTED_STRINGS * sizeof(MyString*));
+	if (arr == NULL || copy == NULL)
+	{
+		free(arr);
+		free(copy);
+		return;
+	}
+
+	fillStrings(arr, NUM_OF_SELECTED_STRINGS, 0);
+
+	memcpy(copy, arr, NUM_OF_SELECTED_STRINGS * sizeof(MyString*));
+	double start = nowNs();
+	myStringSort(copy, NUM_OF_SELECTED_STRINGS);
+	report("top-100/full-sort", nowNs() - start, NUM_OF_SELECTED_STRINGS);
+
+	memcpy(copy, arr, NUM_OF_SELECTED_STRINGS * sizeof(MyString*));
+	start = nowNs();
+	myStringPartialSort(copy, NUM_OF_SELECTED_STRINGS, TOP_K);
+	report("top-100/partial-sort", nowNs() - start, NUM_OF_SELECTED_STRINGS);
+
+	memcpy(copy, arr, NUM_OF_SELECTED_STRINGS * sizeof(MyString*));
+	start = nowNs();
+	myStringNthElement(copy, NUM_OF_SELECTED_STRINGS, TOP_K - 1);
+	myStringSort(copy, TOP_K);
+	report("top-100/nth-element", nowNs() - start, NUM_OF_SELECTED_STRINGS);
+
+	freeStrings(arr, NUM_OF_SELECTED_STRINGS);
+	free(arr);
+	free(copy);
+}
+
+/**
+ * @brief Compares counting distinct values by sorting and comparing neighbours to
+ * 		  myStringCountDistinct and myStringEstimateDistinct.
+ */
+static void benchCountDistinct()
+{
+	MyString** arr = (MyString**)malloc(NUM_OF_SELECTED_STRINGS * sizeof(MyString*));
+	if (arr == NULL)
+	{
+		return;
+	}
+
+	size_t i, count = 0;
+	for (i = 0; i < NUM_OF_SELECTED_STRINGS; i++)
+	{
+		arr[i] = myStringAlloc();
+		myStringSetFromInt(arr[i], rand() % NUM_OF_DISTINCT_VALUES);
+	}
+
+	double start = nowNs();
+	myStringSort(arr, NUM_OF_SELECTED_STRINGS);
+	for (i = 0; i < NUM_OF_SELECTED_STRINGS; i++)
+	{
+		count += i == 0 || myStringEqual(arr[i - 1], arr[i]) == 0;
+	}
+	report("distinct/sort", nowNs() - start, NUM_OF_SELECTED_STRINGS);
+
+	start = nowNs();
+	myStringCountDistinct(arr, NUM_OF_SELECTED_STRINGS, &count);
+	report("distinct/hash", nowNs() - start, NUM_OF_SELECTED_STRINGS);
+
+	start = nowNs();
+	myStringEstimateDistinct(arr, NUM_OF_SELECTED_STRINGS, &count);
+	report("distinct/hyperloglog", nowNs() - start, NUM_OF_SELECTED_STRINGS);
+
+	freeStrings(arr, NUM_OF_SELECTED_STRINGS);
+	free(arr);
+}
+
+/**
+ * @brief Compares parsing a list of integers separated by ", " by myStringParseInts to a loop of
+ * 		  strtoll on the chars of the list.
+ */
+static void benchParseInts()
+{
+	char* buffer = (char*)malloc(NUM_OF_PARSED_INTS * (INT64_LENGTH + 2));
+	int64_t* out = (int64_t*)malloc(NUM_OF_PARSED_INTS * sizeof(int64_t));
+	MyString* list = myStringAlloc();
+	if (buffer == NULL || out == NULL || list == NULL)
+	{
+		free(buffer);
+		free(out);
+		myStringFree(list);
+		return;
+	}
+
+	// The integers have from 1 to 19 digits, like ids and timestamps
+	size_t i, len = 0, count = 0;
+	for (i = 0; i < NUM_OF_PARSED_INTS; i++)
+	{
+		int64_t num = (int64_t)(((uint64_t)rand() << 32 | (uint64_t)rand()) >> (rand() % 60));
+		len += (size_t)sprintf(buffer + len, "%s%" PRId64, i == 0 ? "" : ", ",
+							   rand() % 2 ? num : -num);
+	}
+	myStringSetFromBuffer(list, buffer, len);
+
+	double start = nowNs();
+	for (i = 0; i < PARSE_ROUNDS; i++)
+	{
+		myStringParseInts(list, ',', out, NUM_OF_PARSED_INTS, &count, NULL);
+	}
+	report("parseInts/myStringParseInts", nowNs() - start, PARSE_ROUNDS * NUM_OF_PARSED_INTS);
+
+	start = nowNs();
+	for (i = 0; i < PARSE_ROUNDS; i++)
+	{
+		const char* chars = myStringCStr(list);
+		char* end;
+		for (count = 0; count < NUM_OF_PARSED_INTS; count++)
+		{
+			out[count] = (int64_t)strtoll(chars, &end, 10);
+			chars = *end == ',' ? end + 1 : end;
+		}
+	}
+	report("parseInts/strtoll", nowNs() - start, PARSE_ROUNDS * NUM_OF_PARSED_INTS);
+
+	myStringFree(list);
+	free(out);
+	free(buffer);
+}
+
+/**
+ * @brief Thread of benchAllocScaling(): allocates, sets, concatenates and frees MyStrings, so most
+ * 		  of its time is spent in allocating and freeing memory.
+ * @param arg unused
+ * @return NULL
+ */
+static void* allocWorker(void* arg)
+{
+	size_t i;
+	for (i = 0; i < ALLOC_ROUNDS; i++)
+	{
+		MyString* str1 = myStringAlloc();
+		MyString* str2 = myStringAlloc();
+		myStringSetFromCString(str1, "worker ");
+		myStringSetFromInt(str2, (int)i);
+		myStringCat(str1, str2);
+		myStringFree(str1);
+		myStringFree(str2);
+	}
+	return arg;
+}
+
+/**
+ * @brief Runs allocWorker on 1 to MAX_THREADS threads and prints the throughput, to show how
+ * 		  allocating scales with the number of threads.
+ */
+static void benchAllocScaling()
+{
+	pthread_t threads[MAX_THREADS];
+	size_t numOfThreads, i;
+
+#ifdef MYSTRING_THREAD_CACHE
+	printf("allocation scaling with the thread cache:\n");
+#else
+	printf("allocation scaling with the system allocator:\n");
+#endif
+
+	for (numOfThreads = 1; numOfThreads <= MAX_THREADS; numOfThreads *= 2)
+	{
+		size_t created = 0;
+		double start = nowNs();
+		for (i = 0; i < numOfThreads; i++)
+		{
+			created += pthread_create(&threads[created], NULL, allocWorker, NULL) == 0;
+		}
+		for (i = 0; i < created; i++)
+		{
+			pthread_join(threads[i], NULL);
+		}
+		double totalNs = nowNs() - start;
+
+		printf("alloc/threads=%-27lu %12.2f Mops/s\n", (unsigned long)numOfThreads,
+			   (double)(created * ALLOC_ROUNDS) / totalNs * 1e3);
+	}
+}
+
+/**
+ * A shared dictionary for benchDictionaryScaling()
+ */
+typedef struct
+{
+	MyStringHashSet* _set; // The dictionary
+	MyString** _keys; // The MyStrings looked up in the dictionary
+	pthread_mutex_t* _lock; // Locks every operation on the dictionary, or NULL
+} Dictionary;
+
+/**
+ * @brief Thread of benchDictionaryScaling(): looks up the keys in the shared dictionary and inserts
+ * 		  one key every INSERT_EVERY lookups.
+ * @param arg the Dictionary
+ * @return NULL
+ */
+static void* dictionaryWorker(void* arg)
+{
+	Dictionary* dictionary = (Dictionary*)arg;
+	size_t i, seed = (size_t)pthread_self();
+
+	for (i = 0; i < LOOKUP_ROUNDS; i++)
+	{
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		MyString* key = dictionary->_keys[(seed >> 33) % DICTIONARY_SIZE];
+
+		if (dictionary->_lock != NULL)
+		{
+			pthread_mutex_lock(dictionary->_lock);
+		}
+		if (i % INSERT_EVERY == 0)
+		{
+			myStringHashSetInsert(dictionary->_set, key);
+		}
+		else
+		{
+			myStringHashSetFind(dictionary->_set, key);
+		}
+		if (dictionary->_lock != NULL)
+		{
+			pthread_mutex_unlock(dictionary->_lock);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Runs dictionaryWorker on 1 to MAX_LOOKUP_THREADS threads sharing a MyStringHashSet,
+ * 		  with and without a global lock, and prints the throughput.
+ */
+static void benchDictionaryScaling()
+{
+	MyString** keys = (MyString**)malloc(DICTIONARY_SIZE * sizeof(MyString*));
+	if (keys == NULL)
+	{
+		return;
+	}
+
+	size_t i, numOfThreads;
+	for (i = 0; i < DICTIONARY_SIZE; i++)
+	{
+		keys[i] = myStringAlloc();
+		myStringSetFromInt(keys[i], rand());
+		myStringFreeze(keys[i]);
+	}
+
+	pthread_t threads[MAX_LOOKUP_THREADS];
+	pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+	int locked;
+
+	for (locked = 1; locked >= 0; locked--)
+	{
+		for (numOfThreads = 1; numOfThreads <= MAX_LOOKUP_THREADS; numOfThreads *= 2)
+		{
+			Dictionary dictionary = {myStringHashSetAlloc(DICTIONARY_SIZE), keys,
+									 locked ? &lock : NULL};
+			size_t created = 0;
+
+			double start = nowNs();
+			for (i = 0; i < numOfThreads; i++)
+			{
+				created += pthread_create(&threads[created], NULL, dictionaryWorker,
+										  &dictionary) == 0;
+			}
+			for (i = 0; i < created; i++)
+			{
+				pthread_join(threads[i], NULL);
+			}
+			double totalNs = nowNs() - start;
+
+			printf("dictionary/%s/threads=%-*lu %12.2f Mops/s\n", locked ? "mutex" : "lock-free",
+				   locked ? 15 : 11, (unsigned long)numOfThreads,
+				   (double)(created * LOOKUP_ROUNDS) / totalNs * 1e3);
+			myStringHashSetFree(dictionary._set);
+		}
+	}
+
+	freeStrings(keys, DICTIONARY_SIZE);
+	free(keys);
+}
+
+// --------------------------- micro-benchmarks -------------------------
+
+/**
+ * The state of a micro-benchmark at one string size.
+ */
+typedef struct
+{
+	size_t _size; // The string size
+	size_t _batch; // The number of operations timed together
+	MyString* _str1; // An input of _size chars
+	MyString* _str2; // An input of _size chars, equal to _str1 but for its last char
+	MyString** _results; // The output of every operation of a batch
+	MyString** _arr; // The input of myStringSort, _arrLen MyStrings of _size chars
+	size_t _arrLen;
+	MyString** _work; // A copy of _arr for every operation of a batch
+	FILE* _stream; // The stream of myStringWrite
+	MyStringBuilder* _builder; // The builder of myStringBuilderBuild, reused by every operation
+} BenchContext;
+
+/**
+ * A micro-benchmark of a public function. Every operation of a batch is timed, but reset() is
+ * called before every batch out of the timed part, so it can prepare the inputs.
+ */
+typedef struct
+{
+	const char* _name;
+	const size_t* _sizes; // The string sizes to run at, ending with END_OF_SIZES
+	void (*_reset)(BenchContext*); // Prepares a batch, or NULL
+	void (*_run)(BenchContext*, size_t); // Runs one operation of a batch
+} MicroBenchmark;
+
+static const size_t stringSizes[] = {0, 64, 4 * KB, 64 * KB, MB, 16 * MB, END_OF_SIZES};
+static const size_t noSizes[] = {0, END_OF_SIZES};
+static const size_t digitSizes[] = {1, MAX_INT_DIGITS, END_OF_SIZES};
+
+/**
+ * @brief Sets str to size chars of a repeating pattern ending with last.
+ * @param str
+ * @param size
+ * @param last
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal setPattern(MyString* str, size_t size, char last)
+{
+	char* buffer = (char*)malloc(size + 1);
+	if (buffer == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t i;
+	for (i = 0; i < size; i++)
+	{
+		buffer[i] = (char)('a' + i % 26);
+	}
+	if (size > 0)
+	{
+		buffer[size - 1] = last;
+	}
+	buffer[size] = '\0';
+
+	MyStringRetVal ret = myStringSetFromCString(str, buffer);
+	free(buffer);
+	return ret;
+}
+
+/**
+ * @brief Frees the MyStrings of context and its arrays.
+ * @param context
+ */
+static void freeContext(BenchContext* context)
+{
+	myStringFree(context->_str1);
+	myStringFree(context->_str2);
+	if (context->_results != NULL)
+	{
+		freeStrings(context->_results, context->_batch);
+	}
+	if (context->_arr != NULL)
+	{
+		freeStrings(context->_arr, context->_arrLen);
+	}
+	free(context->_results);
+	free(context->_arr);
+	free(context->_work);
+	myStringBuilderFree(context->_builder);
+	if (context->_stream != NULL)
+	{
+		fclose(context->_stream);
+	}
+}
+
+/**
+ * @brief Allocates the inputs of context for strings of size chars and batches of up to batch
+ * 		  operations.
+ * @param context
+ * @param size
+ * @param batch
+ * @param isNumber true to set the inputs to a number of size digits instead of to a pattern
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal initContext(BenchContext* context, size_t size, size_t batch, bool isNumber)
+{
+	memset(context, 0, sizeof(BenchContext));
+	context->_size = size;
+	context->_batch = batch;
+	context->_arrLen = SORT_BYTES / (size + 1);
+	context->_arrLen = context->_arrLen < MIN_SORT_LEN ? MIN_SORT_LEN :
+					   context->_arrLen > MAX_SORT_LEN ? MAX_SORT_LEN : context->_arrLen;
+
+	context->_str1 = myStringAlloc();
+	context->_str2 = myStringAlloc();
+	context->_results = (MyString**)calloc(batch, sizeof(MyString*));
+	context->_arr = (MyString**)calloc(context->_arrLen, sizeof(MyString*));
+	context->_work = (MyString**)malloc(batch * context->_arrLen * sizeof(MyString*));
+	context->_stream = fopen("/dev/null", "w");
+	context->_builder = myStringBuilderAlloc(0);
+	if (context->_str1 == NULL || context->_str2 == NULL || context->_results == NULL ||
+		context->_arr == NULL || context->_work == NULL || context->_stream == NULL ||
+		context->_builder == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	if (isNumber)
+	{
+		// The digits of INT_MAX, so the number doesn't overflow
+		if (myStringSetFromCString(context->_str1, "2147483647" + MAX_INT_DIGITS - size) ==
+			MYSTRING_ERROR || myStringSetFromMyString(context->_str2, context->_str1) ==
+			MYSTRING_ERROR)
+		{
+			return MYSTRING_ERROR;
+		}
+	}
+	else if (setPattern(context->_str1, size, 'x') == MYSTRING_ERROR ||
+			 setPattern(context->_str2, size, 'y') == MYSTRING_ERROR)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	size_t i;
+	for (i = 0; i < batch; i++)
+	{
+		if ((context->_results[i] = myStringAlloc()) == NULL)
+		{
+			return MYSTRING_ERROR;
+		}
+	}
+	for (i = 0; i < context->_arrLen; i++)
+	{
+		if ((context->_arr[i] = myStringAlloc()) == NULL ||
+			setPattern(context->_arr[i], size, (char)('a' + rand() % 26)) == MYSTRING_ERROR)
+		{
+			return MYSTRING_ERROR;
+		}
+	}
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Frees the results of the last batch, for the benchmarks allocating them.
+ * @param context
+ */
+static void resetAllocated(BenchContext* context)
+{
+	size_t i;
+	for (i = 0; i < context->_batch; i++)
+	{
+		myStringFree(context->_results[i]);
+		context->_results[i] = NULL;
+	}
+}
+
+/**
+ * @brief Sets the results to _str1, for the benchmarks changing them.
+ * @param context
+ */
+static void resetToStr1(BenchContext* context)
+{
+	size_t i;
+	for (i = 0; i < context->_batch; i++)
+	{
+		myStringSetFromMyString(context->_results[i], context->_str1);
+	}
+}
+
+/**
+ * @brief Copies the unsorted _arr for every sort of the batch.
+ * @param context
+ */
+static void resetSort(BenchContext* context)
+{
+	size_t i;
+	for (i = 0; i < context->_batch; i++)
+	{
+		memcpy(context->_work + i * context->_arrLen, context->_arr,
+			   context->_arrLen * sizeof(MyString*));
+	}
+}
+
+/**
+ * @brief Filter of runFilter: removes the 'a' chars.
+ * @param ch
+ * @return true if ch is 'a'
+ */
+static bool isA(const char* ch)
+{
+	return *ch == 'a';
+}
+
+/**
+ * @brief Allocates a MyString.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runAlloc(BenchContext* context, size_t i)
+{
+	context->_results[i] = myStringAlloc();
+}
+
+/**
+ * @brief Clones _str1.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runClone(BenchContext* context, size_t i)
+{
+	context->_results[i] = myStringClone(context->_str1);
+}
+
+/**
+ * @brief Appends _str2 to a result set to _str1.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runCat(BenchContext* context, size_t i)
+{
+	myStringCat(context->_results[i], context->_str2);
+}
+
+/**
+ * @brief Sets a result to _str1 and _str2.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runCatTo(BenchContext* context, size_t i)
+{
+	myStringCatTo(context->_str1, context->_str2, context->_results[i]);
+}
+
+/**
+ * @brief Filters the 'a' chars of a result set to _str1.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runFilter(BenchContext* context, size_t i)
+{
+	myStringFilter(context->_results[i], isA);
+}
+
+/**
+ * @brief Sets a result to a number of _size digits.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runSetFromInt(BenchContext* context, size_t i)
+{
+	myStringSetFromInt(context->_results[i], myStringLen(context->_str1) > 1 ? INT_MAX : 7);
+}
+
+/**
+ * @brief Parses a number of _size digits.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runToInt(BenchContext* context, size_t i)
+{
+	volatile int sink = myStringToInt(i % 2 ? context->_str1 : context->_str2);
+	(void)sink;
+}
+
+/**
+ * @brief Compares _str1 to itself or to _str2, which differ only in the last char.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runCompare(BenchContext* context, size_t i)
+{
+	volatile int sink = myStringCompare(context->_str1, i % 2 ? context->_str1 : context->_str2);
+	(void)sink;
+}
+
+/**
+ * @brief Sorts a copy of _arr.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runSort(BenchContext* context, size_t i)
+{
+	myStringSort(context->_work + i * context->_arrLen, context->_arrLen);
+}
+
+/**
+ * @brief Writes _str1 to /dev/null.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runWrite(BenchContext* context, size_t i)
+{
+	(void)i;
+	myStringWrite(context->_str1, context->_stream);
+}
+
+/**
+ * @brief Borrows _str1 or _str2 as a C string.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runCStr(BenchContext* context, size_t i)
+{
+	const char* volatile sink = myStringCStr(i % 2 ? context->_str1 : context->_str2);
+	(void)sink;
+}
+
+/**
+ * @brief Converts a copy of _str1 to upper case, in place.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runToUpper(BenchContext* context, size_t i)
+{
+	myStringToUpper(context->_results[i]);
+}
+
+/**
+ * @brief Sets a result to a line made of the index, _str1 and _str2, like runCatTo, with the
+ * 		  reused builder.
+ * @param context
+ * @param i the index of the operation in the batch
+ */
+static void runBuild(BenchContext* context, size_t i)
+{
+	myStringBuilderReset(context->_builder);
+	myStringBuilderAppendf(context->_builder, "%zu: ", i);
+	myStringBuilderAppendMyString(context->_builder, context->_str1);
+	myStringBuilderAppendMyString(context->_builder, context->_str2);
+	myStringBuilderBuild(context->_builder, context->_results[i]);
+}
+
+static const MicroBenchmark microBenchmarks[] =
+{
+	{"myStringAlloc", noSizes, resetAllocated, runAlloc},
+	{"myStringClone", stringSizes, resetAllocated, runClone},
+	{"myStringCat", stringSizes, resetToStr1, runCat},
+	{"myStringCatTo", stringSizes, NULL, runCatTo},
+	{"myStringFilter", stringSizes, resetToStr1, runFilter},
+	{"myStringSetFromInt", digitSizes, NULL, runSetFromInt},
+	{"myStringToInt", digitSizes, NULL, runToInt},
+	{"myStringCompare", stringSizes, NULL, runCompare},
+	{"myStringSort", stringSizes, resetSort, runSort},
+	{"myStringWrite", stringSizes, NULL, runWrite},
+	{"myStringCStr", stringSizes, NULL, runCStr},
+	{"myStringToUpper", stringSizes, resetToStr1, runToUpper},
+	{"myStringBuilderBuild", stringSizes, NULL, runBuild},
+};
+
+/**
+ * The result of a micro-benchmark at one string size.
+ */
+typedef struct
+{
+	size_t _batch; // The number of operations timed together
+	double _samples[REPETITIONS]; // The ns/op of every repetition, sorted
+	double _bytesPerOp; // The bytes allocated per operation, or a negative value if unknown
+	double _allocsPerOp; // The allocations per operation, or a negative value if unknown
+} MicroResult;
+
+/**
+ * @brief Runs a batch of operations and adds the statistics of the library during the batch to
+ * 		  stats.
+ * @param benchmark
+ * @param context
+ * @param stats the sum of the statistics, or NULL if they are not needed
+ * @return the time of the batch in nanoseconds, without resetting it.
+ */
+static double runBatch(const MicroBenchmark* benchmark, BenchContext* context,
+					   MyStringStats* stats)
+{
+	MyStringStats before, after;
+	size_t i;
+
+	if (benchmark->_reset != NULL)
+	{
+		benchmark->_reset(context);
+	}
+	bool hasStats = stats != NULL && myStringStatsGet(&before) == MYSTRING_SUCCESS;
+
+	double start = nowNs();
+	for (i = 0; i < context->_batch; i++)
+	{
+		benchmark->_run(context, i);
+	}
+	double totalNs = nowNs() - start;
+
+	if (hasStats && myStringStatsGet(&after) == MYSTRING_SUCCESS)
+	{
+		stats->allocations += after.allocations - before.allocations;
+		stats->bytesAllocated += after.bytesAllocated - before.bytesAllocated;
+	}
+	return totalNs;
+}
+
+/**
+ * @brief Compares 2 doubles, for qsort.
+ * @param num1
+ * @param num2
+ * @return a negative value, zero or a positive value if num1 is smaller, equal or bigger
+ */
+static int doubleComparator(const void* num1, const void* num2)
+{
+	double diff = *(const double*)num1 - *(const double*)num2;
+	return (diff > 0) - (diff < 0);
+}
+
+/**
+ * @brief Runs a micro-benchmark at one string size: finds a batch size that takes at least
+ * 		  MIN_BATCH_NS (limited by MAX_BATCH and BATCH_BYTES), runs WARMUP_BATCHES batches and
+ * 		  then REPETITIONS timed batches.
+ * @param benchmark
+ * @param size
+ * @param result
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal runMicroBenchmark(const MicroBenchmark* benchmark, size_t size,
+										MicroResult* result)
+{
+	size_t maxBatch = BATCH_BYTES / (2 * size + 1);
+	maxBatch = maxBatch > MAX_BATCH ? MAX_BATCH : maxBatch == 0 ? 1 : maxBatch;
+
+	BenchContext context;
+	if (initContext(&context, size, maxBatch, benchmark->_sizes == digitSizes) == MYSTRING_ERROR)
+	{
+		freeContext(&context);
+		return MYSTRING_ERROR;
+	}
+
+	for (context._batch = 1; context._batch < maxBatch; context._batch *= 2)
+	{
+		if (runBatch(benchmark, &context, NULL) >= MIN_BATCH_NS)
+		{
+			break;
+		}
+	}
+	context._batch = context._batch > maxBatch ? maxBatch : context._batch;
+
+	size_t i;
+	for (i = 0; i < WARMUP_BATCHES; i++)
+	{
+		runBatch(benchmark, &context, NULL);
+	}
+
+	MyStringStats stats;
+	memset(&stats, 0, sizeof(stats));
+	bool hasStats = myStringStatsGet(&stats) == MYSTRING_SUCCESS;
+	memset(&stats, 0, sizeof(stats));
+
+	for (i = 0; i < REPETITIONS; i++)
+	{
+		result->_samples[i] = runBatch(benchmark, &context, &stats) / (double)context._batch;
+	}
+	qsort(result->_samples, REPETITIONS, sizeof(double), doubleComparator);
+
+	double ops = (double)(REPETITIONS * context._batch);
+	result->_batch = context._batch;
+	result->_bytesPerOp = hasStats ? (double)stats.bytesAllocated / ops : -1;
+	result->_allocsPerOp = hasStats ? (double)stats.allocations / ops : -1;
+
+	// Free every result, including the ones above the final batch size
+	context._batch = maxBatch;
+	freeContext(&context);
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @param result
+ * @return the median of the ns/op of result. REPETITIONS is odd, so it is the middle sample.
+ */
+static double median(const MicroResult* result)
+{
+	return result->_samples[REPETITIONS / 2];
+}
+
+/**
+ * @brief Writes a per-op value to a JSON stream, or null if it is unknown.
+ * @param stream
+ * @param name
+ * @param value a negative value if unknown
+ */
+static void writeJsonValue(FILE* stream, const char* name, double value)
+{
+	if (value < 0)
+	{
+		fprintf(stream, ", \"%s\": null", name);
+	}
+	else
+	{
+		fprintf(stream, ", \"%s\": %.3f", name, value);
+	}
+}
+
+/**
+ * @brief Runs every micro-benchmark at each of its sizes, and prints the minimum, the median and
+ * 		  the maximum of the ns/op over the REPETITIONS batches, the bytes/op and the
+ * 		  allocations/op (if the library is built with MYSTRING_STATS). There are too few batches
+ * 		  for high percentiles, so the maximum is reported as what it is.
+ * @param json the stream to also write the results to as JSON, or NULL
+ */
+static void benchMicro(FILE* json)
+{
+	size_t i, j;
+	bool first = true;
+
+	printf("%-32s %12s %12s %12s %10s %10s\n", "micro-benchmark/size", "min ns/op",
+		   "median ns/op", "max ns/op", "bytes/op", "allocs/op");
+	if (json != NULL)
+	{
+		fprintf(json, "{\n  \"repetitions\": %d,\n  \"benchmarks\": [", REPETITIONS);
+	}
+
+	for (i = 0; i < sizeof(microBenchmarks) / sizeof(MicroBenchmark); i++)
+	{
+		const MicroBenchmark* benchmark = &microBenchmarks[i];
+		for (j = 0; benchmark->_sizes[j] != END_OF_SIZES; j++)
+		{
+			size_t size = benchmark->_sizes[j];
+			MicroResult result;
+			if (runMicroBenchmark(benchmark, size, &result) == MYSTRING_ERROR)
+			{
+				printf("%s/%lu failed\n", benchmark->_name, (unsigned long)size);
+				continue;
+			}
+
+			char name[NAME_LENGTH];
+			snprintf(name, NAME_LENGTH, "%s/%lu", benchmark->_name, (unsigned long)size);
+			printf("%-32s %12.1f %12.1f %12.1f", name, result._samples[0], median(&result),
+				   result._samples[REPETITIONS - 1]);
+			if (result._bytesPerOp < 0)
+			{
+				printf(" %10s %10s\n", "-", "-");
+			}
+			else
+			{
+				printf(" %10.1f %10.2f\n", result._bytesPerOp, result._allocsPerOp);
+			}
+
+			if (json != NULL)
+			{
+				fprintf(json, "%s\n    {\"name\": \"%s\", \"size\": %lu, \"batch\": %lu",
+						first ? "" : ",", benchmark->_name, (unsigned long)size,
+						(unsigned long)result._batch);
+				fprintf(json, ", \"min_ns\": %.3f, \"median_ns\": %.3f, \"max_ns\": %.3f",
+						result._samples[0], median(&result), result._samples[REPETITIONS - 1]);
+				writeJsonValue(json, "bytes_per_op", result._bytesPerOp);
+				writeJsonValue(json, "allocs_per_op", result._allocsPerOp);
+				fprintf(json, "}");
+				first = false;
+			}
+		}
+	}
+
+	if (json != NULL)
+	{
+		fprintf(json, "\n  ]\n}\n");
+	}
+}
+
+/**
+ * @brief Runs all the benchmarks.
+ * 		  Usage: bench [--json <file>], to also write the micro-benchmarks results as JSON.
+ */
+int main(int argc, char* argv[])
+{
+	FILE* json = NULL;
+	if (argc == 3 && strcmp(argv[1], "--json") == 0)
+	{
+		json = fopen(argv[2], "w");
+		if (json == NULL)
+		{
+			fprintf(stderr, "Can't open %s\n", argv[2]);
+			return 1;
+		}
+	}
+	else if (argc != 1)
+	{
+		fprintf(stderr, "Usage: %s [--json <file>]\n", argv[0]);
+		return 1;
+	}
+
+	srand(0);
+	benchMicro(json);
+	benchCustomComparator();
+	benchSort();
+	benchNaturalSort();
+	benchPartialSort();
+	benchCountDistinct();
+	benchParseInts();
+	benchAllocScaling();
+	benchDictionaryScaling();
+
+	if (json != NULL)
+	{
+		fclose(json);
+	}
+	return 0;
+}
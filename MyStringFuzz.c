@@ -0,0 +1,1434 @@
+/**
+ * @file MyStringFuzz.c
+ * @author  Idan Refaeli <idan.refaeli@mail.huji.ac.il>
+ * @version 1.0
+ * @date 13 Aug 2015
+ *
+ * @brief Differential fuzzing of the MyString library
+ *
+ * @section LICENSE
+ * This program is a free software
+ *
+ * @section DESCRIPTION
+ * Decodes an input of bytes into a sequence of MyString operations on a few slots, applies every
+ * operation both to the library and to a naive model of it, and aborts when they don't agree.
+ * Built with -fsanitize=address,undefined it also catches memory errors and undefined behaviour.
+ * The library allocates through an allocator of the driver, so an input can also fail one of the
+ * allocations of an operation, which must then fail and leave its MyStrings as they were.
+ *
+ * The driver has the entry point of libFuzzer, LLVMFuzzerTestOneInput. Built with
+ * -DMYSTRING_LIBFUZZER and -fsanitize=fuzzer it runs under libFuzzer; otherwise it has its own
+ * main that runs random inputs, or replays the inputs in the given files.
+ *
+ * Input  : Nothing, or files of inputs to replay.
+ * Process: Running every input against the library and the model.
+ * Output : The number of inputs run, or the first difference found.
+ */
+
+// ------------------------------ includes ------------------------------
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include "MyString.h"
+
+// ------------------------------ consts --------------------------------
+#define NUM_OF_SLOTS 8
+#define MAX_SET_LENGTH 64
+#define MAX_MODEL_LENGTH 1024
+#define DEFAULT_RUNS 20000
+#define MAX_INPUT_LENGTH 512
+#define BASE 10
+#define MAX_FAIL_AT 3
+#define MAX_PARTS 6
+#define MAX_PERIOD 8
+#define MAX_PIECE 3
+#define MAX_INTS 8
+#define MAX_INT_DIGITS 20
+
+/**
+ * The operations an input is decoded to
+ */
+typedef enum
+{
+	OP_ALLOC,
+	OP_FREE,
+	OP_SET_CSTRING,
+	OP_SET_BUFFER,
+	OP_SET_INT,
+	OP_SET_MYSTRING,
+	OP_CLONE,
+	OP_FILTER,
+	OP_TRANSFORM,
+	OP_TRIM,
+	OP_REPLACE,
+	OP_CAT,
+	OP_CAT_TO,
+	OP_CAT_MANY,
+	OP_MOVE,
+	OP_SWAP,
+	OP_ADOPT,
+	OP_COMPARE,
+	OP_TO_INT,
+	OP_PARSE_INTS,
+	OP_TO_CSTRING,
+	OP_C_STR,
+	OP_WRITE,
+	OP_FREEZE,
+	OP_COMPRESS,
+	OP_UTF8,
+	OP_SORT,
+	OP_FAIL,
+	NUM_OF_OPS
+} OpType;
+
+/**
+ * The variants of OP_SORT
+ */
+typedef enum
+{
+	SORT_FULL,
+	SORT_KEY,
+	SORT_NATURAL,
+	SORT_PARTIAL,
+	SORT_NTH_ELEMENT,
+	SORT_COUNT_DISTINCT,
+	NUM_OF_SORTS
+} SortType;
+
+// ------------------------------ structs -------------------------------
+
+/**
+ * The naive model of a MyString in a slot
+ */
+typedef struct
+{
+	bool _exists; // The slot holds a MyString
+	bool _isSet; // The MyString was set, so its string isn't NULL
+	bool _frozen;
+	char* _chars;
+	size_t _len;
+} Model;
+
+/**
+ * The bytes of an input, read one at a time
+ */
+typedef struct
+{
+	const uint8_t* _data;
+	size_t _size;
+	size_t _pos;
+} Input;
+
+// ------------------------------ globals -------------------------------
+
+static MyString* slots[NUM_OF_SLOTS];
+static Model models[NUM_OF_SLOTS];
+static char filteredChar; // The char removed by OP_FILTER
+static FILE* writeStream; // The stream OP_WRITE writes to and reads back from
+static size_t failAt; // The allocation to fail, counting from 1, or 0 to fail none
+static bool failing; // An allocation of the current operation may fail on purpose
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * @brief Reports a difference between the library and the model and aborts.
+ * @param condition
+ * @param message what the library did wrong
+ */
+static void check(bool condition, const char* message)
+{
+	if (!condition)
+	{
+		fprintf(stderr, "MyStringFuzz: %s\n", message);
+		abort();
+	}
+}
+
+/**
+ * @brief Checks the value returned by a function of the library. While allocations are failed on
+ * 		  purpose, the function may also fail.
+ * @param ret the returned value
+ * @param expected the value expected by the model
+ * @param function the name of the function
+ * @return true if the function succeeded, so the model should be updated.
+ */
+static bool checkResult(MyStringRetVal ret, MyStringRetVal expected, const char* function)
+{
+	if (ret != expected && !(failing && ret == MYSTRING_ERROR))
+	{
+		fprintf(stderr, "MyStringFuzz: %s returned a wrong value\n", function);
+		abort();
+	}
+	return ret == MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Checks an int returned by a function of the library, like checkResult: reading a
+ * 		  compressed MyString decompresses it, so it may fail while allocations are failed.
+ * @param ret the returned value
+ * @param expected the value expected by the model
+ * @param message what the library did wrong
+ */
+static void checkInt(int ret, int expected, const char* message)
+{
+	check(ret == expected || (failing && ret == MYSTR_ERROR_CODE), message);
+}
+
+/**
+ * @brief malloc of the allocator of the library, failing the failAt'th allocation.
+ * @param size
+ * @param ctx unused
+ * @return the result of malloc, or NULL if the allocation should fail.
+ */
+static void* fuzzMalloc(size_t size, void* ctx)
+{
+	(void)ctx;
+	return failAt > 0 && --failAt == 0 ? NULL : malloc(size);
+}
+
+/**
+ * @brief realloc of the allocator of the library, failing the failAt'th allocation.
+ * @param ptr
+ * @param size
+ * @param ctx unused
+ * @return the result of realloc, or NULL if the allocation should fail.
+ */
+static void* fuzzRealloc(void* ptr, size_t size, void* ctx)
+{
+	(void)ctx;
+	return failAt > 0 && --failAt == 0 ? NULL : realloc(ptr, size);
+}
+
+/**
+ * @brief free of the allocator of the library.
+ * @param ptr
+ * @param ctx unused
+ */
+static void fuzzFree(void* ptr, void* ctx)
+{
+	(void)ctx;
+	free(ptr);
+}
+
+/**
+ * @param input
+ * @return the next byte of input, or 0 if it ended.
+ */
+static uint8_t nextByte(Input* input)
+{
+	return input->_pos < input->_size ? input->_data[input->_pos++] : 0;
+}
+
+/**
+ * @param input
+ * @return the MyString slot of the next byte of input.
+ */
+static size_t nextSlot(Input* input)
+{
+	return nextByte(input) % NUM_OF_SLOTS;
+}
+
+/**
+ * @brief Filter of OP_FILTER.
+ * @param ch
+ * @return true if ch is filteredChar
+ */
+static bool isFilteredChar(const char* ch)
+{
+	return *ch == filteredChar;
+}
+
+/**
+ * @brief Case insensitive comparator for myStringCustomCompare.
+ * @param ch1
+ * @param ch2
+ * @return the difference between the lower case values of ch1 and ch2
+ */
+static int caselessComparator(const char ch1, const char ch2)
+{
+	return tolower((unsigned char)ch1) - tolower((unsigned char)ch2);
+}
+
+/**
+ * @brief Sets the chars of model.
+ * @param model
+ * @param chars
+ * @param len
+ */
+static void setModel(Model* model, const char* chars, size_t len)
+{
+	char* copy = (char*)malloc(len + 1);
+	check(copy != NULL, "out of memory");
+	memcpy(copy, chars, len);
+	free(model->_chars);
+	model->_chars = copy;
+	model->_len = len;
+	model->_isSet = true;
+}
+
+/**
+ * @brief Moves the value of a model to another, and leaves it like a new MyString.
+ * @param model
+ * @param from
+ */
+static void moveModel(Model* model, Model* from)
+{
+	free(model->_chars);
+	model->_chars = from->_chars;
+	model->_len = from->_len;
+	model->_isSet = from->_isSet;
+	from->_chars = (char*)malloc(1);
+	check(from->_chars != NULL, "out of memory");
+	from->_len = 0;
+	from->_isSet = false;
+}
+
+/**
+ * @brief Empties a slot, in the library and in the model.
+ * @param slot
+ */
+static void clearSlot(size_t slot)
+{
+	myStringFree(slots[slot]);
+	slots[slot] = NULL;
+	free(models[slot]._chars);
+	memset(&models[slot], 0, sizeof(Model));
+}
+
+/**
+ * @param slot
+ * @return true if the MyString of slot may be changed, according to the model.
+ */
+static bool modelMutable(size_t slot)
+{
+	return models[slot]._exists && !models[slot]._frozen;
+}
+
+/**
+ * @brief Compares 2 models like myStringCustomCompare.
+ * @param model1
+ * @param model2
+ * @param comparator
+ * @return -1, 0 or 1, or MYSTR_ERROR_CODE if they can't be compared.
+ */
+static int modelCompare(const Model* model1, const Model* model2,
+						int (*comparator)(const char, const char))
+{
+	size_t i;
+	if (!model1->_exists || !model2->_exists || !model1->_isSet || !model2->_isSet)
+	{
+		return MYSTR_ERROR_CODE;
+	}
+
+	for (i = 0; i < model1->_len && i < model2->_len; i++)
+	{
+		int compare = comparator(model1->_chars[i], model2->_chars[i]);
+		if (compare != 0)
+		{
+			return compare > 0 ? 1 : -1;
+		}
+	}
+	return model1->_len == model2->_len ? 0 : model1->_len < model2->_len ? -1 : 1;
+}
+
+/**
+ * @brief Compares 2 chars by their value as char, like the default comparator of the library.
+ * @param ch1
+ * @param ch2
+ * @return a negative value, zero or a positive value if ch1 is smaller, equal or bigger
+ */
+static int charComparator(const char ch1, const char ch2)
+{
+	return (ch1 > ch2) - (ch1 < ch2);
+}
+
+/**
+ * @brief Compares 2 models in natural order like myStringNaturalSort, walking both of them and
+ * 		  comparing the runs of digits by their value as they are met.
+ * @param model1
+ * @param model2
+ * @return a negative value, zero or a positive value if model1 is smaller, equal or bigger
+ */
+static int modelNaturalCompare(const Model* model1, const Model* model2)
+{
+	const char* chars1 = model1->_chars;
+	const char* chars2 = model2->_chars;
+	size_t i = 0, j = 0;
+
+	while (i < model1->_len && j < model2->_len)
+	{
+		if (!isdigit((unsigned char)chars1[i]) || !isdigit((unsigned char)chars2[j]))
+		{
+			// A run of digits is ordered among the other chars like its first digit
+			int compare = charComparator(chars1[i], chars2[j]);
+			if (compare != 0)
+			{
+				return compare;
+			}
+			i++;
+			j++;
+			continue;
+		}
+
+		size_t end1 = i, end2 = j;
+		while (end1 < model1->_len && isdigit((unsigned char)chars1[end1]))
+		{
+			end1++;
+		}
+		while (end2 < model2->_len && isdigit((unsigned char)chars2[end2]))
+		{
+			end2++;
+		}
+		while (i < end1 - 1 && chars1[i] == '0')
+		{
+			i++;
+		}
+		while (j < end2 - 1 && chars2[j] == '0')
+		{
+			j++;
+		}
+		if (end1 - i != end2 - j)
+		{
+			return end1 - i < end2 - j ? -1 : 1;
+		}
+		int compare = memcmp(chars1 + i, chars2 + j, end1 - i);
+		if (compare != 0)
+		{
+			return compare;
+		}
+		i = end1;
+		j = end2;
+	}
+	return (i < model1->_len) - (j < model2->_len);
+}
+
+/**
+ * @brief Decodes the code point of a model at offset by the definition of UTF-8: the bits of the
+ * 		  sequence are gathered first, and overlong encodings, surrogates and code points above
+ * 		  U+10FFFF are rejected by their value afterwards.
+ * @param model
+ * @param offset less than the length of the model
+ * @param n set to the number of chars of the code point
+ * @return the code point, or MYSTR_ERROR_CODE if the chars at offset aren't valid UTF-8.
+ */
+static int modelDecodeUtf8(const Model* model, size_t offset, size_t* n)
+{
+	static const int minCodepoints[] = {0, 0, 0x80, 0x800, 0x10000};
+	unsigned char lead = (unsigned char)model->_chars[offset];
+	size_t i;
+
+	for (*n = 0; *n < CHAR_BIT && (lead & (0x80 >> *n)) != 0; (*n)++)
+	{
+	}
+	if (*n == 0)
+	{
+		*n = 1;
+		return lead;
+	}
+	if (*n == 1 || *n > 4 || model->_len - offset < *n)
+	{
+		return MYSTR_ERROR_CODE;
+	}
+
+	int codepoint = lead & (0xFF >> (*n + 1));
+	for (i = 1; i < *n; i++)
+	{
+		unsigned char ch = (unsigned char)model->_chars[offset + i];
+		if ((ch & 0xC0) != 0x80)
+		{
+			return MYSTR_ERROR_CODE;
+		}
+		codepoint = codepoint << 6 | (ch & 0x3F);
+	}
+	if (codepoint < minCodepoints[*n] || (codepoint >= 0xD800 && codepoint <= 0xDFFF) ||
+		codepoint > 0x10FFFF)
+	{
+		return MYSTR_ERROR_CODE;
+	}
+	return codepoint;
+}
+
+/**
+ * @brief Replaces up to maxCount occurrences of from in a model by to, comparing at every place.
+ * @param model
+ * @param from must not be empty
+ * @param to
+ * @param maxCount
+ * @param result set to the chars of the result, MAX_MODEL_LENGTH at most
+ * @return the length of the result, or a length above MAX_MODEL_LENGTH if it is too long.
+ */
+static size_t modelReplace(const Model* model, const Model* from, const Model* to,
+						   size_t maxCount, char* result)
+{
+	size_t i = 0, length = 0, count = 0;
+
+	while (i < model->_len)
+	{
+		if (count < maxCount && model->_len - i >= from->_len &&
+			memcmp(model->_chars + i, from->_chars, from->_len) == 0)
+		{
+			if (length + to->_len > MAX_MODEL_LENGTH)
+			{
+				return MAX_MODEL_LENGTH + 1;
+			}
+			memcpy(result + length, to->_chars, to->_len);
+			length += to->_len;
+			i += from->_len;
+			count++;
+		}
+		else
+		{
+			if (length == MAX_MODEL_LENGTH)
+			{
+				return MAX_MODEL_LENGTH + 1;
+			}
+			result[length++] = model->_chars[i++];
+		}
+	}
+	return length;
+}
+
+/**
+ * @brief Parses a model like myStringToInt, with strtol instead of digit by digit.
+ * @param model
+ * @return the number, or MYSTR_ERROR_CODE if the model isn't an int.
+ */
+static int modelToInt(const Model* model)
+{
+	char buffer[MAX_MODEL_LENGTH + 1];
+	size_t i, digits = 0;
+
+	if (!model->_exists)
+	{
+		return MYSTR_ERROR_CODE;
+	}
+	for (i = 0; i < model->_len; i++)
+	{
+		bool sign = i == 0 && (model->_chars[i] == '+' || model->_chars[i] == '-');
+		if (!sign && !isdigit((unsigned char)model->_chars[i]))
+		{
+			return MYSTR_ERROR_CODE;
+		}
+		digits += !sign;
+	}
+	if (digits == 0)
+	{
+		return MYSTR_ERROR_CODE;
+	}
+
+	memcpy(buffer, model->_chars, model->_len);
+	buffer[model->_len] = '\0';
+	long long num = strtoll(buffer, NULL, BASE);
+	// strtoll saturates at the limits of long long, which are out of the range of int as well
+	return num < INT_MIN || num > INT_MAX ? MYSTR_ERROR_CODE : (int)num;
+}
+
+/**
+ * @brief Parses a model like myStringParseInts, with strtoll instead of digit by digit.
+ * @param model
+ * @param sep
+ * @param out set to the integers
+ * @param cap
+ * @param count set to the number of integers set in out
+ * @param errorOffset set to the offset of the error on failure
+ * @return true on success, false on failure.
+ */
+static bool modelParseInts(const Model* model, char sep, int64_t* out, size_t cap, size_t* count,
+						   size_t* errorOffset)
+{
+	const char* chars = model->_chars;
+	size_t len = model->_len, pos = 0, next;
+
+	*count = 0;
+	while (pos < len && isspace((unsigned char)chars[pos]))
+	{
+		pos++;
+	}
+	while (pos < len)
+	{
+		char buffer[MAX_MODEL_LENGTH + 1];
+		size_t start = pos, digits;
+		if (chars[pos] == '+' || chars[pos] == '-')
+		{
+			pos++;
+		}
+		for (digits = 0; pos + digits < len && isdigit((unsigned char)chars[pos + digits]);
+			 digits++)
+		{
+		}
+		if (digits == 0)
+		{
+			*errorOffset = pos;
+			return false;
+		}
+		pos += digits;
+		memcpy(buffer, chars + start, pos - start);
+		buffer[pos - start] = '\0';
+		errno = 0;
+		long long num = strtoll(buffer, NULL, BASE);
+		if (errno == ERANGE || *count == cap)
+		{
+			*errorOffset = start;
+			return false;
+		}
+		out[(*count)++] = (int64_t)num;
+
+		for (next = pos; next < len && isspace((unsigned char)chars[next]); next++)
+		{
+		}
+		if (next == len)
+		{
+			return true;
+		}
+		if (isspace((unsigned char)sep) ? next == pos : chars[next] != sep)
+		{
+			*errorOffset = next;
+			return false;
+		}
+		pos = isspace((unsigned char)sep) ? next : next + 1;
+		while (pos < len && isspace((unsigned char)chars[pos]))
+		{
+			pos++;
+		}
+		if (pos == len)
+		{
+			*errorOffset = len;
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Checks that the MyString of a slot has the chars of its model.
+ * @param slot
+ */
+static void checkSlot(size_t slot)
+{
+	const Model* model = &models[slot];
+	if (!model->_exists)
+	{
+		return;
+	}
+
+	MyStringMemInfo info;
+	check(myStringMemInfo(slots[slot], &info) == MYSTRING_SUCCESS && info.length == model->_len &&
+		  info.compressed == myStringIsCompressed(slots[slot]), "wrong memory info");
+	check(myStringLen(slots[slot]) == model->_len, "wrong length");
+	check(myStringIsFrozen(slots[slot]) == model->_frozen, "wrong frozen state");
+
+	// Reading the chars would decompress them, so they are checked by the next operation instead
+	if (info.compressed)
+	{
+		check(model->_isSet && !model->_frozen, "compressed a wrong MyString");
+		return;
+	}
+
+	const char* data = myStringData(slots[slot]);
+	check(model->_isSet == (data != NULL), "wrong string set");
+	check(model->_len == 0 || memcmp(data, model->_chars, model->_len) == 0, "wrong chars");
+	check(info.capacity >= info.length, "wrong memory info");
+}
+
+/**
+ * @brief Runs an operation of OP_SORT on the set MyStrings of the slots, and checks the order
+ * 		  of the result with the models.
+ * @param input
+ */
+static void runSort(Input* input)
+{
+	MyString* arr[NUM_OF_SLOTS];
+	size_t indexes[NUM_OF_SLOTS]; // The slot of every MyString of arr after sorting
+	size_t len = 0, i, j;
+
+	for (i = 0; i < NUM_OF_SLOTS; i++)
+	{
+		if (models[i]._exists && models[i]._isSet)
+		{
+			arr[len++] = slots[i];
+		}
+	}
+
+	SortType type = (SortType)(nextByte(input) % NUM_OF_SORTS);
+	// k may be len or more, where partial sort sorts everything and selection does nothing
+	size_t k = nextByte(input) % (len + 2);
+	size_t sorted = len; // The MyStrings of arr that must be in order
+
+	switch (type)
+	{
+		case SORT_FULL:
+			myStringSort(arr, len);
+			break;
+		case SORT_KEY:
+			if (myStringKeySort(arr, len, NULL) != MYSTRING_SUCCESS)
+			{
+				check(failing, "myStringKeySort failed");
+				return;
+			}
+			break;
+		case SORT_NATURAL:
+			if (myStringNaturalSort(arr, len) != MYSTRING_SUCCESS)
+			{
+				check(failing, "myStringNaturalSort failed");
+				return;
+			}
+			break;
+		case SORT_PARTIAL:
+			myStringPartialSort(arr, len, k);
+			sorted = k < len ? k : len;
+			break;
+		case SORT_NTH_ELEMENT:
+			myStringNthElement(arr, len, k);
+			sorted = 0;
+			break;
+		default:
+		{
+			size_t count, expected = 0;
+			if (myStringCountDistinct(arr, len, &count) != MYSTRING_SUCCESS)
+			{
+				check(failing, "myStringCountDistinct failed");
+				return;
+			}
+			for (i = 0; i < len; i++)
+			{
+				for (j = 0; j < i && myStringCompare(arr[j], arr[i]) != 0; j++)
+				{
+				}
+				expected += j == i;
+			}
+			check(count == expected, "wrong number of distinct MyStrings");
+			return;
+		}
+	}
+
+	// Every MyString must still be in arr exactly once
+	for (i = 0; i < len; i++)
+	{
+		for (j = 0; j < NUM_OF_SLOTS && slots[j] != arr[i]; j++)
+		{
+		}
+		check(j < NUM_OF_SLOTS, "sorting lost a MyString");
+		indexes[i] = j;
+		for (j = 0; j < i; j++)
+		{
+			check(indexes[j] != indexes[i], "sorting duplicated a MyString");
+		}
+	}
+
+	// Comparing a compressed MyString may fail to decompress it, so the order isn't known
+	if (failing)
+	{
+		return;
+	}
+
+	for (i = 1; i < sorted; i++)
+	{
+		const Model* previous = &models[indexes[i - 1]];
+		check(type == SORT_NATURAL ? modelNaturalCompare(previous, &models[indexes[i]]) <= 0 :
+			  modelCompare(previous, &models[indexes[i]], charComparator) <= 0,
+			  "sorting out of order");
+	}
+	if (type == SORT_PARTIAL && k > 0 && k < len)
+	{
+		// Nothing after the first k places may be smaller than the last of them
+		for (i = k; i < len; i++)
+		{
+			check(modelCompare(&models[indexes[k - 1]], &models[indexes[i]], charComparator) <= 0,
+				  "partial sort out of order");
+		}
+	}
+	else if (type == SORT_NTH_ELEMENT && k < len)
+	{
+		// Nothing after the k'th place may be smaller than it, and nothing before it bigger
+		for (i = 0; i < len; i++)
+		{
+			int compare = modelCompare(&models[indexes[i]], &models[indexes[k]], charComparator);
+			check(i < k ? compare <= 0 : i > k ? compare >= 0 : true, "selection out of order");
+		}
+	}
+}
+
+/**
+ * @brief Runs the next operation of input on the library and on the model, and checks that they
+ * 		  agree.
+ * @param input
+ */
+static void runOp(Input* input)
+{
+	OpType type = (OpType)(nextByte(input) % NUM_OF_OPS);
+	size_t slot = nextSlot(input);
+	size_t other = nextSlot(input);
+	Model* model = &models[slot];
+	const Model* otherModel = &models[other];
+	MyStringRetVal expected;
+
+	switch (type)
+	{
+		case OP_ALLOC:
+			clearSlot(slot);
+			slots[slot] = myStringAlloc();
+			if (slots[slot] == NULL)
+			{
+				check(failing, "myStringAlloc failed");
+				break;
+			}
+			model->_exists = true;
+			model->_chars = (char*)malloc(1);
+			check(model->_chars != NULL, "out of memory");
+			break;
+		case OP_FREE:
+			clearSlot(slot);
+			break;
+		case OP_SET_CSTRING:
+		{
+			char buffer[MAX_SET_LENGTH + 1];
+			size_t len = nextByte(input) % (MAX_SET_LENGTH + 1), i;
+			for (i = 0; i < len; i++)
+			{
+				buffer[i] = (char)nextByte(input);
+			}
+			buffer[len] = '\0';
+
+			expected = modelMutable(slot) ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringSetFromCString(slots[slot], buffer), expected,
+							"myStringSetFromCString"))
+			{
+				setModel(model, buffer, strlen(buffer));
+			}
+			break;
+		}
+		case OP_SET_BUFFER:
+		{
+			// Sets slot to random bytes, to a repeated pattern of them (which compresses well), or
+			// to a part of the string of other, which may be slot
+			char buffer[MAX_MODEL_LENGTH];
+			const char* buf = buffer;
+			size_t len = nextByte(input) % (MAX_SET_LENGTH + 1), i;
+			if (len == MAX_SET_LENGTH - 1)
+			{
+				size_t period = 1 + nextByte(input) % MAX_PERIOD;
+				len = nextByte(input) * (MAX_MODEL_LENGTH / (UINT8_MAX + 1));
+				for (i = 0; i < len; i++)
+				{
+					buffer[i] = i < period ? (char)nextByte(input) : buffer[i - period];
+				}
+			}
+			else if (len == MAX_SET_LENGTH)
+			{
+				size_t start = nextByte(input) % (otherModel->_len + 1);
+				len = nextByte(input) % (otherModel->_len - start + 1);
+				if (len > MAX_MODEL_LENGTH)
+				{
+					break;
+				}
+				buf = myStringData(slots[other]);
+				if (len > 0)
+				{
+					buf += start;
+					memcpy(buffer, otherModel->_chars + start, len);
+				}
+			}
+			else
+			{
+				for (i = 0; i < len; i++)
+				{
+					buffer[i] = (char)nextByte(input);
+				}
+			}
+
+			expected = modelMutable(slot) && (buf != NULL || len == 0) ? MYSTRING_SUCCESS :
+					   MYSTRING_ERROR;
+			if (checkResult(myStringSetFromBuffer(slots[slot], buf, len), expected,
+							"myStringSetFromBuffer"))
+			{
+				setModel(model, buffer, len);
+			}
+			break;
+		}
+		case OP_SET_INT:
+		{
+			unsigned int bits = 0;
+			size_t i;
+			for (i = 0; i < sizeof(int); i++)
+			{
+				bits = bits << CHAR_BIT | nextByte(input);
+			}
+			// Small numbers are more interesting, so a zero first byte picks one of them
+			int n = (bits >> (sizeof(int) - 1) * CHAR_BIT) == 0 ? (int)(bits % 21) - 10 :
+					(int)bits;
+
+			expected = modelMutable(slot) ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringSetFromInt(slots[slot], n), expected,
+							"myStringSetFromInt"))
+			{
+				char buffer[MAX_SET_LENGTH];
+				setModel(model, buffer, (size_t)snprintf(buffer, sizeof(buffer), "%d", n));
+			}
+			break;
+		}
+		case OP_SET_MYSTRING:
+			expected = modelMutable(slot) && otherModel->_exists ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringSetFromMyString(slots[slot], slots[other]), expected,
+							"myStringSetFromMyString"))
+			{
+				setModel(model, otherModel->_chars, otherModel->_len);
+			}
+			break;
+		case OP_CLONE:
+		{
+			MyString* clone = myStringClone(slots[other]);
+			check((clone != NULL) == otherModel->_exists || (failing && clone == NULL),
+				  "myStringClone returned a wrong value");
+			if (clone != NULL)
+			{
+				Model cloneModel = {true, false, false, NULL, 0};
+				setModel(&cloneModel, otherModel->_chars, otherModel->_len);
+				clearSlot(slot);
+				slots[slot] = clone;
+				*model = cloneModel;
+			}
+			break;
+		}
+		case OP_FILTER:
+			filteredChar = (char)nextByte(input);
+			expected = modelMutable(slot) && model->_isSet ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringFilter(slots[slot], isFilteredChar), expected,
+							"myStringFilter"))
+			{
+				size_t i, j = 0;
+				for (i = 0; i < model->_len; i++)
+				{
+					if (model->_chars[i] != filteredChar)
+					{
+						model->_chars[j++] = model->_chars[i];
+					}
+				}
+				model->_len = j;
+			}
+			break;
+		case OP_TRANSFORM:
+		{
+			// Converts the case, or translates by adding a number to every char
+			uint8_t variant = nextByte(input) % 3, add = nextByte(input), table[UINT8_MAX + 1];
+			size_t i;
+			for (i = 0; i <= UINT8_MAX; i++)
+			{
+				table[i] = (uint8_t)(i + add);
+			}
+
+			MyStringRetVal ret = variant == 0 ? myStringToLower(slots[slot]) :
+								 variant == 1 ? myStringToUpper(slots[slot]) :
+								 myStringTranslate(slots[slot], table);
+			expected = modelMutable(slot) ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(ret, expected, variant == 0 ? "myStringToLower" :
+							variant == 1 ? "myStringToUpper" : "myStringTranslate"))
+			{
+				// The C locale converts only the ASCII letters
+				for (i = 0; i < model->_len; i++)
+				{
+					unsigned char ch = (unsigned char)model->_chars[i];
+					model->_chars[i] = (char)(variant == 0 ? tolower(ch) :
+											  variant == 1 ? toupper(ch) : table[ch]);
+				}
+			}
+			break;
+		}
+		case OP_TRIM:
+		{
+			// The whitespace of the C locale is the whitespace of myStringTrim
+			size_t start = 0, end = model->_len;
+			while (start < end && isspace((unsigned char)model->_chars[start]))
+			{
+				start++;
+			}
+			while (end > start && isspace((unsigned char)model->_chars[end - 1]))
+			{
+				end--;
+			}
+
+			expected = modelMutable(slot) ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringTrim(slots[slot]), expected, "myStringTrim"))
+			{
+				memmove(model->_chars, model->_chars + start, end - start);
+				model->_len = end - start;
+			}
+			break;
+		}
+		case OP_REPLACE:
+		{
+			// Replaces other in slot by a third MyString, any of which may be the same. other is
+			// first set to a few chars of slot, so it is found
+			size_t to = nextSlot(input), piece = nextByte(input) % (MAX_PIECE + 1);
+			bool all = nextByte(input) % 2 == 0;
+			char result[MAX_MODEL_LENGTH];
+			size_t len = 0;
+			if (piece > 0 && other != slot && model->_len >= piece && modelMutable(other))
+			{
+				size_t start = nextByte(input) % (model->_len - piece + 1);
+				if (!checkResult(myStringSetFromBuffer(slots[other], model->_chars + start, piece),
+								 MYSTRING_SUCCESS, "myStringSetFromBuffer"))
+				{
+					break;
+				}
+				setModel(&models[other], model->_chars + start, piece);
+			}
+			expected = modelMutable(slot) && otherModel->_exists && models[to]._exists &&
+					   otherModel->_len > 0 ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (expected == MYSTRING_SUCCESS)
+			{
+				len = modelReplace(model, otherModel, &models[to], all ? SIZE_MAX : 1, result);
+				if (len > MAX_MODEL_LENGTH)
+				{
+					break;
+				}
+			}
+
+			MyStringRetVal ret = all ? myStringReplaceAll(slots[slot], slots[other], slots[to]) :
+								 myStringReplace(slots[slot], slots[other], slots[to]);
+			if (checkResult(ret, expected, all ? "myStringReplaceAll" : "myStringReplace") &&
+				model->_isSet)
+			{
+				setModel(model, result, len);
+			}
+			break;
+		}
+		case OP_CAT:
+			// Concatenating a MyString to itself doubles it, so the lengths are limited
+			if (model->_len + otherModel->_len > MAX_MODEL_LENGTH)
+			{
+				break;
+			}
+			expected = modelMutable(slot) && otherModel->_exists ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringCat(slots[slot], slots[other]), expected,
+							"myStringCat"))
+			{
+				char* chars = (char*)malloc(model->_len + otherModel->_len + 1);
+				check(chars != NULL, "out of memory");
+				memcpy(chars, model->_chars, model->_len);
+				memcpy(chars + model->_len, otherModel->_chars, otherModel->_len);
+				setModel(model, chars, model->_len + otherModel->_len);
+				free(chars);
+			}
+			break;
+		case OP_CAT_TO:
+		{
+			// result shouldn't be the same struct as str1 or str2
+			size_t result = nextSlot(input);
+			if (result == slot || result == other ||
+				model->_len + otherModel->_len > MAX_MODEL_LENGTH)
+			{
+				break;
+			}
+			expected = model->_exists && otherModel->_exists && modelMutable(result) ?
+					   MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringCatTo(slots[slot], slots[other], slots[result]), expected,
+							"myStringCatTo"))
+			{
+				char* chars = (char*)malloc(model->_len + otherModel->_len + 1);
+				check(chars != NULL, "out of memory");
+				memcpy(chars, model->_chars, model->_len);
+				memcpy(chars + model->_len, otherModel->_chars, otherModel->_len);
+				setModel(&models[result], chars, model->_len + otherModel->_len);
+				free(chars);
+			}
+			break;
+		}
+		case OP_CAT_MANY:
+		{
+			// The parts may repeat, and may include the result
+			const MyString* parts[MAX_PARTS];
+			const Model* partModels[MAX_PARTS];
+			size_t n = nextByte(input) % (MAX_PARTS + 1), length = 0, i;
+			bool partsExist = true;
+			for (i = 0; i < n; i++)
+			{
+				size_t part = nextSlot(input);
+				parts[i] = slots[part];
+				partModels[i] = &models[part];
+				partsExist = partsExist && models[part]._exists;
+				length += models[part]._len;
+			}
+			if (length > MAX_MODEL_LENGTH)
+			{
+				break;
+			}
+			expected = modelMutable(slot) && partsExist ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringCatMany(slots[slot], parts, n), expected, "myStringCatMany"))
+			{
+				char* chars = (char*)malloc(length + 1);
+				check(chars != NULL, "out of memory");
+				length = 0;
+				for (i = 0; i < n; i++)
+				{
+					memcpy(chars + length, partModels[i]->_chars, partModels[i]->_len);
+					length += partModels[i]->_len;
+				}
+				setModel(model, chars, length);
+				free(chars);
+			}
+			break;
+		}
+		case OP_MOVE:
+			expected = modelMutable(slot) && modelMutable(other) ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringMove(slots[slot], slots[other]), expected, "myStringMove") &&
+				slot != other)
+			{
+				moveModel(model, &models[other]);
+			}
+			break;
+		case OP_SWAP:
+			expected = modelMutable(slot) && modelMutable(other) ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringSwap(slots[slot], slots[other]), expected, "myStringSwap"))
+			{
+				Model swapped = *model;
+				model->_chars = otherModel->_chars;
+				model->_len = otherModel->_len;
+				model->_isSet = otherModel->_isSet;
+				models[other]._chars = swapped._chars;
+				models[other]._len = swapped._len;
+				models[other]._isSet = swapped._isSet;
+			}
+			break;
+		case OP_ADOPT:
+		{
+			// Releases the string of other, and gives a prefix of it to slot
+			size_t len, capacity;
+			char* buf = myStringReleaseBuffer(slots[other], &len, &capacity);
+			check((buf != NULL) == (modelMutable(other) && otherModel->_isSet) ||
+				  (failing && buf == NULL), "myStringReleaseBuffer returned a wrong value");
+			if (buf == NULL)
+			{
+				break;
+			}
+			check(len == otherModel->_len && memcmp(buf, otherModel->_chars, len) == 0,
+				  "myStringReleaseBuffer returned wrong chars");
+
+			Model released = models[other];
+			memset(&models[other], 0, sizeof(Model));
+			models[other]._exists = true;
+			models[other]._chars = (char*)malloc(1);
+			check(models[other]._chars != NULL, "out of memory");
+
+			size_t prefix = len == 0 ? 0 : nextByte(input) % (len + 1);
+			expected = modelMutable(slot) ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringAdoptBuffer(slots[slot], buf, prefix, capacity), expected,
+							"myStringAdoptBuffer"))
+			{
+				setModel(model, released._chars, prefix);
+			}
+			else
+			{
+				myStringBufferFree(buf, capacity);
+			}
+			free(released._chars);
+			break;
+		}
+		case OP_COMPARE:
+		{
+			int compare = modelCompare(model, otherModel, charComparator);
+			int equal = compare == MYSTR_ERROR_CODE ? MYSTR_ERROR_CODE : compare == 0;
+			int caseless = modelCompare(model, otherModel, caselessComparator);
+
+			checkInt(myStringCompare(slots[slot], slots[other]), compare,
+					 "myStringCompare returned a wrong value");
+			checkInt(myStringEqual(slots[slot], slots[other]), equal,
+					 "myStringEqual returned a wrong value");
+			checkInt(myStringCustomCompare(slots[slot], slots[other], caselessComparator), caseless,
+					 "myStringCustomCompare returned a wrong value");
+			check(myStringCustomCompare(slots[slot], slots[other], NULL) == MYSTR_ERROR_CODE,
+				  "myStringCustomCompare accepted a NULL comparator");
+			break;
+		}
+		case OP_TO_INT:
+			checkInt(myStringToInt(slots[slot]), modelToInt(model),
+					 "myStringToInt returned a wrong value");
+			break;
+		case OP_PARSE_INTS:
+		{
+			// Random bytes are rarely a list of integers, so the slot may be set to one first
+			static const char seps[] = {',', ' ', '\t', ';'};
+			char sep = seps[nextByte(input) % sizeof(seps)];
+			size_t cap = nextByte(input) % (MAX_INTS + 1);
+			if (nextByte(input) % 2 == 0 && modelMutable(slot))
+			{
+				char buffer[MAX_SET_LENGTH * 2];
+				size_t len = 0, items = nextByte(input) % (MAX_INTS + 2), i, j;
+				for (i = 0; i < items && len + MAX_INT_DIGITS + 4 <= sizeof(buffer); i++)
+				{
+					uint8_t shape = nextByte(input);
+					if (shape % 3 == 0)
+					{
+						buffer[len++] = shape % 2 == 0 ? '-' : '+';
+					}
+					size_t digits = 1 + nextByte(input) % MAX_INT_DIGITS;
+					for (j = 0; j < digits; j++)
+					{
+						buffer[len++] = (char)('0' + nextByte(input) % BASE);
+					}
+					// Usually the separator, sometimes whitespace around it or a wrong char
+					shape = nextByte(input) % 8;
+					buffer[len++] = shape < 5 ? sep : shape == 5 ? ' ' : (char)nextByte(input);
+					if (shape == 6)
+					{
+						buffer[len++] = ' ';
+					}
+				}
+				// A trailing separator is an error, so it is usually dropped
+				if (len > 0 && nextByte(input) % 4 != 0)
+				{
+					len--;
+				}
+				if (checkResult(myStringSetFromBuffer(slots[slot], buffer, len), MYSTRING_SUCCESS,
+								"myStringSetFromBuffer"))
+				{
+					setModel(model, buffer, len);
+				}
+			}
+
+			int64_t out[MAX_INTS], modelOut[MAX_INTS];
+			size_t count, modelCount, errorOffset = SIZE_MAX, modelErrorOffset = SIZE_MAX;
+			bool parsed = model->_exists &&
+						  modelParseInts(model, sep, modelOut, cap, &modelCount, &modelErrorOffset);
+			expected = parsed ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			MyStringRetVal ret = myStringParseInts(slots[slot], sep, out, cap, &count,
+												   &errorOffset);
+			checkResult(ret, expected, "myStringParseInts");
+			if (model->_exists && (ret == MYSTRING_SUCCESS || !failing))
+			{
+				check(count == modelCount && (parsed || errorOffset == modelErrorOffset) &&
+					  memcmp(out, modelOut, count * sizeof(int64_t)) == 0,
+					  "myStringParseInts parsed wrong integers");
+			}
+			break;
+		}
+		case OP_TO_CSTRING:
+		{
+			char* cString = myStringToCString(slots[slot]);
+			check((cString != NULL) == model->_exists || (failing && cString == NULL),
+				  "myStringToCString returned a wrong value");
+			if (cString != NULL)
+			{
+				// The chars may include null characters, so strlen can't be used
+				check(memcmp(cString, model->_chars, model->_len) == 0 &&
+					  cString[model->_len] == '\0',
+					  "myStringToCString returned wrong chars");
+			}
+			free(cString);
+			break;
+		}
+		case OP_C_STR:
+		{
+			const char* cString = myStringCStr(slots[slot]);
+			check((cString != NULL) == model->_exists || (failing && cString == NULL),
+				  "myStringCStr returned a wrong value");
+			if (cString != NULL)
+			{
+				check(memcmp(cString, model->_chars, model->_len) == 0 &&
+					  cString[model->_len] == '\0', "myStringCStr returned wrong chars");
+			}
+			break;
+		}
+		case OP_WRITE:
+		{
+			char buffer[MAX_MODEL_LENGTH + 1];
+			expected = model->_exists ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			rewind(writeStream);
+			if (checkResult(myStringWrite(slots[slot], writeStream), expected,
+							"myStringWrite"))
+			{
+				long written = ftell(writeStream);
+				rewind(writeStream);
+				check(written == (long)model->_len &&
+					  fread(buffer, 1, model->_len, writeStream) == model->_len &&
+					  memcmp(buffer, model->_chars, model->_len) == 0,
+					  "myStringWrite wrote wrong chars");
+			}
+			break;
+		}
+		case OP_FREEZE:
+			expected = model->_exists ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			if (checkResult(myStringFreeze(slots[slot]), expected, "myStringFreeze"))
+			{
+				model->_frozen = true;
+			}
+			break;
+		case OP_COMPRESS:
+			// The value doesn't change, and is checked when the MyString is read again
+			expected = modelMutable(slot) ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+			checkResult(myStringCompress(slots[slot]), expected, "myStringCompress");
+			break;
+		case OP_UTF8:
+		{
+			// The model is validated first, then the library is walked code point by code point
+			size_t modelOffset = 0, offset = 0, n;
+			long codepoints = 0;
+			bool valid = model->_exists;
+			while (valid && modelOffset < model->_len)
+			{
+				valid = modelDecodeUtf8(model, modelOffset, &n) != MYSTR_ERROR_CODE;
+				modelOffset += n;
+				codepoints++;
+			}
+
+			bool validated = myStringValidateUtf8(slots[slot]);
+			check(validated == valid || (failing && !validated),
+				  "myStringValidateUtf8 returned a wrong value");
+			long len = myStringCodepointLen(slots[slot]);
+			check(len == (valid ? codepoints : MYSTR_ERROR_CODE) ||
+				  (failing && len == MYSTR_ERROR_CODE),
+				  "myStringCodepointLen returned a wrong value");
+
+			modelOffset = 0;
+			while (model->_exists)
+			{
+				int modelCodepoint = modelOffset == model->_len ? MYSTR_END_CODE :
+									 modelDecodeUtf8(model, modelOffset, &n);
+				int codepoint = myStringNextCodepoint(slots[slot], &offset);
+				checkInt(codepoint, modelCodepoint, "myStringNextCodepoint returned a wrong value");
+				if (codepoint < 0)
+				{
+					break;
+				}
+				modelOffset += n;
+				check(offset == modelOffset, "myStringNextCodepoint advanced to a wrong offset");
+			}
+			break;
+		}
+		case OP_FAIL:
+			// Fails one of the first allocations of the next operation
+			failAt = 1 + nextByte(input) % MAX_FAIL_AT;
+			failing = true;
+			return;
+		default:
+			runSort(input);
+			break;
+	}
+
+	checkSlot(slot);
+	checkSlot(other);
+	failAt = 0;
+	failing = false;
+}
+
+/**
+ * @brief The entry point of libFuzzer: runs the operations of an input, and frees the MyStrings
+ * 		  they left.
+ * @param data
+ * @param size
+ * @return 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	Input input = {data, size, 0};
+	size_t i;
+
+	if (writeStream == NULL)
+	{
+		writeStream = tmpfile();
+		check(writeStream != NULL, "can't open a temporary file");
+		check(myStringSetAllocator(fuzzMalloc, fuzzRealloc, fuzzFree, NULL) == MYSTRING_SUCCESS,
+			  "can't set the allocator");
+	}
+
+	while (input._pos < input._size)
+	{
+		runOp(&input);
+	}
+
+	for (i = 0; i < NUM_OF_SLOTS; i++)
+	{
+		checkSlot(i);
+		clearSlot(i);
+	}
+	failAt = 0;
+	failing = false;
+	check(myStringLiveObjects() == 0, "a MyString leaked");
+	return 0;
+}
+
+#ifndef MYSTRING_LIBFUZZER
+
+/**
+ * @brief Runs an input read from a file.
+ * @param fileName
+ * @return 0 on success, 1 if the file can't be read.
+ */
+static int runFile(const char* fileName)
+{
+	FILE* stream = fopen(fileName, "rb");
+	uint8_t* data = NULL;
+	size_t size = 0, capacity = 0, bytesRead;
+
+	if (stream == NULL)
+	{
+		fprintf(stderr, "Can't open %s\n", fileName);
+		return 1;
+	}
+	do
+	{
+		if (size == capacity)
+		{
+			capacity = capacity == 0 ? MAX_INPUT_LENGTH : 2 * capacity;
+			uint8_t* newData = (uint8_t*)realloc(data, capacity);
+			check(newData != NULL, "out of memory");
+			data = newData;
+		}
+		bytesRead = fread(data + size, 1, capacity - size, stream);
+		size += bytesRead;
+	} while (bytesRead > 0);
+	fclose(stream);
+
+	printf("Running %s\n", fileName);
+	LLVMFuzzerTestOneInput(data, size);
+	free(data);
+	return 0;
+}
+
+/**
+ * @brief Runs random inputs, or the inputs in the given files.
+ * 		  Usage: fuzz [-runs=<n>] [-seed=<n>] [file...]
+ */
+int main(int argc, char* argv[])
+{
+	unsigned long runs = DEFAULT_RUNS, seed = 0, run;
+	int i, ret = 0;
+	bool hasFiles = false;
+	uint8_t data[MAX_INPUT_LENGTH];
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strncmp(argv[i], "-runs=", strlen("-runs=")) == 0)
+		{
+			runs = strtoul(argv[i] + strlen("-runs="), NULL, BASE);
+		}
+		else if (strncmp(argv[i], "-seed=", strlen("-seed=")) == 0)
+		{
+			seed = strtoul(argv[i] + strlen("-seed="), NULL, BASE);
+		}
+		else
+		{
+			hasFiles = true;
+			ret |= runFile(argv[i]);
+		}
+	}
+	if (hasFiles)
+	{
+		return ret;
+	}
+
+	srand((unsigned int)seed);
+	for (run = 0; run < runs; run++)
+	{
+		size_t size = (size_t)rand() % MAX_INPUT_LENGTH, j;
+		for (j = 0; j < size; j++)
+		{
+			data[j] = (uint8_t)rand();
+		}
+		LLVMFuzzerTestOneInput(data, size);
+	}
+	printf("Success. %lu random inputs agree with the model (seed %lu)\n", runs, seed);
+	return 0;
+}
+
+#endif
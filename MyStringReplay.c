@@ -0,0 +1,592 @@
+/**
+ * @file MyStringReplay.c
+ * @author  Idan Refaeli <idan.refaeli@mail.huji.ac.il>
+ * @version 1.0
+ * @date 13 Aug 2015
+ *
+ * @brief Replays traces of MyString operations
+ *
+ * @section LICENSE
+ * This program is a free software
+ *
+ * @section DESCRIPTION
+ * Replays workloads recorded as trace files against the MyString library, to measure how
+ * allocating and copying interact in real programs. Building it with different MYSTRING_FLAGS
+ * compares different implementations on the same workloads.
+ *
+ * A trace has an operation in every line, on MyStrings kept in numbered slots. Empty lines and
+ * lines starting with '#' are ignored:
+ *   alloc <slot>             myStringAlloc into slot
+ *   free <slot>              myStringFree of slot
+ *   set <slot> <text>        myStringSetFromCString with the rest of the line
+ *   setint <slot> <n>        myStringSetFromInt
+ *   clone <slot> <src>       myStringClone of src into slot
+ *   cat <slot> <src>         myStringCat
+ *   filter <slot> <chars>    myStringFilter removing the given chars
+ *   toint <slot>             myStringToInt
+ *   compare <slot> <other>   myStringCompare
+ *   sort <first> <count>     myStringSort of count slots from first
+ *   write <slot>             myStringWrite to /dev/null
+ *
+ * Input  : Trace files to replay, or a workload to generate a trace of.
+ * Process: Replaying every trace a number of times.
+ * Output : The throughput, peak RSS and allocation statistics of every trace.
+ */
+
+// ------------------------------ includes ------------------------------
+#define _XOPEN_SOURCE 600
+
+#include <limits.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "MyString.h"
+
+// ------------------------------ consts --------------------------------
+#define MAX_LINE_LENGTH 4096
+#define DEFAULT_REPEAT 50
+#define NUM_OF_LOG_LINES 2000
+#define NUM_OF_CSV_ROWS 2000
+#define NUM_OF_KEYS 5000
+#define NUM_OF_DISTINCT_KEYS 1000
+#define BASE 10
+#define INITIAL_NUM_OF_OPS 1024
+
+// ------------------------------ structs -------------------------------
+
+/**
+ * The operations of a trace
+ */
+typedef enum
+{
+	OP_ALLOC,
+	OP_FREE,
+	OP_SET,
+	OP_SETINT,
+	OP_CLONE,
+	OP_CAT,
+	OP_FILTER,
+	OP_TOINT,
+	OP_COMPARE,
+	OP_SORT,
+	OP_WRITE,
+	NUM_OF_OPS
+} OpType;
+
+static const char* opNames[NUM_OF_OPS] =
+{
+	"alloc", "free", "set", "setint", "clone", "cat", "filter", "toint", "compare", "sort", "write"
+};
+
+/**
+ * The number of slot arguments of every operation
+ */
+static const int opSlots[NUM_OF_OPS] = {1, 1, 1, 1, 2, 2, 1, 1, 2, 1, 1};
+
+/**
+ * An operation of a trace
+ */
+typedef struct
+{
+	OpType _type;
+	size_t _slot; // The slot the operation is done on
+	size_t _other; // The second slot of clone, cat and compare, or the count of sort
+	int _num; // The number of setint
+	char* _text; // The text of set or the chars of filter
+} Op;
+
+/**
+ * A trace loaded to memory
+ */
+typedef struct
+{
+	Op* _ops;
+	size_t _len;
+	size_t _capacity;
+	size_t _numOfSlots; // One more than the biggest slot used
+} Trace;
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * @return the current time in nanoseconds
+ */
+static double nowNs()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+/**
+ * @return the peak resident set size of the process in KB.
+ */
+static long peakRssKb()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+/**
+ * @brief Frees the ops of trace.
+ * @param trace
+ */
+static void freeTrace(Trace* trace)
+{
+	size_t i;
+	for (i = 0; i < trace->_len; i++)
+	{
+		free(trace->_ops[i]._text);
+	}
+	free(trace->_ops);
+}
+
+/**
+ * @brief Parses a slot number.
+ * @param token
+ * @param slot set to the slot
+ * @return true if token is a slot number
+ */
+static bool parseSlot(const char* token, size_t* slot)
+{
+	char* end;
+	if (token == NULL || *token < '0' || *token > '9')
+	{
+		return false;
+	}
+	*slot = (size_t)strtoul(token, &end, BASE);
+	return *end == '\0' || *end == ' ';
+}
+
+/**
+ * @brief Parses a line of a trace into op.
+ * @param line the line, without its new line char
+ * @param op
+ * @return true if the line is a valid operation
+ */
+static bool parseOp(char* line, Op* op)
+{
+	char* args = strchr(line, ' ');
+	size_t nameLength = args == NULL ? strlen(line) : (size_t)(args - line);
+	int type;
+
+	memset(op, 0, sizeof(Op));
+	for (type = 0; type < NUM_OF_OPS; type++)
+	{
+		if (strlen(opNames[type]) == nameLength && strncmp(line, opNames[type], nameLength) == 0)
+		{
+			break;
+		}
+	}
+	if (type == NUM_OF_OPS || args == NULL || !parseSlot(args + 1, &op->_slot))
+	{
+		return false;
+	}
+	op->_type = (OpType)type;
+
+	// The text after the slot, or an empty text
+	char* rest = strchr(args + 1, ' ');
+	rest = rest == NULL ? "" : rest + 1;
+
+	switch (op->_type)
+	{
+		case OP_CLONE:
+		case OP_CAT:
+		case OP_COMPARE:
+		case OP_SORT:
+			return parseSlot(rest, &op->_other);
+		case OP_SETINT:
+		{
+			char* end;
+			long num = strtol(rest, &end, BASE);
+			op->_num = (int)num;
+			return *rest != '\0' && *end == '\0' && num >= INT_MIN && num <= INT_MAX;
+		}
+		case OP_SET:
+		case OP_FILTER:
+			op->_text = (char*)malloc(strlen(rest) + 1);
+			if (op->_text == NULL)
+			{
+				return false;
+			}
+			strcpy(op->_text, rest);
+			return true;
+		default:
+			return *rest == '\0';
+	}
+}
+
+/**
+ * @brief Loads a trace file to memory.
+ * @param fileName
+ * @param trace
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal loadTrace(const char* fileName, Trace* trace)
+{
+	FILE* stream = fopen(fileName, "r");
+	char line[MAX_LINE_LENGTH];
+	size_t lineNumber = 0;
+
+	memset(trace, 0, sizeof(Trace));
+	if (stream == NULL)
+	{
+		fprintf(stderr, "Can't open %s\n", fileName);
+		return MYSTRING_ERROR;
+	}
+
+	while (fgets(line, MAX_LINE_LENGTH, stream) != NULL)
+	{
+		size_t length = strlen(line);
+		lineNumber++;
+		if (length > 0 && line[length - 1] == '\n')
+		{
+			line[--length] = '\0';
+		}
+		else if (!feof(stream))
+		{
+			fprintf(stderr, "%s:%lu: line too long\n", fileName, (unsigned long)lineNumber);
+			break;
+		}
+		if (length == 0 || line[0] == '#')
+		{
+			continue;
+		}
+
+		if (trace->_len == trace->_capacity)
+		{
+			size_t capacity = trace->_capacity == 0 ? INITIAL_NUM_OF_OPS : 2 * trace->_capacity;
+			Op* ops = (Op*)realloc(trace->_ops, capacity * sizeof(Op));
+			if (ops == NULL)
+			{
+				break;
+			}
+			trace->_ops = ops;
+			trace->_capacity = capacity;
+		}
+
+		Op* op = &trace->_ops[trace->_len];
+		if (!parseOp(line, op))
+		{
+			free(op->_text);
+			fprintf(stderr, "%s:%lu: bad operation\n", fileName, (unsigned long)lineNumber);
+			break;
+		}
+		trace->_len++;
+
+		size_t lastSlot = op->_slot + (op->_type == OP_SORT ? op->_other : 1);
+		if (opSlots[op->_type] == 2 && op->_other + 1 > lastSlot)
+		{
+			lastSlot = op->_other + 1;
+		}
+		trace->_numOfSlots = lastSlot > trace->_numOfSlots ? lastSlot : trace->_numOfSlots;
+	}
+
+	bool failed = !feof(stream);
+	fclose(stream);
+	if (failed)
+	{
+		freeTrace(trace);
+		return MYSTRING_ERROR;
+	}
+	return MYSTRING_SUCCESS;
+}
+
+static bool filtered[UCHAR_MAX + 1];
+
+/**
+ * @brief Filter of OP_FILTER.
+ * @param ch
+ * @return true if ch is one of the chars of the current OP_FILTER
+ */
+static bool isFiltered(const char* ch)
+{
+	return filtered[(unsigned char)*ch];
+}
+
+/**
+ * @brief Sets which chars isFiltered removes.
+ * @param chars
+ * @param value true to start removing chars, false to stop
+ */
+static void setFiltered(const char* chars, bool value)
+{
+	for (; *chars != '\0'; chars++)
+	{
+		filtered[(unsigned char)*chars] = value;
+	}
+}
+
+/**
+ * @brief Replays the ops of trace once.
+ * @param trace
+ * @param slots the MyStrings of the trace, all NULL before and after replaying
+ * @param stream the stream of OP_WRITE
+ */
+static void replay(const Trace* trace, MyString** slots, FILE* stream)
+{
+	volatile unsigned int sink = 0;
+	size_t i;
+
+	for (i = 0; i < trace->_len; i++)
+	{
+		const Op* op = &trace->_ops[i];
+		MyString** str = &slots[op->_slot];
+
+		switch (op->_type)
+		{
+			case OP_ALLOC:
+				myStringFree(*str);
+				*str = myStringAlloc();
+				break;
+			case OP_FREE:
+				myStringFree(*str);
+				*str = NULL;
+				break;
+			case OP_SET:
+				myStringSetFromCString(*str, op->_text);
+				break;
+			case OP_SETINT:
+				myStringSetFromInt(*str, op->_num);
+				break;
+			case OP_CLONE:
+				myStringFree(*str);
+				*str = myStringClone(slots[op->_other]);
+				break;
+			case OP_CAT:
+				myStringCat(*str, slots[op->_other]);
+				break;
+			case OP_FILTER:
+				setFiltered(op->_text, true);
+				myStringFilter(*str, isFiltered);
+				setFiltered(op->_text, false);
+				break;
+			case OP_TOINT:
+				sink += (unsigned int)myStringToInt(*str);
+				break;
+			case OP_COMPARE:
+				sink += (unsigned int)myStringCompare(*str, slots[op->_other]);
+				break;
+			case OP_SORT:
+				myStringSort(str, op->_other);
+				break;
+			case OP_WRITE:
+				myStringWrite(*str, stream);
+				break;
+			default:
+				break;
+		}
+	}
+
+	// Free what the trace left allocated, so every replay starts from empty slots
+	for (i = 0; i < trace->_numOfSlots; i++)
+	{
+		myStringFree(slots[i]);
+		slots[i] = NULL;
+	}
+	(void)sink;
+}
+
+/**
+ * @brief Replays a trace file repeat times and prints its throughput, the peak RSS of the
+ * 		  process and the allocation statistics of the library.
+ * @param fileName
+ * @param repeat
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal replayFile(const char* fileName, size_t repeat)
+{
+	Trace trace;
+	if (loadTrace(fileName, &trace) == MYSTRING_ERROR)
+	{
+		return MYSTRING_ERROR;
+	}
+
+	MyString** slots = (MyString**)calloc(trace._numOfSlots + 1, sizeof(MyString*));
+	FILE* stream = fopen("/dev/null", "w");
+	if (slots == NULL || stream == NULL)
+	{
+		free(slots);
+		if (stream != NULL)
+		{
+			fclose(stream);
+		}
+		freeTrace(&trace);
+		return MYSTRING_ERROR;
+	}
+
+	MyStringStats before, after;
+	bool hasStats = myStringStatsGet(&before) == MYSTRING_SUCCESS;
+	long rssBefore = peakRssKb();
+
+	size_t i;
+	double start = nowNs();
+	for (i = 0; i < repeat; i++)
+	{
+		replay(&trace, slots, stream);
+	}
+	double totalNs = nowNs() - start;
+	double ops = (double)(trace._len * repeat);
+
+	printf("%s: %lu ops x %lu\n", fileName, (unsigned long)trace._len, (unsigned long)repeat);
+	printf("  throughput        %12.2f Mops/s (%.2f ns/op)\n", ops / totalNs * 1e3,
+		   totalNs / ops);
+	printf("  peak RSS          %12ld KB (%ld KB before replaying)\n", peakRssKb(), rssBefore);
+	if (hasStats && myStringStatsGet(&after) == MYSTRING_SUCCESS)
+	{
+		printf("  allocations/op    %12.2f\n", (double)(after.allocations - before.allocations) / ops);
+		printf("  bytes/op          %12.2f\n",
+			   (double)(after.bytesAllocated - before.bytesAllocated) / ops);
+		printf("  copies/op         %12.2f\n", (double)(after.copies - before.copies) / ops);
+		printf("  bytes copied/op   %12.2f\n",
+			   (double)(after.bytesCopied - before.bytesCopied) / ops);
+	}
+	else
+	{
+		printf("  allocation statistics need MYSTRING_STATS\n");
+	}
+	printf("  live after replay %12lld bytes, %lld MyStrings\n", myStringLiveBytes(),
+		   myStringLiveObjects());
+
+	fclose(stream);
+	free(slots);
+	freeTrace(&trace);
+	return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Writes a trace of building log lines from a timestamp, a level and a message, and
+ * 		  writing them.
+ * @param stream
+ */
+static void generateLog(FILE* stream)
+{
+	static const char* levels[] = {"INFO ", "WARN ", "ERROR "};
+	size_t i;
+
+	fprintf(stream, "# Building and writing log lines\n");
+	fprintf(stream, "alloc 1\nalloc 2\nalloc 3\nset 2 2015-08-13 12:00:\n");
+	for (i = 0; i < NUM_OF_LOG_LINES; i++)
+	{
+		fprintf(stream, "clone 0 2\nsetint 1 %d\ncat 0 1\n", rand() % 60);
+		fprintf(stream, "set 3  [worker-%d] %s\ncat 0 3\n", rand() % 8, levels[rand() % 3]);
+		fprintf(stream, "set 3 request %d served in %d ms from cache\ncat 0 3\n", rand(),
+				rand() % 1000);
+		fprintf(stream, "write 0\nfree 0\n");
+	}
+	fprintf(stream, "free 1\nfree 2\nfree 3\n");
+}
+
+/**
+ * @brief Writes a trace of parsing the fields of CSV rows: every row is cloned per field, the
+ * 		  other fields are filtered out and the numbers are parsed.
+ * @param stream
+ */
+static void generateCsv(FILE* stream)
+{
+	size_t i;
+
+	fprintf(stream, "# Parsing the id and the quantity of CSV rows\n");
+	fprintf(stream, "alloc 0\nalloc 3\n");
+	for (i = 0; i < NUM_OF_CSV_ROWS; i++)
+	{
+		fprintf(stream, "set 0 %d;item-%c%c%c;%d\n", rand() % 100000, 'a' + rand() % 26,
+				'a' + rand() % 26, 'a' + rand() % 26, rand() % 1000);
+		fprintf(stream, "clone 1 0\nfilter 1 ;-abcdefghijklmnopqrstuvwxyz\ntoint 1\n");
+		fprintf(stream, "clone 2 0\nfilter 2 -abcdefghijklmnopqrstuvwxyz\ncompare 2 3\n");
+		fprintf(stream, "clone 3 2\nfree 1\nfree 2\n");
+	}
+	fprintf(stream, "free 0\nfree 3\n");
+}
+
+/**
+ * @brief Writes a trace of removing duplicate keys: the keys are sorted, neighbours are compared
+ * 		  and the sorted keys are written.
+ * @param stream
+ */
+static void generateDedup(FILE* stream)
+{
+	size_t i;
+
+	fprintf(stream, "# Sorting keys and comparing neighbours to remove duplicates\n");
+	for (i = 0; i < NUM_OF_KEYS; i++)
+	{
+		fprintf(stream, "alloc %lu\nset %lu user-%d@example.com\n", (unsigned long)i,
+				(unsigned long)i, rand() % NUM_OF_DISTINCT_KEYS);
+	}
+	fprintf(stream, "sort 0 %d\n", NUM_OF_KEYS);
+	for (i = 1; i < NUM_OF_KEYS; i++)
+	{
+		fprintf(stream, "compare %lu %lu\n", (unsigned long)i - 1, (unsigned long)i);
+	}
+	for (i = 0; i < NUM_OF_KEYS; i++)
+	{
+		fprintf(stream, "write %lu\nfree %lu\n", (unsigned long)i, (unsigned long)i);
+	}
+}
+
+/**
+ * @brief Writes a synthetic trace of a workload to a file.
+ * @param workload log, csv or dedup
+ * @param fileName
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal generate(const char* workload, const char* fileName)
+{
+	void (*generator)(FILE*) = strcmp(workload, "log") == 0 ? generateLog :
+							   strcmp(workload, "csv") == 0 ? generateCsv :
+							   strcmp(workload, "dedup") == 0 ? generateDedup : NULL;
+	if (generator == NULL)
+	{
+		fprintf(stderr, "Unknown workload %s\n", workload);
+		return MYSTRING_ERROR;
+	}
+
+	FILE* stream = fopen(fileName, "w");
+	if (stream == NULL)
+	{
+		fprintf(stderr, "Can't open %s\n", fileName);
+		return MYSTRING_ERROR;
+	}
+
+	srand(0);
+	generator(stream);
+	return fclose(stream) == 0 ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+}
+
+/**
+ * @brief Replays the given trace files, or generates a trace.
+ * 		  Usage: replay [--repeat <n>] <trace>...
+ * 		         replay --generate log|csv|dedup <trace>
+ */
+int main(int argc, char* argv[])
+{
+	size_t repeat = DEFAULT_REPEAT;
+	int i = 1;
+
+	if (argc == 4 && strcmp(argv[1], "--generate") == 0)
+	{
+		return generate(argv[2], argv[3]) == MYSTRING_SUCCESS ? 0 : 1;
+	}
+	if (argc > 2 && strcmp(argv[1], "--repeat") == 0)
+	{
+		repeat = (size_t)strtoul(argv[2], NULL, BASE);
+		i = 3;
+	}
+	if (i >= argc || repeat == 0)
+	{
+		fprintf(stderr, "Usage: %s [--repeat <n>] <trace>...\n", argv[0]);
+		fprintf(stderr, "       %s --generate log|csv|dedup <trace>\n", argv[0]);
+		return 1;
+	}
+
+	int ret = 0;
+	for (; i < argc; i++)
+	{
+		if (replayFile(argv[i], repeat) == MYSTRING_ERROR)
+		{
+			ret = 1;
+		}
+	}
+	return ret;
+}